@@ -1,9 +1,3 @@
-#include <stb_image.h>
-#define STB_IMAGE_IMPLEMENTATION
-
-#include <tiny_obj_loader.h>
-#define TINYOBJLOADER_IMPLEMENTATION
-
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
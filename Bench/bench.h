@@ -0,0 +1,56 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "threadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace Engine::Bench {
+	struct BenchOptions {
+		// inputs for benchmarks that read files; each falls back to generated data without them
+		std::vector<std::string> files;
+		size_t runs = 5;
+	};
+
+	// best of runs, in seconds; the fastest run is the one least disturbed by the rest of the system
+	template<typename F>
+	double measure(size_t runs, F&& body)
+	{
+		double best = std::numeric_limits<double>::max();
+		for (size_t i = 0; i < std::max<size_t>(runs, 1); i++) {
+			auto start = std::chrono::steady_clock::now();
+			body();
+			best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	// takes the thread pool away for its lifetime, so parallel paths run their serial fallback
+	class WithoutThreadPool
+	{
+	private:
+		std::unique_ptr<Engine::Utility::ThreadPool> pool = std::move(threadPool);
+
+	public:
+		WithoutThreadPool() = default;
+		~WithoutThreadPool() { threadPool = std::move(pool); }
+
+		WithoutThreadPool(const WithoutThreadPool&) = delete;
+		WithoutThreadPool& operator=(const WithoutThreadPool&) = delete;
+	};
+
+	// per-frame scene iteration as entity count grows to 10k
+	void sceneIteration(const BenchOptions& options);
+	// MeshBuilder deduplication of 1M, 10M and 50M index grids against the old unordered_map loop
+	void meshBuilder(const BenchOptions& options);
+	// FlatHashMap against std::unordered_map for insert, lookup and missed lookup
+	void hashMap(const BenchOptions& options);
+	// ObjLoader against tinyobj in MB/s, on the given OBJ files or a generated one
+	void objLoader(const BenchOptions& options);
+}
+
+#endif
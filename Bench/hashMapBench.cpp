@@ -0,0 +1,91 @@
+#include "bench.h"
+#include "utility.h"
+#include <random>
+
+namespace {
+	struct Timings {
+		double insert = 0.0;
+		double hit = 0.0;
+		double miss = 0.0;
+	};
+
+	// inserts keys into an empty map without reserving, then looks up every key and as many absent ones
+	template<typename Map, typename Key>
+	Timings run(size_t runs, const std::vector<Key>& keys, const std::vector<Key>& absent, uint64_t& checksum)
+	{
+		Timings timings;
+		Map map;
+
+		timings.insert = Engine::Bench::measure(runs, [&]() {
+			map = Map();
+			for (uint32_t i = 0; i < keys.size(); i++)
+				map.try_emplace(keys[i], i);
+		});
+
+		timings.hit = Engine::Bench::measure(runs, [&]() {
+			for (const Key& key : keys)
+				checksum += map.find(key)->second;
+		});
+
+		timings.miss = Engine::Bench::measure(runs, [&]() {
+			for (const Key& key : absent)
+				checksum += map.find(key) == map.end();
+		});
+
+		return timings;
+	}
+
+	template<typename Key>
+	void compare(const char* keyName, size_t runs, size_t count, const std::vector<Key>& keys, const std::vector<Key>& absent)
+	{
+		uint64_t checksum = 0;
+		Timings flat = run<Engine::Utility::FlatHashMap<Key, uint32_t>>(runs, keys, absent, checksum);
+		Timings node = run<std::unordered_map<Key, uint32_t>>(runs, keys, absent, checksum);
+
+		auto ns = [count](double seconds) { return seconds * 1e9 / count; };
+		printf("%8s %10zu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f  (checksum %llu)\n", keyName, count,
+			ns(flat.insert), ns(node.insert), ns(flat.hit), ns(node.hit), ns(flat.miss), ns(node.miss), static_cast<unsigned long long>(checksum));
+	}
+
+	Vertex randomVertex(std::mt19937_64& random)
+	{
+		std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+		Vertex vertex{};
+		vertex.pos = { value(random), value(random), value(random) };
+		vertex.normal = { value(random), value(random), value(random) };
+		vertex.texCoord = { value(random), value(random) };
+		return vertex;
+	}
+}
+
+void Engine::Bench::hashMap(const BenchOptions& options)
+{
+	printf("FlatHashMap (flat) against std::unordered_map (node), ns per operation, best of %zu runs\n", options.runs);
+	printf("%8s %10s %10s %10s %10s %10s %10s %10s\n", "key", "entries", "insert", "insert", "hit", "hit", "miss", "miss");
+	printf("%8s %10s %10s %10s %10s %10s %10s %10s\n", "", "", "flat", "node", "flat", "node", "flat", "node");
+
+	for (size_t count : { 1000, 100000, 1000000, 10000000 }) {
+		// the same seed per size keeps runs comparable; odd keys are stored and even ones are absent
+		std::mt19937_64 random(count);
+
+		std::vector<uint64_t> keys(count);
+		std::vector<uint64_t> absentKeys(count);
+		for (size_t i = 0; i < count; i++) {
+			uint64_t key = random();
+			keys[i] = key | 1;
+			absentKeys[i] = key & ~1ull;
+		}
+		compare("uint64", options.runs, count, keys, absentKeys);
+
+		// vertex keys are what mesh deduplication hashes, so they go through hashVertex
+		std::vector<Vertex> vertices(count);
+		std::vector<Vertex> absentVertices(count);
+		for (size_t i = 0; i < count; i++) {
+			vertices[i] = randomVertex(random);
+			absentVertices[i] = randomVertex(random);
+			absentVertices[i].texCoord.x = 2.0f;
+		}
+		compare("Vertex", options.runs, count, vertices, absentVertices);
+	}
+}
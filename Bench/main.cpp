@@ -0,0 +1,87 @@
+#include "bench.h"
+#include "threadPool.h"
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+
+namespace {
+	struct Benchmark {
+		const char* name;
+		const char* description;
+		std::function<void(const Engine::Bench::BenchOptions&)> run;
+	};
+
+	const std::vector<Benchmark> benchmarks = {
+		{ "scenes", "per-frame scene iteration from 10 to 10k entities", Engine::Bench::sceneIteration },
+		{ "mesh", "vertex deduplication of 1M, 10M and 50M index meshes", Engine::Bench::meshBuilder },
+		{ "hashmap", "FlatHashMap against std::unordered_map, insert and lookup", Engine::Bench::hashMap },
+		{ "obj", "ObjLoader against tinyobj in MB/s, on --file OBJs or a generated one", Engine::Bench::objLoader },
+	};
+
+	void printUsage()
+	{
+		printf(
+			"usage: FortifyBench [benchmark...] [options]\n"
+			"  --runs <n>       runs per measurement, the fastest is reported (default: 5)\n"
+			"  --threads <n>    worker threads (default: one per core but one)\n"
+			"  --file <f>       input file for benchmarks that read one, may be repeated\n"
+			"benchmarks (all of them run when none is named):\n");
+
+		for (const Benchmark& benchmark : benchmarks)
+			printf("  %-16s %s\n", benchmark.name, benchmark.description);
+	}
+}
+
+int main(int argc, char** argv) {
+	Engine::Bench::BenchOptions options;
+	std::vector<const Benchmark*> selected;
+	size_t threads = Engine::Utility::ThreadPool::defaultThreadCount();
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg == "--runs" && i + 1 < argc)
+			options.runs = static_cast<size_t>(std::max(1, atoi(argv[++i])));
+		else if (arg == "--threads" && i + 1 < argc)
+			threads = static_cast<size_t>(std::max(0, atoi(argv[++i])));
+		else if (arg == "--file" && i + 1 < argc)
+			options.files.push_back(argv[++i]);
+		else if (arg == "--help" || arg == "-h") {
+			printUsage();
+			return EXIT_SUCCESS;
+		}
+		else {
+			auto it = std::find_if(benchmarks.begin(), benchmarks.end(), [&](const Benchmark& benchmark) { return arg == benchmark.name; });
+			if (it == benchmarks.end()) {
+				printUsage();
+				return EXIT_FAILURE;
+			}
+			selected.push_back(&*it);
+		}
+	}
+
+	if (selected.empty())
+		for (const Benchmark& benchmark : benchmarks)
+			selected.push_back(&benchmark);
+
+	// with no workers the parallel paths run serially, the baseline they are measured against
+	if (threads > 0)
+		threadPool = std::make_unique<Engine::Utility::ThreadPool>(threads);
+
+	printf("%zu worker threads\n\n", threadPool ? threadPool->size() : 0);
+
+	bool succeeded = true;
+	for (const Benchmark* benchmark : selected) {
+		try {
+			benchmark->run(options);
+		}
+		catch (const std::exception& e) {
+			std::cerr << "Error: " << benchmark->name << ": " << e.what() << std::endl;
+			succeeded = false;
+		}
+		printf("\n");
+	}
+
+	threadPool.reset();
+	return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
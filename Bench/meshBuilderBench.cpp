@@ -0,0 +1,108 @@
+#include "bench.h"
+#include "meshBuilder.h"
+#include <cmath>
+
+namespace {
+	// a k x k quad grid where every inner vertex is shared by six corners, the same ratio a
+	// closed triangle mesh has, so deduplication has real work to do
+	struct GridMesh {
+		std::vector<float> positions;
+		std::vector<float> normals = { 0.0f, 1.0f, 0.0f };
+		std::vector<float> texcoords;
+		std::vector<tinyobj::index_t> corners;
+
+		explicit GridMesh(size_t targetCorners) {
+			const size_t k = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::sqrt(targetCorners / 6.0))));
+			const size_t side = k + 1;
+
+			positions.reserve(side * side * 3);
+			texcoords.reserve(side * side * 2);
+			for (size_t z = 0; z < side; z++) {
+				for (size_t x = 0; x < side; x++) {
+					positions.insert(positions.end(), { static_cast<float>(x), 0.0f, static_cast<float>(z) });
+					texcoords.insert(texcoords.end(), { static_cast<float>(x) / k, static_cast<float>(z) / k });
+				}
+			}
+
+			auto corner = [&](size_t x, size_t z) {
+				int index = static_cast<int>(z * side + x);
+				corners.push_back({ index, 0, index });
+			};
+
+			corners.reserve(k * k * 6);
+			for (size_t z = 0; z < k; z++) {
+				for (size_t x = 0; x < k; x++) {
+					corner(x, z); corner(x, z + 1); corner(x + 1, z);
+					corner(x + 1, z); corner(x, z + 1); corner(x + 1, z + 1);
+				}
+			}
+		}
+
+		Engine::Graphics::MeshSource source() const {
+			Engine::Graphics::MeshSource source;
+			source.positions = positions;
+			source.normals = normals;
+			source.texcoords = texcoords;
+			source.indexRanges.emplace_back(corners);
+			return source;
+		}
+	};
+
+	// the single-threaded loop texture.cpp ran before MeshBuilder replaced it
+	void buildWithUnorderedMap(const Engine::Graphics::MeshSource& source, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		std::unordered_map<Vertex, uint32_t> uniqueVertices;
+
+		for (const auto& range : source.indexRanges) {
+			for (const auto& index : range) {
+				Vertex vertex = Engine::Graphics::MeshBuilder::makeVertex(source, index);
+
+				auto [it, inserted] = uniqueVertices.try_emplace(vertex, static_cast<uint32_t>(vertices.size()));
+				if (inserted)
+					vertices.push_back(vertex);
+
+				indices.push_back(it->second);
+			}
+		}
+	}
+}
+
+void Engine::Bench::meshBuilder(const BenchOptions& options)
+{
+	printf("mesh building, best of %zu runs\n", options.runs);
+	printf("%12s %12s %14s %14s %14s %10s\n", "indices", "vertices", "unordered (s)", "serial (s)", "parallel (s)", "speedup");
+
+	for (size_t targetCorners : { 1000000, 10000000, 50000000 }) {
+		GridMesh grid(targetCorners);
+		Engine::Graphics::MeshSource source = grid.source();
+
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		auto build = [&](auto&& builder) {
+			return measure(options.runs, [&]() {
+				vertices.clear();
+				indices.clear();
+				builder(source, vertices, indices);
+			});
+		};
+
+		const double unordered = build(buildWithUnorderedMap);
+		std::vector<Vertex> expectedVertices = vertices;
+		std::vector<uint32_t> expectedIndices = indices;
+
+		// the same routine with the pool taken away runs its serial path
+		double serial = 0.0;
+		{
+			WithoutThreadPool serialScope;
+			serial = build(Engine::Graphics::MeshBuilder::build);
+		}
+
+		const double parallel = build(Engine::Graphics::MeshBuilder::build);
+
+		// output must not depend on the thread count, so it has to match the serial loop exactly
+		if (vertices != expectedVertices || indices != expectedIndices)
+			throw std::runtime_error("parallel output differs from the serial loop for " + std::to_string(grid.corners.size()) + " indices");
+
+		printf("%12zu %12zu %14.3f %14.3f %14.3f %9.1fx\n", grid.corners.size(), vertices.size(), unordered, serial, parallel, unordered / parallel);
+	}
+}
@@ -0,0 +1,114 @@
+#include "bench.h"
+#include "objLoader.h"
+
+namespace {
+	// a quad grid written as triangles with positions, texcoords and normals, close to what
+	// a scanned asset looks like to the parser; side 1000 is about 100 MB of text
+	std::string writeGridObj(const std::filesystem::path& path, size_t side)
+	{
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!out.is_open())
+			throw std::runtime_error("failed to open " + path.string() + " for writing");
+
+		char line[128];
+		for (size_t z = 0; z <= side; z++) {
+			for (size_t x = 0; x <= side; x++) {
+				int length = snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\n", x * 0.01, 0.001 * ((x * 7 + z * 13) % 100), z * 0.01,
+					static_cast<double>(x) / side, static_cast<double>(z) / side);
+				out.write(line, length);
+			}
+		}
+		out << "vn 0 1 0\n";
+
+		auto index = [side](size_t x, size_t z) { return z * (side + 1) + x + 1; };
+		for (size_t z = 0; z < side; z++) {
+			for (size_t x = 0; x < side; x++) {
+				size_t a = index(x, z), b = index(x, z + 1), c = index(x + 1, z), d = index(x + 1, z + 1);
+				int length = snprintf(line, sizeof(line), "f %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\nf %zu/%zu/1 %zu/%zu/1 %zu/%zu/1\n", a, a, b, b, c, c, c, c, b, b, d, d);
+				out.write(line, length);
+			}
+		}
+
+		if (!out.good())
+			throw std::runtime_error("failed to write " + path.string());
+
+		return path.string();
+	}
+
+	// the generated input is removed however the benchmark ends
+	struct TemporaryFile {
+		std::filesystem::path path;
+
+		~TemporaryFile() {
+			std::error_code ec;
+			if (!path.empty())
+				std::filesystem::remove(path, ec);
+		}
+	};
+
+	void loadWithTinyObj(const std::string& path, const std::optional<std::string>& materialDir, size_t& corners)
+	{
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string warn, err;
+
+		bool loaded = materialDir
+			? tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str(), materialDir->c_str())
+			: tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str());
+
+		if (!loaded)
+			throw std::runtime_error(warn + err);
+
+		corners = 0;
+		for (const auto& shape : shapes)
+			corners += shape.mesh.indices.size();
+	}
+}
+
+void Engine::Bench::objLoader(const BenchOptions& options)
+{
+	std::vector<std::string> paths;
+	for (const std::string& file : options.files) {
+		if (std::filesystem::path(file).extension() == ".obj")
+			paths.push_back(file);
+	}
+
+	TemporaryFile generated;
+	if (paths.empty()) {
+		generated.path = std::filesystem::temp_directory_path() / "fortify_bench.obj";
+		paths.push_back(writeGridObj(generated.path, 1000));
+	}
+
+	printf("OBJ parsing in MB/s, best of %zu runs\n", options.runs);
+	printf("%10s %12s %12s %12s %12s  %s\n", "MB", "corners", "tinyobj", "serial", "chunked", "file");
+
+	for (const std::string& path : paths) {
+		const double megabytes = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+
+		// materials are read as well, from next to the OBJ, since loading them is part of the parse
+		std::optional<std::string> materialDir;
+		if (generated.path.empty())
+			materialDir = std::filesystem::path(path).parent_path().string();
+
+		size_t tinyobjCorners = 0;
+		const double tinyobj = measure(options.runs, [&]() { loadWithTinyObj(path, materialDir, tinyobjCorners); });
+
+		size_t corners = 0;
+		auto chunked = [&]() { corners = Engine::Graphics::ObjLoader::load(path, materialDir).corners.size(); };
+
+		// the same parser with the pool taken away parses the file as one chunk
+		double serial = 0.0;
+		{
+			WithoutThreadPool serialScope;
+			serial = measure(options.runs, chunked);
+		}
+
+		const double parallel = measure(options.runs, chunked);
+
+		if (corners != tinyobjCorners)
+			throw std::runtime_error(path + " parsed to " + std::to_string(corners) + " corners, tinyobj found " + std::to_string(tinyobjCorners));
+
+		printf("%10.1f %12zu %12.1f %12.1f %12.1f  %s\n", megabytes, corners, megabytes / tinyobj, megabytes / serial, megabytes / parallel, path.c_str());
+	}
+}
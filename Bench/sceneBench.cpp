@@ -0,0 +1,68 @@
+#include "bench.h"
+#include "sceneManager.h"
+
+namespace {
+	constexpr size_t FRAMES = 1000;
+
+	// the CPU side of a frame that touches every entity: gathering lights for the scene
+	// buffer and walking the draw order for push constants, as drawFrame and
+	// recordCommandBuffer do, through the same span views the scene manager hands out
+	uint64_t frame(std::span<const Scene> scenes, std::span<const uint32_t> drawOrder, std::vector<Engine::Graphics::LightBuffer>& lights, std::vector<Engine::Graphics::ObjectPushConstants>& pushes)
+	{
+		lights.clear();
+		for (const Scene& scene : scenes | std::views::filter([](const Scene& scene) { return scene.model.type == EntityType::Light; })) {
+			Engine::Graphics::LightBuffer light{};
+			light.pos = glm::vec3(scene.model.matrix[3]);
+			light.color = scene.model.color;
+			lights.push_back(light);
+		}
+
+		pushes.clear();
+		uint64_t indexCount = 0;
+		for (uint32_t index : drawOrder) {
+			const Model& m = scenes[index].model;
+
+			Engine::Graphics::ObjectPushConstants push{};
+			push.model = m.matrix;
+			push.color = m.color;
+			pushes.push_back(push);
+
+			indexCount += m.indexCount;
+		}
+
+		return indexCount + lights.size();
+	}
+}
+
+void Engine::Bench::sceneIteration(const BenchOptions& options)
+{
+	printf("scene iteration, %zu frames per run\n", FRAMES);
+	printf("%10s %14s %14s\n", "entities", "us/frame", "ns/entity");
+
+	for (size_t entityCount : { 10, 100, 1000, 5000, 10000 }) {
+		std::vector<Scene> scenes(entityCount);
+		std::vector<uint32_t> drawOrder(entityCount);
+
+		for (size_t i = 0; i < entityCount; i++) {
+			Model& m = scenes[i].model;
+			m.type = i % 16 == 0 ? EntityType::Light : EntityType::PBRObject;
+			m.indexCount = static_cast<uint32_t>(36 + i % 7);
+			m.matrix = glm::translate(glm::mat4(1.0f), glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+			drawOrder[i] = static_cast<uint32_t>(i);
+		}
+
+		std::vector<Engine::Graphics::LightBuffer> lights;
+		std::vector<Engine::Graphics::ObjectPushConstants> pushes;
+		lights.reserve(entityCount);
+		pushes.reserve(entityCount);
+
+		uint64_t checksum = 0;
+		double seconds = measure(options.runs, [&]() {
+			for (size_t f = 0; f < FRAMES; f++)
+				checksum += frame(scenes, drawOrder, lights, pushes);
+		});
+
+		const double perFrame = seconds / FRAMES;
+		printf("%10zu %14.2f %14.2f  (checksum %llu)\n", entityCount, perFrame * 1e6, perFrame * 1e9 / entityCount, static_cast<unsigned long long>(checksum));
+	}
+}
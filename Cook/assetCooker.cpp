@@ -0,0 +1,416 @@
+#include "assetCooker.h"
+#include "objLoader.h"
+#include "textureDataCache.h"
+#include "threadPool.h"
+#include <map>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	double elapsedMs(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	double megabytes(uint64_t bytes)
+	{
+		return bytes / (1024.0 * 1024.0);
+	}
+
+	std::string lowerExtension(const std::filesystem::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return extension;
+	}
+
+	const char* formatName(VkFormat format)
+	{
+		switch (format) {
+			case VK_FORMAT_R8G8B8A8_SRGB: return "RGBA8 sRGB";
+			case VK_FORMAT_R8G8B8A8_UNORM: return "RGBA8";
+			case VK_FORMAT_R8G8_UNORM: return "RG8";
+			case VK_FORMAT_R8_UNORM: return "R8";
+			case VK_FORMAT_BC1_RGB_SRGB_BLOCK: return "BC1 sRGB";
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK: return "BC1";
+			case VK_FORMAT_BC4_UNORM_BLOCK: return "BC4";
+			case VK_FORMAT_BC5_UNORM_BLOCK: return "BC5";
+			case VK_FORMAT_BC7_SRGB_BLOCK: return "BC7 sRGB";
+			case VK_FORMAT_BC7_UNORM_BLOCK: return "BC7";
+			default: return "other";
+		}
+	}
+
+	// same slots as RTSceneManager::loadScene; a channel of -1 is not packed
+	struct LooseSlot {
+		const char* keyword;
+		const char* altKeyword;
+		VkFormat format;
+		int ormChannel;
+	};
+
+	const LooseSlot LOOSE_SLOTS[] = {
+		{ "albedo", "diffuse", pbrTextureFormat(PBRTextureType::Albedo), -1 },
+		{ "normal", nullptr, pbrTextureFormat(PBRTextureType::Normal), -1 },
+		{ "roughness", nullptr, VK_FORMAT_UNDEFINED, 1 },
+		{ "metalness", nullptr, VK_FORMAT_UNDEFINED, 2 },
+		{ "specular", nullptr, pbrTextureFormat(PBRTextureType::Specular), -1 },
+		{ "height", nullptr, VK_FORMAT_R8_UNORM, -1 },
+		{ "ambient_occlusion", nullptr, VK_FORMAT_UNDEFINED, 0 },
+	};
+}
+
+Engine::Cook::AssetCooker::AssetCooker(CookOptions options) : options(std::move(options))
+{
+}
+
+bool Engine::Cook::AssetCooker::run()
+{
+	auto start = Clock::now();
+
+	if (!std::filesystem::is_directory(options.root))
+		throw std::runtime_error("asset directory " + options.root + " does not exist");
+
+	// loaded even when forced, so entries of assets outside this run survive the save
+	manifest.load(options.manifestPath);
+
+	std::vector<std::string> images;
+	scan(images);
+	printf("cooking %s: %zu models, %zu images, %zu workers\n", options.root.c_str(), meshes.size(), images.size(), threadPool->size());
+
+	// materials decide the formats of the maps they use, so meshes go first
+	cookMeshes();
+	queueLooseTextures(images);
+	cookTextures();
+
+	if (!manifest.save(options.manifestPath))
+		printf("failed to write %s\n", options.manifestPath.c_str());
+
+	const double seconds = elapsedMs(start) / 1000.0;
+	const size_t cooked = totals.meshes + totals.textures;
+
+	printf("\ncooked %zu assets (%zu meshes, %zu textures), %zu up to date, %zu failed\n", cooked, totals.meshes, totals.textures, totals.skipped, totals.failed);
+	printf("read %.1f MB, wrote %.1f MB in %.2f s (%.1f MB/s, %.1f assets/s)\n", megabytes(totals.bytesRead), megabytes(totals.bytesWritten), seconds,
+		seconds > 0.0 ? megabytes(totals.bytesRead) / seconds : 0.0, seconds > 0.0 ? cooked / seconds : 0.0);
+
+	return totals.failed == 0;
+}
+
+void Engine::Cook::AssetCooker::scan(std::vector<std::string>& images)
+{
+	std::vector<std::filesystem::path> files;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(options.root, std::filesystem::directory_options::skip_permission_denied)) {
+		if (entry.is_regular_file())
+			files.push_back(entry.path());
+	}
+
+	// directory order differs between platforms; sorting keeps the output and ORM packing stable
+	std::sort(files.begin(), files.end());
+
+	for (const auto& file : files) {
+		const std::string extension = lowerExtension(file);
+
+		if (extension == ".obj") {
+			MeshJob job;
+			job.model = file.string();
+			job.sources = { job.model };
+
+			// a model with a material library is loaded the way MatObject entities load it,
+			// with the library next to the model; the same copy serves loads without materials
+			const std::string dir = file.parent_path().string();
+			std::vector<std::string> libraries = Engine::Graphics::ObjLoader::materialLibraries(job.model, dir);
+			if (!libraries.empty()) {
+				job.materialDir = dir;
+				job.sources.insert(job.sources.end(), libraries.begin(), libraries.end());
+			}
+
+			job.output = Engine::Graphics::MeshCache::cachePath(job.model);
+			meshes.push_back(std::move(job));
+		}
+		else if (std::find(Engine::Utility::imageFileTypes.begin(), Engine::Utility::imageFileTypes.end(), extension) != Engine::Utility::imageFileTypes.end()) {
+			images.push_back(file.string());
+		}
+	}
+}
+
+void Engine::Cook::AssetCooker::cookMeshes()
+{
+	for (const MeshJob& job : meshes) {
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<Materials> materials;
+
+		try {
+			if (!options.force && manifest.upToDate(job.output, job.sources)) {
+				totals.skipped++;
+				if (options.verbose)
+					printf("  up to date  %s\n", job.model.c_str());
+
+				// the cooked copy still names the maps to cook
+				if (job.materialDir)
+					Engine::Graphics::MeshCache::loadObj(job.model, job.materialDir, vertices, indices, &materials);
+			}
+			else {
+				auto start = Clock::now();
+				Engine::Graphics::MeshCache::cook(job.model, job.materialDir, vertices, indices, materials);
+				const double ms = elapsedMs(start);
+
+				std::error_code ec;
+				const uint64_t written = std::filesystem::file_size(job.output, ec);
+				if (ec) {
+					flushLogs();
+					fail(job.model, "no cooked copy was written");
+					continue;
+				}
+
+				const uint64_t read = totalSize(job.sources);
+				manifest.record(job.output, job.sources);
+				totals.meshes++;
+				totals.bytesRead += read;
+				totals.bytesWritten += written;
+
+				printf("  mesh     %s: %zu vertices, %zu indices, %zu materials, %.1f MB -> %.1f MB in %.1f ms\n", job.model.c_str(), vertices.size(), indices.size(),
+					materials.size(), megabytes(read), megabytes(written), ms);
+			}
+		}
+		catch (const std::exception& e) {
+			flushLogs();
+			fail(job.model, e.what());
+			continue;
+		}
+
+		flushLogs();
+
+		if (job.materialDir)
+			queueMaterialTextures(*job.materialDir, materials);
+	}
+}
+
+void Engine::Cook::AssetCooker::cookTextures()
+{
+	std::vector<const TextureJob*> pending;
+	for (const TextureJob& job : textures) {
+		if (!options.force && manifest.upToDate(job.output, job.sources)) {
+			totals.skipped++;
+			if (options.verbose)
+				printf("  up to date  %s\n", job.sources.front().c_str());
+			continue;
+		}
+
+		pending.push_back(&job);
+	}
+
+	if (pending.empty())
+		return;
+
+	// the decoded pixels of a whole batch are held at once, so batches stay a few per worker
+	const size_t batchSize = std::max<size_t>(4, (threadPool->size() + 1) * 2);
+
+	for (size_t first = 0; first < pending.size(); first += batchSize) {
+		const size_t count = std::min(batchSize, pending.size() - first);
+
+		Engine::Graphics::TextureLoadJob load;
+		std::vector<std::optional<size_t>> indices(count);
+
+		for (size_t i = 0; i < count; i++) {
+			const TextureJob& job = *pending[first + i];
+			try {
+				indices[i] = job.packed ? load.addPacked(job.paths, ORM_DEFAULTS, options.flip) : load.add(job.paths[0], options.flip, job.format);
+			}
+			catch (const std::exception& e) {
+				fail(job.sources.front(), e.what());
+			}
+		}
+
+		// each image is stored as soon as it is decoded while the rest keep decoding
+		struct Store {
+			const Engine::Graphics::DecodedImage* image = nullptr;
+			std::future<std::pair<bool, double>> result;
+		};
+
+		std::vector<Store> stores(count);
+		for (size_t i = 0; i < count; i++) {
+			if (!indices[i])
+				continue;
+
+			const TextureJob& job = *pending[first + i];
+			try {
+				const Engine::Graphics::DecodedImage& image = load.get(*indices[i]);
+				stores[i].image = &image;
+				stores[i].result = threadPool->submit([&image, &job]() {
+					auto start = Clock::now();
+					bool stored = Engine::Graphics::TextureDataCache::store(image.key, job.sources, static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height), image.data(), image.regions);
+					return std::make_pair(stored, elapsedMs(start));
+				});
+			}
+			catch (const std::exception& e) {
+				fail(job.sources.front(), e.what());
+			}
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			if (!stores[i].image)
+				continue;
+
+			const TextureJob& job = *pending[first + i];
+			try {
+				auto [stored, ms] = stores[i].result.get();
+				if (!finishTexture(job, *stores[i].image, ms, stored))
+					fail(job.sources.front(), "no cooked copy was written");
+			}
+			catch (const std::exception& e) {
+				fail(job.sources.front(), e.what());
+			}
+		}
+
+		flushLogs();
+	}
+}
+
+void Engine::Cook::AssetCooker::queueMaterialTextures(const std::string& baseDir, const std::vector<Materials>& materials)
+{
+	// same paths and formats as SceneManager's MatObject entities
+	for (const Materials& mat : materials) {
+		std::unordered_map<PBRTextureType, std::string> paths;
+		const std::pair<PBRTextureType, const std::string*> maps[] = {
+			{ PBRTextureType::Albedo, &mat.diffusePath },
+			{ PBRTextureType::Normal, &mat.normalPath },
+			{ PBRTextureType::Roughness, &mat.roughnessPath },
+			{ PBRTextureType::Metalness, &mat.metalnessPath },
+			{ PBRTextureType::AmbientOcclusion, &mat.aoPath },
+			{ PBRTextureType::Specular, &mat.specularPath },
+		};
+
+		for (const auto& [type, file] : maps) {
+			if (file->empty())
+				continue;
+
+			std::string path = baseDir + "/" + *file;
+			claimed.insert(Engine::Graphics::TextureCache::makeKey(path, false, VK_FORMAT_UNDEFINED).path);
+			paths.insert({ type, std::move(path) });
+		}
+
+		for (PBRTextureType type : PBR_UPLOAD_ORDER) {
+			if (type == PBRTextureType::OcclusionRoughnessMetalness) {
+				std::array<std::string, 3> sources;
+				for (size_t c = 0; c < sources.size(); c++) {
+					auto it = paths.find(ORM_CHANNELS[c]);
+					sources[c] = it != paths.end() ? it->second : std::string();
+				}
+
+				if (std::any_of(sources.begin(), sources.end(), [](const std::string& source) { return !source.empty(); }))
+					queuePacked(sources);
+			}
+			else if (auto it = paths.find(type); it != paths.end()) {
+				queueTexture(it->second, pbrTextureFormat(type));
+			}
+		}
+	}
+}
+
+void Engine::Cook::AssetCooker::queueLooseTextures(const std::vector<std::string>& images)
+{
+	// roughness, metalness and ambient occlusion maps in one directory share an ORM texture
+	std::map<std::string, std::array<std::string, 3>> ormSources;
+
+	for (const auto& image : images) {
+		if (claimed.contains(Engine::Graphics::TextureCache::makeKey(image, false, VK_FORMAT_UNDEFINED).path))
+			continue;
+
+		const std::string name = std::filesystem::path(image).filename().string();
+		auto slot = std::find_if(std::begin(LOOSE_SLOTS), std::end(LOOSE_SLOTS), [&name](const LooseSlot& slot) {
+			return name.find(slot.keyword) != std::string::npos || (slot.altKeyword && name.find(slot.altKeyword) != std::string::npos);
+		});
+
+		// anything else is loaded as a plain colour texture
+		if (slot == std::end(LOOSE_SLOTS))
+			queueTexture(image, VK_FORMAT_R8G8B8A8_SRGB);
+		else if (slot->ormChannel >= 0)
+			ormSources[std::filesystem::path(image).parent_path().string()][slot->ormChannel] = image;
+		else
+			queueTexture(image, slot->format);
+	}
+
+	for (const auto& [dir, sources] : ormSources)
+		queuePacked(sources);
+}
+
+void Engine::Cook::AssetCooker::queueTexture(const std::string& path, VkFormat format)
+{
+	TextureJob job;
+	job.paths[0] = path;
+	job.format = format;
+	job.sources = { path };
+
+	queue(std::move(job), Engine::Graphics::TextureCache::makeKey(path, options.flip, Engine::Graphics::selectTextureFormat(format)));
+}
+
+void Engine::Cook::AssetCooker::queuePacked(const std::array<std::string, 3>& paths)
+{
+	TextureJob job;
+	job.paths = paths;
+	job.packed = true;
+	job.format = VK_FORMAT_R8G8B8A8_UNORM;
+	std::copy_if(paths.begin(), paths.end(), std::back_inserter(job.sources), [](const std::string& path) { return !path.empty(); });
+
+	queue(std::move(job), Engine::Graphics::TextureLoadJob::packedKey(paths, ORM_DEFAULTS, options.flip));
+}
+
+void Engine::Cook::AssetCooker::queue(TextureJob job, const Engine::Graphics::TextureKey& key)
+{
+	job.output = Engine::Graphics::TextureDataCache::cachePath(key, job.sources.front());
+
+	// textures shared between materials are cooked once
+	if (queuedOutputs.insert(job.output).second)
+		textures.push_back(std::move(job));
+}
+
+bool Engine::Cook::AssetCooker::finishTexture(const TextureJob& job, const Engine::Graphics::DecodedImage& image, double cookMs, bool stored)
+{
+	std::error_code ec;
+	const uint64_t written = std::filesystem::file_size(job.output, ec);
+	if (!stored || ec)
+		return false;
+
+	const uint64_t read = totalSize(job.sources);
+	manifest.record(job.output, job.sources);
+	totals.textures++;
+	totals.bytesRead += read;
+	totals.bytesWritten += written;
+
+	const uint32_t width = static_cast<uint32_t>(image.width);
+	const uint32_t height = static_cast<uint32_t>(image.height);
+	const uint32_t levels = image.hasMipChain() ? image.levels : Engine::Graphics::mipLevelCount(width, height);
+
+	printf("  texture  %s: %ux%u %s, %u levels, %.1f MB -> %.1f MB, decode %.1f ms, cook %.1f ms\n", image.path.c_str(), width, height, formatName(image.key.format), levels,
+		megabytes(read), megabytes(written), image.decodeMs, cookMs);
+	return true;
+}
+
+void Engine::Cook::AssetCooker::fail(const std::string& asset, const std::string& reason)
+{
+	totals.failed++;
+	printf("  FAILED   %s: %s\n", asset.c_str(), reason.c_str());
+}
+
+void Engine::Cook::AssetCooker::flushLogs()
+{
+	// the engine logs to the in-app console; the cooker only echoes it when asked
+	g_logBuffer.flush(g_console);
+	if (options.verbose && g_console.buffer.size() > 0)
+		printf("%s", g_console.buffer.c_str());
+	g_console.clear();
+}
+
+uint64_t Engine::Cook::AssetCooker::totalSize(const std::vector<std::string>& paths)
+{
+	uint64_t total = 0;
+	for (const auto& path : paths) {
+		std::error_code ec;
+		auto size = std::filesystem::file_size(path, ec);
+		if (!ec)
+			total += static_cast<uint64_t>(size);
+	}
+
+	return total;
+}
@@ -0,0 +1,89 @@
+#ifndef ASSETCOOKER_H
+#define ASSETCOOKER_H
+
+#include "cookManifest.h"
+#include "meshCache.h"
+#include "textureLoader.h"
+#include <unordered_set>
+
+namespace Engine::Cook {
+	struct CookOptions {
+		std::string root;
+		std::string manifestPath = CookManifest::DEFAULT_PATH;
+		bool force = false;
+		bool flip = false;
+		bool verbose = false;
+	};
+
+	// Walks an asset directory and writes the same .fmesh and .ftex files the engine cooks
+	// on first load, so a run of the app starts from warm caches. OBJ models are cooked one
+	// after another, each parsed and built across the thread pool; textures are decoded and
+	// cooked many at a time. Outputs whose sources match the manifest are skipped.
+	//
+	// Textures get the format the engine would load them with: material maps by their slot,
+	// with roughness, metalness and ambient occlusion packed into ORM, and loose images by
+	// the file name keywords the ray tracing scenes use. Cache paths are relative, so the
+	// cooker must run from the app's working directory with root as the app refers to it.
+	class AssetCooker
+	{
+	private:
+		struct MeshJob {
+			std::string model;
+			std::optional<std::string> materialDir;
+			std::vector<std::string> sources;
+			std::string output;
+		};
+
+		struct TextureJob {
+			std::array<std::string, 3> paths;
+			bool packed = false;
+			VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+			std::vector<std::string> sources;
+			std::string output;
+		};
+
+		struct Totals {
+			size_t meshes = 0;
+			size_t textures = 0;
+			size_t skipped = 0;
+			size_t failed = 0;
+			uint64_t bytesRead = 0;
+			uint64_t bytesWritten = 0;
+		};
+
+		CookOptions options;
+		CookManifest manifest;
+		Totals totals;
+
+		std::vector<MeshJob> meshes;
+		std::vector<TextureJob> textures;
+		std::unordered_set<std::string> queuedOutputs;
+		// canonical paths of images a material already uses, left out of the loose pass
+		std::unordered_set<std::string> claimed;
+
+	public:
+		explicit AssetCooker(CookOptions options);
+
+		// returns false if any asset failed to cook
+		bool run();
+
+	private:
+		void scan(std::vector<std::string>& images);
+		void cookMeshes();
+		void cookTextures();
+
+		void queueMaterialTextures(const std::string& baseDir, const std::vector<Materials>& materials);
+		void queueLooseTextures(const std::vector<std::string>& images);
+		void queueTexture(const std::string& path, VkFormat format);
+		void queuePacked(const std::array<std::string, 3>& paths);
+		void queue(TextureJob job, const Engine::Graphics::TextureKey& key);
+
+		bool finishTexture(const TextureJob& job, const Engine::Graphics::DecodedImage& image, double cookMs, bool stored);
+		void fail(const std::string& asset, const std::string& reason);
+		void flushLogs();
+
+		static uint64_t totalSize(const std::vector<std::string>& paths);
+	};
+}
+
+#endif
@@ -0,0 +1,59 @@
+#include "assetPacker.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+Engine::Cook::AssetPacker::AssetPacker(PackOptions options) : options(std::move(options))
+{
+}
+
+bool Engine::Cook::AssetPacker::run()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	std::error_code ec;
+	const std::filesystem::path output = std::filesystem::weakly_canonical(options.output, ec);
+
+	// an earlier pack or an interrupted write must not end up inside the new one
+	auto skipped = [&](const std::filesystem::path& path) {
+		std::error_code ec;
+		return path.extension() == ".tmp" || std::filesystem::weakly_canonical(path, ec) == output;
+	};
+
+	std::vector<Engine::Utility::AssetPack::Source> sources;
+	for (const auto& input : options.inputs) {
+		if (std::filesystem::is_regular_file(input)) {
+			if (!skipped(input))
+				sources.push_back({ input, input });
+			continue;
+		}
+
+		if (!std::filesystem::is_directory(input))
+			throw std::runtime_error(input + " does not exist");
+
+		for (const auto& entry : std::filesystem::recursive_directory_iterator(input, std::filesystem::directory_options::skip_permission_denied)) {
+			if (entry.is_regular_file() && !skipped(entry.path()))
+				sources.push_back({ entry.path().string(), entry.path().string() });
+		}
+	}
+
+	printf("packing %zu files into %s\n", sources.size(), options.output.c_str());
+
+	Engine::Utility::AssetPack::WriteStats stats = Engine::Utility::AssetPack::write(options.output, std::move(sources), options.compress);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const double inputMB = stats.inputBytes / (1024.0 * 1024.0);
+	const double outputMB = stats.outputBytes / (1024.0 * 1024.0);
+	printf("packed %zu files (%zu LZ4 compressed): %.1f MB -> %.1f MB (%.0f%%) in %.2f s (%.1f MB/s)\n", stats.entries, stats.compressed, inputMB, outputMB,
+		inputMB > 0.0 ? outputMB / inputMB * 100.0 : 100.0, seconds, seconds > 0.0 ? inputMB / seconds : 0.0);
+
+	Engine::Utility::AssetPack pack;
+	if (!pack.open(options.output) || pack.size() != stats.entries) {
+		printf("%s does not read back\n", options.output.c_str());
+		return false;
+	}
+
+	return true;
+}
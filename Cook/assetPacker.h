@@ -0,0 +1,30 @@
+#ifndef ASSETPACKER_H
+#define ASSETPACKER_H
+
+#include "assetPack.h"
+
+namespace Engine::Cook {
+	struct PackOptions {
+		std::vector<std::string> inputs;
+		std::string output = Engine::Utility::AssetPack::DEFAULT_PATH;
+		bool compress = true;
+	};
+
+	// Gathers files and directories into one .fpak. Packing the cache directories along
+	// with the sources lets a cold start load cooked meshes and textures straight out of
+	// the pack; loose cooked files still win, so re-cooking after packing is not hidden. Inputs are named as given, so they must be relative to the app's working
+	// directory like every other asset path.
+	class AssetPacker
+	{
+	private:
+		PackOptions options;
+
+	public:
+		explicit AssetPacker(PackOptions options);
+
+		// returns false if the written pack does not open
+		bool run();
+	};
+}
+
+#endif
@@ -0,0 +1,145 @@
+#include "cookManifest.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+namespace {
+	constexpr const char* HEADER = "FortifyCook manifest 1";
+}
+
+void Engine::Cook::CookManifest::load(const std::string& path)
+{
+	entries.clear();
+
+	std::ifstream file(path);
+	std::string line;
+	if (!file.is_open() || !std::getline(file, line) || line != HEADER)
+		return;
+
+	std::vector<Dependency>* current = nullptr;
+	while (std::getline(file, line)) {
+		if (line.rfind("out ", 0) == 0) {
+			current = &entries[line.substr(4)];
+			current->clear();
+			continue;
+		}
+
+		if (!current || line.rfind("dep ", 0) != 0)
+			continue;
+
+		// dep <size> <time> <path>; the path runs to the end of the line
+		std::istringstream stream(line.substr(4));
+		Dependency dependency;
+		if (!(stream >> dependency.size >> dependency.time))
+			continue;
+
+		stream.get();
+		std::getline(stream, dependency.path);
+		if (!dependency.path.empty())
+			current->push_back(std::move(dependency));
+	}
+}
+
+bool Engine::Cook::CookManifest::save(const std::string& path) const
+{
+	std::filesystem::path target(path);
+	std::filesystem::path temp = target;
+	temp += ".tmp";
+
+	std::error_code ec;
+	if (target.has_parent_path())
+		std::filesystem::create_directories(target.parent_path(), ec);
+
+	// sorted so the file diffs cleanly between runs
+	std::vector<const std::string*> outputs;
+	outputs.reserve(entries.size());
+	for (const auto& [output, dependencies] : entries)
+		outputs.push_back(&output);
+	std::sort(outputs.begin(), outputs.end(), [](const std::string* a, const std::string* b) { return *a < *b; });
+
+	{
+		std::ofstream file(temp, std::ios::trunc);
+		if (!file.is_open())
+			return false;
+
+		file << HEADER << "\n";
+		for (const std::string* output : outputs) {
+			file << "out " << *output << "\n";
+			for (const auto& dependency : entries.at(*output))
+				file << "dep " << dependency.size << " " << dependency.time << " " << dependency.path << "\n";
+		}
+
+		if (!file.good()) {
+			file.close();
+			std::filesystem::remove(temp, ec);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(temp, target, ec);
+	if (ec) {
+		std::filesystem::remove(temp, ec);
+		return false;
+	}
+
+	return true;
+}
+
+bool Engine::Cook::CookManifest::upToDate(const std::string& output, const std::vector<std::string>& sources) const
+{
+	auto it = entries.find(output);
+	if (it == entries.end() || it->second.size() != sources.size())
+		return false;
+
+	std::error_code ec;
+	if (!std::filesystem::exists(output, ec))
+		return false;
+
+	for (size_t i = 0; i < sources.size(); i++) {
+		const Dependency& recorded = it->second[i];
+
+		Dependency current;
+		if (recorded.path != sources[i] || !stamp(sources[i], current))
+			return false;
+
+		if (current.size != recorded.size || current.time != recorded.time)
+			return false;
+	}
+
+	return true;
+}
+
+void Engine::Cook::CookManifest::record(const std::string& output, const std::vector<std::string>& sources)
+{
+	std::vector<Dependency> dependencies;
+	for (const auto& source : sources) {
+		Dependency dependency;
+		if (!stamp(source, dependency)) {
+			entries.erase(output);
+			return;
+		}
+
+		dependencies.push_back(std::move(dependency));
+	}
+
+	entries[output] = std::move(dependencies);
+}
+
+bool Engine::Cook::CookManifest::stamp(const std::string& path, Dependency& dependency)
+{
+	std::error_code ec;
+
+	auto size = std::filesystem::file_size(path, ec);
+	if (ec)
+		return false;
+
+	auto time = std::filesystem::last_write_time(path, ec);
+	if (ec)
+		return false;
+
+	dependency.path = path;
+	dependency.size = static_cast<uint64_t>(size);
+	dependency.time = static_cast<int64_t>(time.time_since_epoch().count());
+	return true;
+}
@@ -0,0 +1,41 @@
+#ifndef COOKMANIFEST_H
+#define COOKMANIFEST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace Engine::Cook {
+	struct Dependency {
+		std::string path;
+		uint64_t size = 0;
+		int64_t time = 0;
+	};
+
+	// Sources each cooked output was last built from, with the size and timestamp they had
+	// then. Stored as text, one "out" line per output followed by its "dep" lines.
+	class CookManifest
+	{
+	private:
+		std::unordered_map<std::string, std::vector<Dependency>> entries;
+
+	public:
+		static constexpr const char* DEFAULT_PATH = "cache/cook.manifest";
+
+		// a missing or unreadable manifest just leaves it empty, so everything is cooked
+		void load(const std::string& path);
+		bool save(const std::string& path) const;
+
+		// true when output exists and was cooked from exactly these sources, none of which
+		// has changed size or timestamp since
+		bool upToDate(const std::string& output, const std::vector<std::string>& sources) const;
+		void record(const std::string& output, const std::vector<std::string>& sources);
+
+		size_t size() const { return entries.size(); }
+
+		static bool stamp(const std::string& path, Dependency& dependency);
+	};
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include "assetCooker.h"
+#include "assetPacker.h"
+#include "threadPool.h"
+#include <cstdlib>
+
+namespace {
+	void printUsage()
+	{
+		printf(
+			"usage: FortifyCook <asset directory> [options]\n"
+			"       FortifyCook --pack <archive> <file or directory>... [--no-lz4]\n"
+			"  --force          cook everything, ignoring the manifest\n"
+			"  --flip           flip textures vertically, as entities loaded with flipTexture do\n"
+			"  --no-compress    store textures uncompressed, for devices without BC support\n"
+			"  --bc1            store colour maps as BC1 instead of BC7\n"
+			"  --threads <n>    worker threads (default: one per core but one)\n"
+			"  --manifest <f>   dependency manifest (default: %s)\n"
+			"  --verbose        echo engine log messages\n"
+			"  --pack <f>       write the inputs into an asset pack instead of cooking\n"
+			"  --no-lz4         store pack entries uncompressed\n"
+			"run from the app's working directory; the caches are written relative to it\n",
+			Engine::Cook::CookManifest::DEFAULT_PATH);
+	}
+}
+
+int main(int argc, char** argv) {
+	Engine::Cook::CookOptions options;
+	Engine::Cook::PackOptions pack;
+	std::vector<std::string> inputs;
+	bool packing = false;
+	size_t threads = Engine::Utility::ThreadPool::defaultThreadCount();
+	bool compress = true;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+
+		if (arg == "--force")
+			options.force = true;
+		else if (arg == "--flip")
+			options.flip = true;
+		else if (arg == "--verbose")
+			options.verbose = true;
+		else if (arg == "--no-compress")
+			compress = false;
+		else if (arg == "--bc1")
+			Engine::Settings::colourCompression = Engine::Settings::ColourCompression::BC1;
+		else if (arg == "--threads" && i + 1 < argc)
+			threads = static_cast<size_t>(std::max(0, atoi(argv[++i])));
+		else if (arg == "--manifest" && i + 1 < argc)
+			options.manifestPath = argv[++i];
+		else if (arg == "--pack" && i + 1 < argc) {
+			packing = true;
+			pack.output = argv[++i];
+		}
+		else if (arg == "--no-lz4")
+			pack.compress = false;
+		else if (arg == "--help" || arg == "-h") {
+			printUsage();
+			return EXIT_SUCCESS;
+		}
+		else if (arg.rfind("--", 0) != 0)
+			inputs.push_back(arg);
+		else {
+			printUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	// cooking takes one asset directory, packing any number of inputs
+	if (inputs.empty() || (!packing && inputs.size() > 1)) {
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	options.root = inputs.front();
+	pack.inputs = inputs;
+
+	// there is no device to ask, so the target is assumed to sample BC formats
+	Engine::Settings::compressTextures = compress;
+	Engine::Graphics::setBlockCompressionSupport(compress);
+	// textures are stored by the cooker itself rather than queued as background cooks
+	Engine::Settings::cookTextures = false;
+
+	// submitted work only runs on workers, so the pool always keeps one
+	threadPool = std::make_unique<Engine::Utility::ThreadPool>(std::max<size_t>(threads, 1));
+
+	bool succeeded = false;
+	try {
+		if (packing) {
+			Engine::Cook::AssetPacker packer(pack);
+			succeeded = packer.run();
+		}
+		else {
+			Engine::Cook::AssetCooker cooker(options);
+			succeeded = cooker.run();
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+	}
+
+	threadPool.reset();
+	return succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -14,6 +14,12 @@
 #include "swapchain.h"
 #include "camera.h"
 #include "rtSceneManager.h"
+#include "pipelineCache.h"
+#include "textureCache.h"
+#include "textureDataCache.h"
+#include "mipGenerator.h"
+#include "threadPool.h"
+#include "assetPack.h"
 #include "imgui.h"
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_vulkan.h"
@@ -43,6 +49,7 @@ namespace Engine::Core {
 		static void mouse_callback(GLFWwindow* window, double xposIn, double yposIn);
 
 		void recreateSwapchain();
+		void applyFramesInFlight();
 		void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
 		void createImGuiRenderPass();
@@ -73,6 +80,10 @@ namespace Engine::Core {
 		VkDescriptorPool imguiPool = VK_NULL_HANDLE;
 		VkRenderPass imguiRenderPass = VK_NULL_HANDLE;
 		std::vector<VkFramebuffer> imguiFramebuffers;
+		std::array<uint64_t, Engine::Settings::MAX_FRAMES_IN_FLIGHT> submittedFrames{};
+		std::vector<VkFence> imagesInFlight;
+		int framesInFlight = Engine::Settings::DEFAULT_FRAMES_IN_FLIGHT;
+		int requestedFramesInFlight = Engine::Settings::DEFAULT_FRAMES_IN_FLIGHT;
 		bool accumulateFrames = true;
 		bool fullscreen = false;
 
@@ -3,6 +3,7 @@
 #include "imgui.h"
 #include "ImGuizmo.h"
 #include "imfilebrowser.h"
+#include <span>
 
 namespace Engine::Graphics {
     class Device;
@@ -37,7 +38,7 @@ namespace Engine::Core {
             void pushToAccelerationStructure(std::vector<std::shared_ptr<RTScene>>& dst);
             void updateScene(float deltaTime);
 
-            std::vector<std::shared_ptr<RTScene>> getScenes() const { return scenes; }
+            std::span<const std::shared_ptr<RTScene>> getScenes() const { return scenes; }
             
         private:
             std::vector<std::shared_ptr<RTScene>> scenes;
@@ -3,14 +3,20 @@
 
 #include "utility.h"
 #include "pipeline.h"
+#include "pipelineRegistry.h"
 #include "texture.h"
 #include "descriptorSets.h"
 #include "commandBuffer.h"
 #include "sampler.h"
 #include "string"
+#include <span>
+#include <ranges>
 #include "camera.h"
 #include "raytracing.h"
 #include "frameBuffer.h"
+#include "uploadBatch.h"
+#include "textureLoader.h"
+#include "lightCulling.h"
 
 #include "imgui.h"
 #include "ImGuizmo.h"
@@ -59,7 +65,15 @@ struct TagFromEntityType<EntityType::Primitive> { using type = PrimitiveTag; };
 template<>
 struct TagFromEntityType<EntityType::Light> { using type = LightingTag; };
 
+// Models own GPU resources and large CPU-side mesh data, so they are moved rather than copied.
 struct Model {
+	Model() = default;
+	Model(const Model&) = delete;
+	Model& operator=(const Model&) = delete;
+	Model(Model&&) = default;
+	Model& operator=(Model&&) = default;
+
+	Engine::Graphics::PipelineKey pipelineKey;
 	Engine::Graphics::Pipeline pipeline;
 	Engine::Graphics::Texture texture;
 	Engine::Graphics::DescriptorSets descriptor;
@@ -73,7 +87,8 @@ struct Model {
 	EntityType type;
 	PrimitiveType primitiveType = PrimitiveType::Cube;
 	std::unordered_map<PBRTextureType, std::string> texturePaths;
-	std::unordered_map<int, VkDescriptorSet> textureIDs;
+	std::vector<PBRTextureType> textureSlots;
+	Engine::Utility::FlatHashMap<int, VkDescriptorSet> textureIDs;
 	bool showGizmo = false;
 	bool hasTexture = true;
 };
@@ -129,25 +144,32 @@ namespace Engine::Core {
 			scene.fragmentShader = fragmentShaderPath;
 
 			Model m{};
-			m.pipeline.createGraphicsPipeline<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, false);
+			Engine::Graphics::UploadBatch batch(device, commandbuffer);
+			m.pipelineKey = pipelineRegistry.acquire<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, false);
+			m.pipeline = pipelineRegistry.get(m.pipelineKey);
 			
+			Engine::Graphics::TextureLoadJob textures(batch);
+			textures.add(texturePath, flipTexture);
+
 			if (!modelPath.empty())
 				m.texture.loadModel(modelPath);
 
-			m.texture.createTextureImage(texturePath, device, commandbuffer, framebuffer, sampler, flipTexture, false, false, true);
+			m.texture.createTextureImage(textures.get(0), device, batch, framebuffer, false, false, true);
 			m.type = EntityType::Object;
 			m.matrix = glm::mat4(1.0f);
-			m.texture.createVertexBuffer(device, commandbuffer, framebuffer);
-			m.texture.createIndexBuffer(device, commandbuffer, framebuffer);
-			m.texture.createUniformBuffers(device, framebuffer);
+			m.texture.createVertexBuffer(device, batch, framebuffer);
+			m.texture.createIndexBuffer(device, batch, framebuffer);
 			m.indexCount = static_cast<uint32_t>(m.texture.getIndices().size());
 
+			batch.flush();
+
 			m.descriptor.createDescriptorPool(device.getDevice());
-			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, renderpass.getDescriptorSetLayout(), false);
+			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, sceneUniformResources, renderpass.getDescriptorSetLayout());
 
-			scene.model = m;
+			scene.model = std::move(m);
 
-			scenes.push_back(scene);
+			scenes.push_back(std::move(scene));
+			drawOrderDirty = true;
 		}
 
 		template<typename VertexType>
@@ -157,51 +179,38 @@ namespace Engine::Core {
 			scene.fragmentShader = fragmentShaderPath;
 
 			Model m{};
+			Engine::Graphics::UploadBatch batch(device, commandbuffer);
 			m.texturePaths = texturePaths;
-			m.pipeline.createGraphicsPipeline<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, false);
+			m.pipelineKey = pipelineRegistry.acquire<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, false);
+			m.pipeline = pipelineRegistry.get(m.pipelineKey);
 			
-			if (texturePaths.contains(PBRTextureType::Albedo)) {
-				m.texture.createTextureImage(texturePaths.at(PBRTextureType::Albedo), device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-			}
-
-			if (texturePaths.contains(PBRTextureType::Normal)) {
-				m.texture.createTextureImage(texturePaths.at(PBRTextureType::Normal), device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-			}
-
-			if (texturePaths.contains(PBRTextureType::Roughness)) {
-				m.texture.createTextureImage(texturePaths.at(PBRTextureType::Roughness), device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-			}
-
-			if (texturePaths.contains(PBRTextureType::Metalness)) {
-				m.texture.createTextureImage(texturePaths.at(PBRTextureType::Metalness), device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-			}
-			
-			if (texturePaths.contains(PBRTextureType::AmbientOcclusion)) {
-				m.texture.createTextureImage(texturePaths.at(PBRTextureType::AmbientOcclusion), device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-			}
-
-			if (texturePaths.contains(PBRTextureType::Specular)) {
-				m.texture.createTextureImage(texturePaths.at(PBRTextureType::Specular), device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-			}
+			// decode every map in parallel while the model loads; upload order fixes descriptor order
+			Engine::Graphics::TextureLoadJob textures(batch);
+			queuePBRTextures(textures, m, texturePaths, flipTexture);
 
 			if (!modelPath.empty()) {
 				m.texture.loadModel(modelPath);
 			}
 
+			for (size_t i = 0; i < textures.size(); i++)
+				m.texture.createTextureImage(textures.get(i), device, batch, framebuffer, true, false, true);
+
 			m.type = EntityType::PBRObject;
 
-			m.texture.createVertexBuffer(device, commandbuffer, framebuffer);
-			m.texture.createIndexBuffer(device, commandbuffer, framebuffer);
-			m.texture.createUniformBuffers(device, framebuffer);
+			m.texture.createVertexBuffer(device, batch, framebuffer);
+			m.texture.createIndexBuffer(device, batch, framebuffer);
 			m.indexCount = static_cast<uint32_t>(m.texture.getIndices().size());
 			m.matrix = glm::mat4(1.0f);
 
+			batch.flush();
+
 			m.descriptor.createDescriptorPool(device.getDevice());
-			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, renderpass.getDescriptorSetLayout(), false, texturePaths);
+			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, sceneUniformResources, renderpass.getDescriptorSetLayout(), true, m.textureSlots);
 
-			scene.model = m;
+			scene.model = std::move(m);
 
-			scenes.push_back(scene);
+			scenes.push_back(std::move(scene));
+			drawOrderDirty = true;
 		}
 
 		template<typename VertexType>
@@ -211,26 +220,28 @@ namespace Engine::Core {
 			scene.fragmentShader = fragmentShaderPath;
 
 			Model m{};
-			m.pipeline.createGraphicsPipeline<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, true);
+			Engine::Graphics::UploadBatch batch(device, commandbuffer);
+			m.pipelineKey = pipelineRegistry.acquire<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, true);
+			m.pipeline = pipelineRegistry.get(m.pipelineKey);
 
-			if (m.texture.skyboxUniformResources.empty()) {
-				m.texture.createCubemap(skyboxPaths, device, commandbuffer, framebuffer, sampler, false);
-			}
+			m.texture.createCubemap(skyboxPaths, device, batch, framebuffer, false);
 
 			m.texture.createSkybox();
-			m.texture.createCubeVertexBuffer(device, commandbuffer, framebuffer);
-			m.texture.createCubeIndexBuffer(device, commandbuffer, framebuffer);
+			m.texture.createCubeVertexBuffer(device, batch, framebuffer);
+			m.texture.createCubeIndexBuffer(device, batch, framebuffer);
 			m.matrix = glm::mat4(1.0f);
 			m.indexCount = static_cast<uint32_t>(m.texture.getCubeIndices().size());
-			m.texture.createSkyboxUniformBuffers(device, framebuffer);
 			m.type = EntityType::Skybox;
 
+			batch.flush();
+
 			m.descriptor.createDescriptorPool(device.getDevice());
-			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, renderpass.getDescriptorSetLayout(), true);
+			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, sceneUniformResources, renderpass.getDescriptorSetLayout());
 
-			scene.model = m;
+			scene.model = std::move(m);
 
-			scenes.insert(scenes.begin(), scene);
+			scenes.insert(scenes.begin(), std::move(scene));
+			drawOrderDirty = true;
 		}
 
 		template<typename VertexType>
@@ -240,7 +251,9 @@ namespace Engine::Core {
 			scene.fragmentShader = fragmentShaderPath;
 
 			Model m{};
-			m.pipeline.createGraphicsPipeline<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, false);			
+			Engine::Graphics::UploadBatch batch(device, commandbuffer);
+			m.pipelineKey = pipelineRegistry.acquire<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, false);
+			m.pipeline = pipelineRegistry.get(m.pipelineKey);
 			
 			if (!modelPath.empty()) {
 				m.texture.loadModel(modelPath, materialPath);
@@ -249,59 +262,53 @@ namespace Engine::Core {
 			std::string baseDir = std::filesystem::path(materialPath).parent_path().string();
 			std::unordered_map<PBRTextureType, std::string> paths;
 
+			Engine::Graphics::TextureLoadJob textures(batch);
+
 			for (auto& mat : m.texture.getMaterials()) {
-				if (!mat.diffusePath.empty()) {
-					std::string path = baseDir + "/" + mat.diffusePath;
-					m.texture.createTextureImage(path, device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-					paths.insert({ PBRTextureType::Albedo, path });
+				const std::pair<PBRTextureType, const std::string*> maps[] = {
+					{ PBRTextureType::Albedo, &mat.diffusePath },
+					{ PBRTextureType::Normal, &mat.normalPath },
+					{ PBRTextureType::Roughness, &mat.roughnessPath },
+					{ PBRTextureType::Metalness, &mat.metalnessPath },
+					{ PBRTextureType::AmbientOcclusion, &mat.aoPath },
+					{ PBRTextureType::Specular, &mat.specularPath },
+				};
+
+				std::unordered_map<PBRTextureType, std::string> materialPaths;
+				for (const auto& [type, file] : maps) {
+					if (!file->empty())
+						materialPaths.insert({ type, baseDir + "/" + *file });
 				}
 
-				if (!mat.normalPath.empty()) {
-					std::string path = baseDir + "/" + mat.normalPath;
-					m.texture.createTextureImage(path, device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-					paths.insert({ PBRTextureType::Normal, path });
-				}
+				queuePBRTextures(textures, m, materialPaths, flipTexture);
 
-				if (!mat.roughnessPath.empty()) {
-					std::string path = baseDir + "/" + mat.roughnessPath;
-					m.texture.createTextureImage(path, device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-					paths.insert({ PBRTextureType::Roughness, path });
-				}
+				paths.insert(materialPaths.begin(), materialPaths.end());
+			}
 
-				if (!mat.metalnessPath.empty()) {
-					std::string path = baseDir + "/" + mat.metalnessPath;
-					m.texture.createTextureImage(path, device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-					paths.insert({ PBRTextureType::Metalness, path });
-				}
+			// a model without materials still needs every slot bound
+			if (m.textureSlots.empty())
+				queuePBRTextures(textures, m, {}, flipTexture);
 
-				if (!mat.aoPath.empty()) {
-					std::string path = baseDir + "/" + mat.aoPath;
-					m.texture.createTextureImage(path, device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-					paths.insert({ PBRTextureType::AmbientOcclusion, path });
-				}
-
-				if (!mat.specularPath.empty()) {
-					std::string path = baseDir + "/" + mat.specularPath;
-					m.texture.createTextureImage(path, device, commandbuffer, framebuffer, sampler, flipTexture, true, false, true);
-					paths.insert({ PBRTextureType::Specular, path });
-				}
-			}
+			for (size_t i = 0; i < textures.size(); i++)
+				m.texture.createTextureImage(textures.get(i), device, batch, framebuffer, true, false, true);
 
 			m.type = EntityType::MatObject;
 			m.texturePaths = paths;
 
-			m.texture.createVertexBuffer(device, commandbuffer, framebuffer);
-			m.texture.createIndexBuffer(device, commandbuffer, framebuffer);
-			m.texture.createUniformBuffers(device, framebuffer);
+			m.texture.createVertexBuffer(device, batch, framebuffer);
+			m.texture.createIndexBuffer(device, batch, framebuffer);
 			m.indexCount = static_cast<uint32_t>(m.texture.getIndices().size());
 			m.matrix = glm::mat4(1.0f);
 
+			batch.flush();
+
 			m.descriptor.createDescriptorPool(device.getDevice());
-			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, renderpass.getDescriptorSetLayout(), false, paths);
+			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, sceneUniformResources, renderpass.getDescriptorSetLayout(), true, m.textureSlots);
 		
-			scene.model = m;
+			scene.model = std::move(m);
 
-			scenes.push_back(scene);
+			scenes.push_back(std::move(scene));
+			drawOrderDirty = true;
 		}
 
 		template<typename VertexType>
@@ -311,8 +318,10 @@ namespace Engine::Core {
 			scene.fragmentShader = fragmentShaderPath;
 
 			Model m{};
+			Engine::Graphics::UploadBatch batch(device, commandbuffer);
 			m.primitiveType = primitiveType;
-			m.pipeline.createGraphicsPipeline<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, true);
+			m.pipelineKey = pipelineRegistry.acquire<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, true);
+			m.pipeline = pipelineRegistry.get(m.pipelineKey);
 			m.hasTexture = false;
 
 			if (primitiveType == PrimitiveType::Cube) {
@@ -328,18 +337,20 @@ namespace Engine::Core {
 				m.matrix = glm::mat4(1.0f);
 			}
 
-			m.texture.createVertexBuffer(device, commandbuffer, framebuffer);
-			m.texture.createIndexBuffer(device, commandbuffer, framebuffer);
+			m.texture.createVertexBuffer(device, batch, framebuffer);
+			m.texture.createIndexBuffer(device, batch, framebuffer);
 			m.indexCount = static_cast<uint32_t>(m.texture.getIndices().size());
-			m.texture.createUniformBuffers(device, framebuffer);
 			m.type = EntityType::Primitive;
 			
+			batch.flush();
+
 			m.descriptor.createDescriptorPool(device.getDevice());
-			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, renderpass.getDescriptorSetLayout(), false, {}, false);
+			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, sceneUniformResources, renderpass.getDescriptorSetLayout(), false);
 			
-			scene.model = m;
+			scene.model = std::move(m);
 
-			scenes.push_back(scene);
+			scenes.push_back(std::move(scene));
+			drawOrderDirty = true;
 		}
 
 		template<typename VertexType>
@@ -349,7 +360,9 @@ namespace Engine::Core {
 			scene.fragmentShader = fragmentShaderPath;
 
 			Model m{};
-			m.pipeline.createGraphicsPipeline<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, true);
+			Engine::Graphics::UploadBatch batch(device, commandbuffer);
+			m.pipelineKey = pipelineRegistry.acquire<VertexType>(scene.vertexShader, scene.fragmentShader, device.getDevice(), sampler.getSamples(), renderpass, true);
+			m.pipeline = pipelineRegistry.get(m.pipelineKey);
 
 			//change this to user object
 			m.texture.createCube();
@@ -357,22 +370,33 @@ namespace Engine::Core {
 			m.type = EntityType::Light;
 			m.hasTexture = false;
 
-			m.texture.createVertexBuffer(device, commandbuffer, framebuffer);
-			m.texture.createIndexBuffer(device, commandbuffer, framebuffer);
+			m.texture.createVertexBuffer(device, batch, framebuffer);
+			m.texture.createIndexBuffer(device, batch, framebuffer);
 			m.indexCount = static_cast<uint32_t>(m.texture.getIndices().size());
-			m.texture.createUniformBuffers(device, framebuffer);
+
+			batch.flush();
 
 			m.descriptor.createDescriptorPool(device.getDevice());
-			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, renderpass.getDescriptorSetLayout(), false, {}, false);
+			m.descriptor.createDescriptorSets(device.getDevice(), m.texture, sceneUniformResources, renderpass.getDescriptorSetLayout(), false);
 
-			scene.model = m;
+			scene.model = std::move(m);
 
-			scenes.push_back(scene);
+			scenes.push_back(std::move(scene));
+			drawOrderDirty = true;
 		}
 
-		void removeEntity(const Scene &scene, int index);
+		void createSceneBuffers();
+		void updateSceneBuffer(uint32_t currentFrame, VkExtent2D extent);
+		void recordLightCulling(VkCommandBuffer commandBuffer, uint32_t currentFrame) const;
+		void destroySceneBuffers();
+		VkDescriptorSet getLightDescriptorSet(uint32_t currentFrame) const { return lightCulling.getDescriptorSet(currentFrame); }
+
+		void removeEntity(int index);
 		void updateScene();
-		void cleanup(Scene scene) const;
+		void cleanup(Scene& scene);
+		void prewarmPipelines();
+		void updatePipelines();
+		void destroyPipelines();
 
 		static const char* entityString(EntityType type);
 
@@ -385,10 +409,23 @@ namespace Engine::Core {
 
 		static bool checkExtension(const std::string &path, const std::string &ext);
 
-		std::vector<Scene> getScenes() const { return scenes; }
+		std::span<Scene> getScenes() { return scenes; }
+		std::span<const Scene> getScenes() const { return scenes; }
+		std::span<const uint32_t> getDrawOrder();
+		VkPipelineLayout getPipelineLayout() const { return pipelineRegistry.getPipelineLayout(); }
+
+		auto getScenesOfType(EntityType type) const {
+			return scenes | std::views::filter([type](const Scene& scene) { return scene.model.type == type; });
+		}
 
 	private:
 		std::vector<Scene> scenes;
+		std::vector<uint32_t> drawOrder;
+		bool drawOrderDirty = true;
+		Engine::Graphics::PipelineRegistry pipelineRegistry;
+		std::vector<BufferResource*> sceneUniformResources;
+		std::vector<Engine::Graphics::LightBuffer> sceneLights;
+		Engine::Graphics::LightCulling lightCulling;
 		Engine::Graphics::Device& device;
 		Engine::Graphics::RenderPass& renderpass;
 		Engine::Graphics::Sampler& sampler;
@@ -398,6 +435,10 @@ namespace Engine::Core {
 		Engine::Core::Camera& camera;
 		Engine::Graphics::Raytracing& raytrace;
 		std::vector<const char*> shaderPaths;
+
+		// queues the textures of PBR_UPLOAD_ORDER built from a set of source maps, with a 1x1
+		// default for each slot the maps leave empty, and records what each one is in m.textureSlots
+		void queuePBRTextures(Engine::Graphics::TextureLoadJob& textures, Model& m, const std::unordered_map<PBRTextureType, std::string>& paths, bool flipTexture);
 	};
 }
 
@@ -39,6 +39,17 @@ void Engine::Core::Application::initWindow()
 
 void Engine::Core::Application::initVulkan()
 {
+	double startupBegin = glfwGetTime();
+
+	threadPool = std::make_unique<Engine::Utility::ThreadPool>();
+
+	// assets are looked up in the pack first, so it is opened before anything loads
+	assetPack = std::make_unique<Engine::Utility::AssetPack>();
+	if (assetPack->open(Engine::Utility::AssetPack::DEFAULT_PATH))
+		g_console.add("[Asset Pack] %s: %zu files\n", Engine::Utility::AssetPack::DEFAULT_PATH, assetPack->size());
+	else
+		assetPack.reset();
+
 	instance.createInstance();
 	instance.setupDebugMessenger();
 	instance.createSurface(window);
@@ -46,7 +57,14 @@ void Engine::Core::Application::initVulkan()
 	sampler.setSamples(device.getPhysicalDevice());
 	device.createLogicalDevice(instance.getSurface());
 
-	resources = std::make_unique<ResourceManager>(device.getDevice());
+	resources = std::make_unique<ResourceManager>(instance.getInstance(), device.getPhysicalDevice(), device.getDevice());
+	stagingRing = std::make_unique<Engine::Graphics::StagingRing>();
+	stagingRing->create(device);
+	textureCache = std::make_unique<Engine::Graphics::TextureCache>();
+	pipelineCache = std::make_unique<Engine::Graphics::PipelineCache>();
+	pipelineCache->create(device);
+	mipGenerator = std::make_unique<Engine::Graphics::MipGenerator>();
+	mipGenerator->create(device, "shaders/");
 
 	fpCreateAccelerationStructureKHR = reinterpret_cast<PFN_vkCreateAccelerationStructureKHR>(vkGetDeviceProcAddr(device.getDevice(), "vkCreateAccelerationStructureKHR"));
 	fpDestroyAccelerationStructureKHR = reinterpret_cast<PFN_vkDestroyAccelerationStructureKHR>(vkGetDeviceProcAddr(device.getDevice(), "vkDestroyAccelerationStructureKHR"));
@@ -111,6 +129,9 @@ void Engine::Core::Application::initVulkan()
 		{ PBRTextureType::Specular, "textures/backpack/specular.jpg" },
 	};
 
+	scenemanager.createSceneBuffers();
+	scenemanager.prewarmPipelines();
+
 	scenemanager.addEntity<CubeVertex, EntityType::Skybox>("shaders/skyboxVert.vert.spv", "shaders/skyboxFrag.frag.spv", skyboxPaths, "", true);
 	//scenemanager.addEntity<Vertex, EntityType::Object>("shaders/vert.spv", "shaders/frag.spv", "textures/viking_room/viking_room.png", "textures/viking_room/viking_room.obj", false);
 	//scenemanager.addEntity<Vertex, EntityType::PBRObject>("shaders/textureMapVert.spv", "shaders/textureMapFrag.spv", pbrTextures, "textures/backpack/backpack.obj", false);
@@ -124,6 +145,9 @@ void Engine::Core::Application::initVulkan()
 	raytrace.createDescriptorSets(device, skyboxTexture);
 
 	texture.createSyncObjects(device.getDevice());
+
+	double startupTime = (glfwGetTime() - startupBegin) * 1000.0;
+	g_console.add("[Startup] initVulkan took %.1f ms with a %s pipeline cache\n", startupTime, pipelineCache->isWarm() ? "warm" : "cold");
 }
 
 void Engine::Core::Application::initImGui()
@@ -262,8 +286,13 @@ void Engine::Core::Application::mainLoop()
 					recreateSwapchainFlag = !recreateSwapchainFlag;
 				}
 
+				ImGui::SliderInt("Frames In Flight", &requestedFramesInFlight, 1, Engine::Settings::MAX_FRAMES_IN_FLIGHT);
+
 				ImGui::Checkbox("Enable Raytracing", &useRaytracer);
 
+				if (ImGui::Button("Benchmark Mipmaps"))
+					mipGenerator->benchmark(device, commandbuffer);
+
 				ImGui::EndTabItem();
 			}
 
@@ -403,7 +432,24 @@ void Engine::Core::Application::cleanup()
 	resources->log();
 
 	vkDeviceWaitIdle(device.getDevice());
+
+	scenemanager.destroySceneBuffers();
+
+	if (stagingRing) {
+		stagingRing->destroy();
+		stagingRing.reset();
+	}
 	
+	if (textureCache) {
+		textureCache->clear();
+		textureCache.reset();
+	}
+
+	if (mipGenerator) {
+		mipGenerator->destroy();
+		mipGenerator.reset();
+	}
+
 	if (resources) {
 		resources->cleanup();
 
@@ -425,16 +471,23 @@ void Engine::Core::Application::cleanup()
 
 	swapchain.cleanupSwapChain(device, framebuffer);
 
-	for (auto& scene : scenemanager.getScenes()) {
-		auto& p = scene.model.pipeline;
+	scenemanager.destroyPipelines();
 
-		vkDestroyPipeline(device.getDevice(), p.getGraphicsPipeline(), nullptr);
-		vkDestroyPipelineLayout(device.getDevice(), p.getPipelineLayout(), nullptr);
+	if (pipelineCache) {
+		pipelineCache->save();
+		pipelineCache->destroy();
+		pipelineCache.reset();
 	}
 
+	// queued cooks use the pool themselves, so they finish before it goes away
+	Engine::Graphics::TextureDataCache::finish();
+	threadPool.reset();
+	assetPack.reset();
+
 	vkDestroyRenderPass(device.getDevice(), renderpass.getRenderPass(), nullptr);
 	vkDestroyDescriptorPool(device.getDevice(), imguiPool, nullptr);
 	vkDestroyDescriptorSetLayout(device.getDevice(), renderpass.getDescriptorSetLayout(), nullptr);
+	vkDestroyDescriptorSetLayout(device.getDevice(), renderpass.getLightDescriptorSetLayout(), nullptr);
 	
 	for (size_t i = 0; i < Engine::Settings::MAX_FRAMES_IN_FLIGHT; i++) {
 		vkDestroySemaphore(device.getDevice(), texture.getRenderFinishedSemaphores()[i], nullptr);
@@ -446,6 +499,8 @@ void Engine::Core::Application::cleanup()
 
 	vkDeviceWaitIdle(device.getDevice());
 
+	resources->destroyAllocator();
+
 	vkDestroyDevice(device.getDevice(), nullptr);
 
 	instance.DestroyDebugUtilsMessengerEXT(instance.getInstance(), instance.getDebugMessenger(), nullptr);
@@ -528,7 +583,8 @@ void Engine::Core::Application::mouse_callback(GLFWwindow* window, double xposIn
 
 void Engine::Core::Application::drawFrame()
 {
-	vkDeviceWaitIdle(device.getDevice());
+	applyFramesInFlight();
+	scenemanager.updatePipelines();
 
 	if (recreateSwapchainFlag) {
 		swapchain.presentImmediate = !swapchain.presentImmediate;
@@ -543,6 +599,8 @@ void Engine::Core::Application::drawFrame()
 		std::cerr << "failed to wait for fence: " << fenceStatus << std::endl;
 	}
 
+	resources->collect(submittedFrames[currentFrame]);
+
 	uint32_t imageIndex;
 	VkResult result = vkAcquireNextImageKHR(device.getDevice(), swapchain.resource->swapchain, UINT64_MAX, texture.getImageAvailableSemaphores()[currentFrame], VK_NULL_HANDLE, &imageIndex);
 
@@ -553,33 +611,12 @@ void Engine::Core::Application::drawFrame()
 	else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
 		throw std::runtime_error("failed to acquire swap chain image");
 
-	glm::vec3 lightPos = glm::vec3(0.0f);
-	glm::vec3 lightColor = glm::vec3(0.7f);
-
-	std::vector<Engine::Graphics::LightBuffer> lights;
-
-	for (auto& scene : scenemanager.getScenes()) {
-		auto& m = scene.model;
-		Engine::Graphics::LightBuffer light;
+	if (imagesInFlight[imageIndex] != VK_NULL_HANDLE)
+		vkWaitForFences(device.getDevice(), 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+	imagesInFlight[imageIndex] = texture.getInFlightFences()[currentFrame];
 
-		if (m.type == EntityType::Light) {
-			light.pos = glm::vec3(m.matrix[3]);
-			light.color = m.color;
+	scenemanager.updateSceneBuffer(currentFrame, swapchain.resource->extent);
 
-			lights.push_back(light);
-		}
-	}
-
-	for (auto& scene : scenemanager.getScenes()) {
-		auto& m = scene.model;
-		if (m.type == EntityType::Skybox) {
-			m.texture.updateSkyboxUniformBuffer(currentFrame, camera, swapchain.resource->extent);
-		}
-		else {
-			m.texture.updateUniformBuffer(currentFrame, camera, swapchain.resource->extent, m.matrix, m.color, lights);
-		}
-	}
-	
 	VkResult fencesReset = vkResetFences(device.getDevice(), 1, &texture.getInFlightFences()[currentFrame]);
 	if (fencesReset != VK_SUCCESS) {
 		throw std::runtime_error("failed to reset fences");
@@ -618,6 +655,8 @@ void Engine::Core::Application::drawFrame()
 		throw std::runtime_error("failed to submit draw command buffer");
 	}
 
+	submittedFrames[currentFrame] = resources->submitFrame();
+
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 	presentInfo.waitSemaphoreCount = 1;
@@ -639,12 +678,12 @@ void Engine::Core::Application::drawFrame()
 		throw std::runtime_error("failed to present swap chain image");
 	}
 
-	currentFrame = (currentFrame + 1) % Engine::Settings::MAX_FRAMES_IN_FLIGHT;
+	currentFrame = (currentFrame + 1) % framesInFlight;
 }
 
 void Engine::Core::Application::raytraceFrame()
 {
-	vkDeviceWaitIdle(device.getDevice());
+	applyFramesInFlight();
 
 	if (raytrace.sceneUpdated) {
 		raytrace.recreateScene(device, framebuffer, commandbuffer, swapchain, rtscenemanager, skyboxTexture);
@@ -669,13 +708,13 @@ void Engine::Core::Application::raytraceFrame()
 	raytrace.uboData.view = camera.GetViewMatrix();
 	raytrace.uboData.proj = camera.GetProjectionMatrix();
 
-	raytrace.updateUBO(device);
-
 	VkResult fenceStatus = vkWaitForFences(device.getDevice(), 1, &texture.getInFlightFences()[currentFrame], VK_TRUE, UINT64_MAX);
 	if (fenceStatus != VK_SUCCESS) {
 		std::cerr << "failed to wait for fence: " << fenceStatus << std::endl;
 	}
 
+	resources->collect(submittedFrames[currentFrame]);
+
 	uint32_t imageIndex;
 	VkResult result = vkAcquireNextImageKHR(device.getDevice(), swapchain.resource->swapchain, UINT64_MAX, texture.getImageAvailableSemaphores()[currentFrame], VK_NULL_HANDLE, &imageIndex);
 
@@ -687,6 +726,12 @@ void Engine::Core::Application::raytraceFrame()
 		throw std::runtime_error("failed to acquire swap chain image");
 	}
 
+	if (imagesInFlight[imageIndex] != VK_NULL_HANDLE)
+		vkWaitForFences(device.getDevice(), 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+	imagesInFlight[imageIndex] = texture.getInFlightFences()[currentFrame];
+
+	raytrace.updateUBO(device, currentFrame);
+
 	VkResult fencesReset = vkResetFences(device.getDevice(), 1, &texture.getInFlightFences()[currentFrame]);
 
 	if (fencesReset != VK_SUCCESS) {
@@ -703,7 +748,8 @@ void Engine::Core::Application::raytraceFrame()
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
-	raytrace.traceRays(device.getDevice(), commandBuffer, swapchain.resource, imageIndex);
+	raytrace.updateTopLevelAccelerationStructure(device, commandBuffer, currentFrame);
+	raytrace.traceRays(device.getDevice(), commandBuffer, swapchain.resource, imageIndex, currentFrame);
 
 	VkImageMemoryBarrier imguiBarrier{};
 	imguiBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -778,6 +824,8 @@ void Engine::Core::Application::raytraceFrame()
 		throw std::runtime_error("failed to submit ray tracing command buffer");
 	}
 
+	submittedFrames[currentFrame] = resources->submitFrame();
+
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 	presentInfo.waitSemaphoreCount = 1;
@@ -798,7 +846,7 @@ void Engine::Core::Application::raytraceFrame()
 		throw std::runtime_error("failed to present swap chain image");
 	}
 
-	currentFrame = (currentFrame + 1) % Engine::Settings::MAX_FRAMES_IN_FLIGHT;
+	currentFrame = (currentFrame + 1) % framesInFlight;
 }
 
 void Engine::Core::Application::recreateSwapchain()
@@ -841,6 +889,24 @@ void Engine::Core::Application::recreateSwapchain()
 
 	createImGuiRenderPass();
 	createImGuiFramebuffers();
+
+	imagesInFlight.assign(swapchain.resource->images.size(), VK_NULL_HANDLE);
+}
+
+void Engine::Core::Application::applyFramesInFlight()
+{
+	if (requestedFramesInFlight == framesInFlight && !imagesInFlight.empty())
+		return;
+
+	// frame slots above the new depth stop being waited on, so drain them before switching
+	vkWaitForFences(device.getDevice(), Engine::Settings::MAX_FRAMES_IN_FLIGHT, texture.getInFlightFences().data(), VK_TRUE, UINT64_MAX);
+
+	framesInFlight = std::clamp(requestedFramesInFlight, 1, Engine::Settings::MAX_FRAMES_IN_FLIGHT);
+	requestedFramesInFlight = framesInFlight;
+	currentFrame = 0;
+
+	imagesInFlight.assign(swapchain.resource->images.size(), VK_NULL_HANDLE);
+	g_console.add("[Renderer] frames in flight: %d\n", framesInFlight);
 }
 
 void Engine::Core::Application::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
@@ -851,6 +917,8 @@ void Engine::Core::Application::recordCommandBuffer(VkCommandBuffer commandBuffe
 		throw std::runtime_error("failed to begin recording command buffer!");
 	}
 
+	scenemanager.recordLightCulling(commandBuffer, currentFrame);
+
 	VkRenderPassBeginInfo renderPassInfo{};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 	renderPassInfo.renderPass = renderpass.getRenderPass();
@@ -881,19 +949,43 @@ void Engine::Core::Application::recordCommandBuffer(VkCommandBuffer commandBuffe
 	scissor.extent = swapchain.resource->extent;
 	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-	for (auto& scene : scenemanager.getScenes()) {
-		auto& m = scene.model;
-		auto& p = scene.model.pipeline;
+	auto scenes = scenemanager.getScenes();
+	auto drawOrder = scenemanager.getDrawOrder();
+	VkPipelineLayout pipelineLayout = scenemanager.getPipelineLayout();
+
+	if (!drawOrder.empty()) {
+		VkDescriptorSet lightSet = scenemanager.getLightDescriptorSet(currentFrame);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &lightSet, 0, nullptr);
+	}
 
-		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, p.getGraphicsPipeline());
+	VkPipeline boundPipeline = VK_NULL_HANDLE;
+	VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
 
-		VkBuffer vertexBuffers[] = { m.texture.vertexResource->buffer };
-		VkDeviceSize offsets[] = { 0 };
+	for (uint32_t index : drawOrder) {
+		auto& m = scenes[index].model;
+
+		if (m.pipeline.getGraphicsPipeline() != boundPipeline) {
+			boundPipeline = m.pipeline.getGraphicsPipeline();
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, boundPipeline);
+		}
+
+		if (m.texture.vertexResource->buffer != boundVertexBuffer) {
+			boundVertexBuffer = m.texture.vertexResource->buffer;
+
+			VkBuffer vertexBuffers[] = { boundVertexBuffer };
+			VkDeviceSize offsets[] = { 0 };
+
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+			vkCmdBindIndexBuffer(commandBuffer, m.texture.indexResource->buffer, 0, VK_INDEX_TYPE_UINT32);
+		}
 
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-		vkCmdBindIndexBuffer(commandBuffer, m.texture.indexResource->buffer, 0, VK_INDEX_TYPE_UINT32);
+		VkDescriptorSet objectSet = m.descriptor.getDescriptorSets()[currentFrame];
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &objectSet, 0, nullptr);
 
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, p.getPipelineLayout(), 0, 1, &m.descriptor.getDescriptorSets()[currentFrame], 0, nullptr);
+		Engine::Graphics::ObjectPushConstants push{};
+		push.model = m.matrix;
+		push.color = m.color;
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(push), &push);
 
 		vkCmdDrawIndexed(commandBuffer, m.indexCount, 1, 0, 0, 0);
 	}
@@ -8,6 +8,8 @@
 #include "camera.h"
 #include "texture.h"
 #include "raytracing.h"
+#include "uploadBatch.h"
+#include "textureLoader.h"
 
 void Engine::Core::RT::SceneManager::add(const std::string& texturePath, bool flipTexture) {
     std::filesystem::path path = texturePath;
@@ -50,66 +52,95 @@ void Engine::Core::RT::SceneManager::add(const std::string& texturePath, bool fl
 
     g_console.add("[Scene Manager] found %zu textures\n", texturePaths.size());
 
+    // roughness, metalness and ambient occlusion have no image of their own; they are packed
+    // into the ORM texture at the channel given
+    struct TextureSlot {
+        const char* keyword;
+        const char* altKeyword;
+        std::optional<ImageResource*>* image;
+        std::string* path;
+        uint32_t flag;
+        VkFormat format;
+        int ormChannel;
+    };
+
+    const TextureSlot slots[] = {
+        { "albedo", "diffuse", &scene->obj.albedo, &scene->obj.albedoPath, ALBEDO_FLAG, pbrTextureFormat(PBRTextureType::Albedo), -1 },
+        { "normal", nullptr, &scene->obj.normal, &scene->obj.normalPath, NORMAL_FLAG, pbrTextureFormat(PBRTextureType::Normal), -1 },
+        { "roughness", nullptr, nullptr, &scene->obj.roughnessPath, ROUGHNESS_FLAG, VK_FORMAT_UNDEFINED, 1 },
+        { "metalness", nullptr, nullptr, &scene->obj.metalnessPath, METALNESS_FLAG, VK_FORMAT_UNDEFINED, 2 },
+        { "specular", nullptr, &scene->obj.specular, &scene->obj.specularPath, SPECULAR_FLAG, pbrTextureFormat(PBRTextureType::Specular), -1 },
+        { "height", nullptr, &scene->obj.height, &scene->obj.heightPath, HEIGHT_FLAG, VK_FORMAT_R8_UNORM, -1 },
+        { "ambient_occlusion", nullptr, nullptr, &scene->obj.ambientOcclusionPath, AMBIENT_OCCLUSION_FLAG, VK_FORMAT_UNDEFINED, 0 },
+    };
+
+    // decode every matched map on the pool, then upload them through one batch
+    Engine::Graphics::UploadBatch batch(device, commandbuffer);
+    Engine::Graphics::TextureLoadJob textures(batch);
+    std::vector<std::pair<const TextureSlot*, std::string>> matched;
+    std::vector<std::pair<const TextureSlot*, std::string>> packed;
+    std::array<std::string, 3> ormSources;
+
     for(auto& file : texturePaths) {
         g_console.add("[Scene Manager] attempting to load %s \n", file.c_str());
 
-        if(file.find("albedo") != std::string::npos || file.find("diffuse") != std::string::npos) {
-            scene->obj.albedo = texture.createImageResource(file, device, commandbuffer, framebuffer, sampler, flipTexture, false, false, true);
-            scene->obj.albedoPath = file.c_str();
-            scene->obj.flags = scene->obj.flags | ALBEDO_FLAG;
-            g_console.add("[Scene Manager] successfully loaded %s \n", file.c_str());
-        }
-        else if(file.find("normal") != std::string::npos) {
-            scene->obj.normal = texture.createImageResource(file, device, commandbuffer, framebuffer, sampler, flipTexture, false, false, true);
-            scene->obj.normalPath = file.c_str();
-            scene->obj.flags = scene->obj.flags | NORMAL_FLAG;
-            g_console.add("[Scene Manager] successfully loaded %s \n", file.c_str());
-        }
-        else if(file.find("roughness") != std::string::npos) {
-            scene->obj.roughness = texture.createImageResource(file, device, commandbuffer, framebuffer, sampler, flipTexture, false, false, true);
-            scene->obj.roughnessPath = file.c_str();
-            scene->obj.flags = scene->obj.flags | ROUGHNESS_FLAG;
-            g_console.add("[Scene Manager] successfully loaded %s \n", file.c_str());
-        }
-        else if(file.find("metalness") != std::string::npos) {
-            scene->obj.metalness = texture.createImageResource(file, device, commandbuffer, framebuffer, sampler, flipTexture, false, false, true);
-            scene->obj.metalnessPath = file.c_str();
-            scene->obj.flags = scene->obj.flags | METALNESS_FLAG;
-            g_console.add("[Scene Manager] successfully loaded %s \n", file.c_str());
-        }
-        else if(file.find("specular") != std::string::npos) {
-            scene->obj.specular = texture.createImageResource(file, device, commandbuffer, framebuffer, sampler, flipTexture, false, false, true);
-            scene->obj.specularPath = file.c_str();
-            scene->obj.flags = scene->obj.flags | SPECULAR_FLAG;
-            g_console.add("[Scene Manager] successfully loaded %s \n", file.c_str());
+        auto slot = std::find_if(std::begin(slots), std::end(slots), [&file](const TextureSlot& slot) {
+            return file.find(slot.keyword) != std::string::npos || (slot.altKeyword && file.find(slot.altKeyword) != std::string::npos);
+        });
+
+        if (slot == std::end(slots)) {
+            g_console.add("Textures found for %s but naming convension not followed (albedo, normal, roughness, metalness, specular, height, ambient_occlusion needed in file name)", texturePath.c_str());
+            continue;
         }
-        else if(file.find("height") != std::string::npos) {
-            scene->obj.height= texture.createImageResource(file, device, commandbuffer, framebuffer, sampler, flipTexture, false, false, true);
-            scene->obj.heightPath = file.c_str();
-            scene->obj.flags = scene->obj.flags | HEIGHT_FLAG;
-            g_console.add("[Scene Manager] successfully loaded %s \n", file.c_str());
+
+        if (slot->ormChannel >= 0) {
+            ormSources[slot->ormChannel] = file;
+            packed.emplace_back(slot, file);
+            continue;
         }
-        else if(file.find("ambient_occlusion") != std::string::npos) {
-            scene->obj.ambientOcclusion = texture.createImageResource(file, device, commandbuffer, framebuffer, sampler, flipTexture, false, false, true);
-            scene->obj.ambientOcclusionPath = file.c_str();
-            scene->obj.flags = scene->obj.flags | AMBIENT_OCCLUSION_FLAG;
+
+        textures.add(file, flipTexture, slot->format);
+        matched.emplace_back(slot, file);
+    }
+
+    std::optional<size_t> orm;
+    if (!packed.empty())
+        orm = textures.addPacked(ormSources, ORM_DEFAULTS, flipTexture);
+
+    for (size_t i = 0; i < matched.size(); i++) {
+        const auto& [slot, file] = matched[i];
+
+        *slot->image = texture.createImageResource(textures.get(i), device, batch, framebuffer, false, false, true);
+        *slot->path = file;
+        scene->obj.flags = scene->obj.flags | slot->flag;
+        g_console.add("[Scene Manager] successfully loaded %s \n", file.c_str());
+    }
+
+    if (orm) {
+        scene->obj.occlusionRoughnessMetalness = texture.createImageResource(textures.get(*orm), device, batch, framebuffer, false, false, true);
+
+        for (const auto& [slot, file] : packed) {
+            *slot->path = file;
+            scene->obj.flags = scene->obj.flags | slot->flag;
             g_console.add("[Scene Manager] successfully loaded %s \n", file.c_str());
         }
-        else {
-            g_console.add("Textures found for %s but naming convension not followed (albedo, normal, roughness, metalness, specular, height, ambient_occlusion needed in file name)", texturePath.c_str());
-        }
     }
 
+    batch.flush();
+
     scenes.push_back(scene);
 }
 
 void Engine::Core::RT::SceneManager::remove(int index)
 {
     if (index >= 0 && index < scenes.size()) {
+        // everything is released through the deferred queue and each frame rebuilds its own
+        // TLAS, so removal does not need the full scene recreation (and its device idle)
+        raytrace.removeModel(scenes[index]);
         scenes[index]->obj.destroy(device.getDevice());
         scenes[index]->obj.textureCleanup();
         scenes.erase(scenes.begin() + index);
-        raytrace.sceneUpdated = true;
+        raytrace.uboData.sampleCount = 1;
     }
 }
 
@@ -124,7 +155,7 @@ void Engine::Core::RT::SceneManager::updateScene(float deltaTime) {
 
     ImGuizmo::SetRect(viewport->Pos.x, viewport->Pos.y, viewport->Size.x, viewport->Size.y);
 
-    for (int i = 0; i < scenes.size(); i++) {
+    for (int i = static_cast<int>(scenes.size()) - 1; i >= 0; i--) {
         if (scenes[i]->markedForDeletion) {
             remove(i);
         }
@@ -196,7 +227,7 @@ void Engine::Core::RT::SceneManager::updateScene(float deltaTime) {
         for (int i = 0; i < scenes.size(); i++) {
             raytrace.models[i]->matrix = scenes[i]->matrix;
         }
-        raytrace.updateTopLevelAccelerationStructure(device, framebuffer, commandbuffer, true);
+        raytrace.instanceVersion++;
         raytrace.uboData.sampleCount = 1;
     }
 }
\ No newline at end of file
@@ -2,9 +2,10 @@
 
 #include <ranges>
 
-void Engine::Core::SceneManager::removeEntity(const Scene &scene, const int index) {
-	cleanup(scene);
+void Engine::Core::SceneManager::removeEntity(const int index) {
+	cleanup(scenes[index]);
 	scenes.erase(scenes.begin() + index);
+	drawOrderDirty = true;
 }
 
 void Engine::Core::SceneManager::updateScene() {
@@ -14,7 +15,7 @@ void Engine::Core::SceneManager::updateScene() {
 
 	ImGuizmo::SetRect(viewport->Pos.x, viewport->Pos.y, viewport->Size.x, viewport->Size.y);
 
-	std::unordered_map<EntityType, int> entityCount = {
+	Engine::Utility::FlatHashMap<EntityType, int> entityCount = {
 		{ EntityType::Object, 0 },
 		{ EntityType::UI, 0 },
 		{ EntityType::Light, 0 },
@@ -32,8 +33,11 @@ void Engine::Core::SceneManager::updateScene() {
 		if (scenes[i].name.empty() && scenes[i].model.type != EntityType::Skybox) {
 			scenes[i].name = static_cast<std::string>(entityString(scenes[i].model.type)) + " " + std::to_string(entityCount[scenes[i].model.type]);
 		}
+	}
+
+	for (int i = static_cast<int>(scenes.size()) - 1; i >= 0; i--) {
 		if (scenes[i].markedForDeletion) {
-			removeEntity(scenes[i], i);
+			removeEntity(i);
 		}
 	}
 
@@ -63,16 +67,14 @@ void Engine::Core::SceneManager::updateScene() {
 				}
 				else {
 					scenes[i].model.textureIDs.reserve(textureCount);
-					int index = 0;
-					for (const auto &key: scenes[i].model.texturePaths | std::views::keys) {
+					for (int index = 0; index < textureCount; index++) {
 						if (!scenes[i].model.textureIDs.contains(index)) {
 							const VkDescriptorSet textureID = ImGui_ImplVulkan_AddTexture(scenes[i].model.texture.textureResources[index]->sampler, scenes[i].model.texture.textureResources[index]->view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 							scenes[i].model.textureIDs[index] = textureID;
 						}
 						ImGui::Image((ImTextureID)scenes[i].model.textureIDs[index], ImVec2(64, 64));
 						ImGui::SameLine();
-						ImGui::Text("%s", textureString(key));
-						index++;
+						ImGui::Text("%s", textureString(scenes[i].model.textureSlots[index]));
 					}
 				}
 			}
@@ -122,43 +124,31 @@ void Engine::Core::SceneManager::updateScene() {
 	}
 }
 
-void Engine::Core::SceneManager::cleanup(Scene scene) const {
-	vkQueueWaitIdle(device.getGraphicsQueue());
-	vkDeviceWaitIdle(device.getDevice());
-
-	auto& p = scene.model.pipeline;
+void Engine::Core::SceneManager::cleanup(Scene& scene) {
 	auto& m = scene.model;
 	const int textureCount = m.texture.getTextureCount();
 
 	if (m.hasTexture) {
 		for (auto &val: m.textureIDs | std::views::values) {
-			ImGui_ImplVulkan_RemoveTexture(val);
+			resources->defer([val](VkDevice) { ImGui_ImplVulkan_RemoveTexture(val); });
 		}
 	}
 
 	m.textureIDs.clear();
 
-	vkDestroyPipeline(device.getDevice(), p.getGraphicsPipeline(), nullptr);
-	vkDestroyPipelineLayout(device.getDevice(), p.getPipelineLayout(), nullptr);
-
-	for (size_t i = 0; i < Engine::Settings::MAX_FRAMES_IN_FLIGHT; i++) {
-		if (i < m.texture.uniformResources.size()) {
-			resources->destroy(m.texture.uniformResources[i]);
-		}
-		if (i < m.texture.skyboxUniformResources.size()) {
-			resources->destroy(m.texture.skyboxUniformResources[i]);
-		}
-	}
+	pipelineRegistry.release(m.pipelineKey);
 
-	vkDestroyDescriptorPool(device.getDevice(), m.descriptor.getDescriptorPool(), nullptr);
+	resources->defer([pool = m.descriptor.getDescriptorPool()](VkDevice device) {
+		vkDestroyDescriptorPool(device, pool, nullptr);
+	});
 
 	if(m.hasTexture) {
 		if (textureCount == -1) {
-			resources->destroy(m.texture.textureResource);
+			Engine::Graphics::releaseTexture(m.texture.textureResource);
 		}
 		else {
 			for (int i = 0; i < textureCount; i++) {
-				resources->destroy(m.texture.textureResources[i]);
+				Engine::Graphics::releaseTexture(m.texture.textureResources[i]);
 			}
 		}
 	}
@@ -167,6 +157,90 @@ void Engine::Core::SceneManager::cleanup(Scene scene) const {
 	resources->destroy(m.texture.indexResource);
 }
 
+void Engine::Core::SceneManager::queuePBRTextures(Engine::Graphics::TextureLoadJob& textures, Model& m, const std::unordered_map<PBRTextureType, std::string>& paths, bool flipTexture)
+{
+	auto path = [&paths](PBRTextureType type) {
+		auto it = paths.find(type);
+		return it != paths.end() ? it->second : std::string();
+	};
+
+	// every slot gets a texture, so each material fills all PBR_TEXTURE_BINDINGS in order
+	for (PBRTextureType type : PBR_UPLOAD_ORDER) {
+		if (type == PBRTextureType::OcclusionRoughnessMetalness) {
+			std::array<std::string, 3> sources;
+			for (size_t c = 0; c < sources.size(); c++)
+				sources[c] = path(ORM_CHANNELS[c]);
+
+			if (std::all_of(sources.begin(), sources.end(), [](const std::string& source) { return source.empty(); }))
+				textures.addSolid(pbrDefaultTexel(type), pbrTextureFormat(type));
+			else
+				textures.addPacked(sources, ORM_DEFAULTS, flipTexture);
+		}
+		else if (paths.contains(type)) {
+			textures.add(path(type), flipTexture, pbrTextureFormat(type));
+		}
+		else {
+			textures.addSolid(pbrDefaultTexel(type), pbrTextureFormat(type));
+		}
+
+		m.textureSlots.push_back(type);
+	}
+}
+
+void Engine::Core::SceneManager::createSceneBuffers()
+{
+	sceneUniformResources.resize(Engine::Settings::MAX_FRAMES_IN_FLIGHT);
+
+	for (size_t i = 0; i < Engine::Settings::MAX_FRAMES_IN_FLIGHT; i++) {
+		sceneUniformResources[i] = framebuffer.createBuffer(device, sizeof(Engine::Graphics::SceneUBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	}
+
+	lightCulling.create(device, renderpass.getLightDescriptorSetLayout(), sceneUniformResources, "shaders/clusterCull.comp.spv");
+}
+
+void Engine::Core::SceneManager::updateSceneBuffer(uint32_t currentFrame, VkExtent2D extent)
+{
+	camera.AspectRatio = extent.width / (float)extent.height;
+
+	sceneLights.clear();
+
+	for (const auto& scene : getScenesOfType(EntityType::Light)) {
+		Engine::Graphics::LightBuffer light{};
+		light.pos = glm::vec3(scene.model.matrix[3]);
+		light.color = scene.model.color;
+		light.radius = Engine::Graphics::LightCulling::lightRadius(light.color);
+
+		sceneLights.push_back(light);
+	}
+
+	lightCulling.updateLights(currentFrame, sceneLights);
+
+	Engine::Graphics::SceneUBO ubo{};
+	ubo.view = camera.GetViewMatrix();
+	ubo.proj = camera.GetProjectionMatrix();
+	ubo.clusterGrid = glm::uvec4(Engine::Graphics::LightCulling::CLUSTER_X, Engine::Graphics::LightCulling::CLUSTER_Y, Engine::Graphics::LightCulling::CLUSTER_Z, Engine::Graphics::LightCulling::MAX_LIGHTS_PER_CLUSTER);
+	ubo.clusterParams = glm::vec4(camera.NearClip, camera.FarClip, static_cast<float>(extent.width), static_cast<float>(extent.height));
+	ubo.numLights = static_cast<int>(sceneLights.size());
+
+	memcpy(sceneUniformResources[currentFrame]->mapped, &ubo, sizeof(ubo));
+}
+
+void Engine::Core::SceneManager::recordLightCulling(VkCommandBuffer commandBuffer, uint32_t currentFrame) const
+{
+	lightCulling.record(commandBuffer, currentFrame);
+}
+
+void Engine::Core::SceneManager::destroySceneBuffers()
+{
+	lightCulling.destroy();
+
+	for (auto* buffer : sceneUniformResources) {
+		resources->destroy(buffer);
+	}
+
+	sceneUniformResources.clear();
+}
+
 const char* Engine::Core::SceneManager::entityString(const EntityType type)
 {
 	switch (type) {
@@ -192,6 +266,7 @@ const char* Engine::Core::SceneManager::textureString(const PBRTextureType type)
 		case PBRTextureType::Metalness: return "Metalness";
 		case PBRTextureType::AmbientOcclusion: return "Ambient Occlusion";
 		case PBRTextureType::Specular: return "Specular";
+		case PBRTextureType::OcclusionRoughnessMetalness: return "Occlusion/Roughness/Metalness";
 		default: return "Unknown";
 	}
 }
@@ -205,6 +280,87 @@ const char* Engine::Core::SceneManager::primitiveString(const PrimitiveType type
 	}
 }
 
+std::span<const uint32_t> Engine::Core::SceneManager::getDrawOrder() {
+	if (drawOrderDirty) {
+		drawOrder.clear();
+
+		// entities whose pipeline is still compiling are left out until updatePipelines swaps it in
+		for (uint32_t i = 0; i < scenes.size(); i++) {
+			if (scenes[i].model.pipeline.getGraphicsPipeline() != VK_NULL_HANDLE)
+				drawOrder.push_back(i);
+		}
+
+		// skybox first, then group by pipeline and mesh so each is bound once per frame
+		std::stable_sort(drawOrder.begin(), drawOrder.end(), [this](uint32_t a, uint32_t b) {
+			const Model& lhs = scenes[a].model;
+			const Model& rhs = scenes[b].model;
+
+			bool lhsSkybox = lhs.type == EntityType::Skybox;
+			bool rhsSkybox = rhs.type == EntityType::Skybox;
+			if (lhsSkybox != rhsSkybox)
+				return lhsSkybox;
+
+			if (lhs.pipeline.getGraphicsPipeline() != rhs.pipeline.getGraphicsPipeline())
+				return lhs.pipeline.getGraphicsPipeline() < rhs.pipeline.getGraphicsPipeline();
+
+			return lhs.texture.vertexResource->buffer < rhs.texture.vertexResource->buffer;
+		});
+
+		drawOrderDirty = false;
+	}
+
+	return drawOrder;
+}
+
+void Engine::Core::SceneManager::prewarmPipelines()
+{
+	struct ShaderPair {
+		const char* vertex;
+		const char* fragment;
+		bool isCube;
+		bool cubeVertex;
+	};
+
+	static constexpr ShaderPair knownPairs[] = {
+		{ "shaders/skyboxVert.vert.spv", "shaders/skyboxFrag.frag.spv", true, true },
+		{ "shaders/light.vert.spv", "shaders/light.frag.spv", true, false },
+		{ "shaders/primitive.vert.spv", "shaders/primitive.frag.spv", true, false },
+		{ "shaders/shader.vert.spv", "shaders/shader.frag.spv", false, false },
+		{ "shaders/textureMapVert.vert.spv", "shaders/textureMapFrag.frag.spv", false, false },
+	};
+
+	for (const auto& pair : knownPairs) {
+		if (!std::filesystem::exists(pair.vertex) || !std::filesystem::exists(pair.fragment))
+			continue;
+
+		if (pair.cubeVertex)
+			pipelineRegistry.prewarm<CubeVertex>(pair.vertex, pair.fragment, device.getDevice(), sampler.getSamples(), renderpass, pair.isCube);
+		else
+			pipelineRegistry.prewarm<Vertex>(pair.vertex, pair.fragment, device.getDevice(), sampler.getSamples(), renderpass, pair.isCube);
+	}
+}
+
+void Engine::Core::SceneManager::updatePipelines()
+{
+	if (pipelineRegistry.poll() == 0)
+		return;
+
+	for (auto& scene : scenes) {
+		auto& m = scene.model;
+		if (m.pipeline.getGraphicsPipeline() != VK_NULL_HANDLE)
+			continue;
+
+		m.pipeline = pipelineRegistry.get(m.pipelineKey);
+		if (m.pipeline.getGraphicsPipeline() != VK_NULL_HANDLE)
+			drawOrderDirty = true;
+	}
+}
+
+void Engine::Core::SceneManager::destroyPipelines()
+{
+	pipelineRegistry.destroy(device.getDevice());
+}
+
 bool Engine::Core::SceneManager::hasSkybox() const {
 	for (auto& scene : scenes) {
 		if (scene.model.type == EntityType::Skybox) {
@@ -0,0 +1,25 @@
+#ifndef BLOCKCOMPRESSION_H
+#define BLOCKCOMPRESSION_H
+
+#include "textureFormat.h"
+
+// CPU encoders for the BC formats textures are stored in when the device supports them.
+// Every encoder reads one 4x4 block of RGBA8 texels in row-major order and writes
+// formatBlockBytes(format) bytes. They favour load-time speed over the last bit of quality:
+// BC7 uses mode 6 only (one subset, 4-bit indices) with a principal-axis fit and one
+// least-squares refinement.
+namespace Engine::Graphics::BlockCompression {
+	void encodeBC1(const uint8_t* rgba, uint8_t* out);
+	void encodeBC4(const uint8_t* rgba, int channel, uint8_t* out);
+	void encodeBC5(const uint8_t* rgba, uint8_t* out);
+	void encodeBC7(const uint8_t* rgba, uint8_t* out);
+
+	// encodes one level laid out as decodeFormat(format); block rows are spread over the thread pool
+	void encodeLevel(VkFormat format, const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* out);
+
+	// encodes pixels and every mip below it (see MipChain::downsample) back to back into out, which must hold
+	// imageDataSize(format, width, height, mipLevelCount(width, height)) bytes
+	std::vector<ImageRegion> encodeMipChain(VkFormat format, const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* out);
+}
+
+#endif
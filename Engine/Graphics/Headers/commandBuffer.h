@@ -31,6 +31,10 @@ namespace Engine::Graphics {
 		void copyBufferToImage(const Engine::Graphics::Device& device, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 		void copyBuffer(const Engine::Graphics::Device& device, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
 
+		static void recordTransitionImageLayout(VkCommandBuffer commandBuffer, ImageResource* image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount);
+		static void recordCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
+		static void recordCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+
 		VkCommandPool getCommandPool() const { return commandPool; }
 		const std::vector<VkCommandBuffer>& getCommandBuffers() const { return commandBuffers; }
 
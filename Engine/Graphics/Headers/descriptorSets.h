@@ -4,6 +4,7 @@
 #include "utility.h"
 #include "imgui.h"
 #include "imgui_impl_vulkan.h"
+#include <span>
 
 namespace Engine::Graphics {
 	class Texture;
@@ -18,10 +19,12 @@ namespace Engine::Graphics {
 
 	public:
 		void createDescriptorPool(VkDevice device);
-		void createDescriptorSets(VkDevice device, Engine::Graphics::Texture texture, VkDescriptorSetLayout descriptorSetLayout, bool isCube, std::unordered_map<PBRTextureType, std::string> texturePaths = {}, bool hasTextures = true);
+		// textureSlots names the PBR slot of each of texture.textureResources; textures are
+		// bound at 1 + their slot's index in PBR_UPLOAD_ORDER
+		void createDescriptorSets(VkDevice device, const Engine::Graphics::Texture& texture, const std::vector<BufferResource*>& sceneBuffers, VkDescriptorSetLayout descriptorSetLayout, bool hasTextures = true, std::span<const PBRTextureType> textureSlots = {});
 
 		VkDescriptorPool getDescriptorPool() const { return descriptorPool; }
-		std::vector<VkDescriptorSet> getDescriptorSets() const { return descriptorSets; }
+		const std::vector<VkDescriptorSet>& getDescriptorSets() const { return descriptorSets; }
 	};
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef KTXFILE_H
+#define KTXFILE_H
+
+#include "textureFormat.h"
+
+namespace Engine::Graphics {
+	// Layout of a KTX2 texture; region offsets point into the file. Cubemap faces and array
+	// layers are flattened into layers, face-major within each array layer.
+	struct KtxImage {
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t levels = 1;
+		uint32_t layers = 1;
+		std::vector<ImageRegion> regions;
+
+		// bytes needed to hold every region packed with alignImageRegion
+		VkDeviceSize dataSize() const;
+	};
+
+	// Reader for KTX2 containers holding pre-compressed (or plain 8-bit) 2D textures, cubemaps
+	// and arrays with their stored mips. Supercompressed files (Basis, zstd) are rejected.
+	class KtxFile
+	{
+	public:
+		static bool isKtx2(const std::string& path);
+		static bool read(const void* data, size_t size, KtxImage& image, std::string& error);
+		static bool isSupportedFormat(VkFormat format);
+	};
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef LIGHTCULLING_H
+#define LIGHTCULLING_H
+
+#include "utility.h"
+#include "texture.h"
+
+namespace Engine::Graphics {
+	class Device;
+
+	// Bins the scene lights into a view-space froxel grid with a compute pass, so forward
+	// shaders only loop over the lights whose range touches the fragment's cluster.
+	class LightCulling
+	{
+	public:
+		static constexpr uint32_t CLUSTER_X = 16;
+		static constexpr uint32_t CLUSTER_Y = 9;
+		static constexpr uint32_t CLUSTER_Z = 24;
+		static constexpr uint32_t CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+		static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+		static constexpr uint32_t WORKGROUP_SIZE = 128;
+
+		// must match the attenuation in the forward shaders
+		static constexpr float ATTENUATION_LINEAR = 0.09f;
+		static constexpr float ATTENUATION_QUADRATIC = 0.032f;
+
+	private:
+		static constexpr uint32_t INITIAL_LIGHT_CAPACITY = 64;
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+		std::vector<VkDescriptorSet> descriptorSets;
+
+		std::vector<BufferResource*> lightResources;
+		std::vector<uint32_t> lightCapacity;
+		std::vector<BufferResource*> clusterCountResources;
+		std::vector<BufferResource*> clusterIndexResources;
+
+	public:
+		void create(const Engine::Graphics::Device& device, VkDescriptorSetLayout setLayout, const std::vector<BufferResource*>& sceneBuffers, const std::string& shaderPath);
+		void destroy();
+
+		void updateLights(uint32_t currentFrame, const std::vector<LightBuffer>& lights);
+		void record(VkCommandBuffer commandBuffer, uint32_t currentFrame) const;
+
+		VkDescriptorSet getDescriptorSet(uint32_t currentFrame) const { return descriptorSets[currentFrame]; }
+
+		static float lightRadius(const glm::vec3& color);
+
+	private:
+		void writeLightDescriptor(uint32_t frame);
+	};
+}
+
+#endif
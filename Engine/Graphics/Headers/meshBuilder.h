@@ -0,0 +1,34 @@
+#ifndef MESHBUILDER_H
+#define MESHBUILDER_H
+
+#include "utility.h"
+#include <span>
+
+namespace Engine::Graphics {
+	// OBJ-style attribute streams with one index triple per face corner, split into ranges
+	// (one per shape) that are treated as a single corner list.
+	struct MeshSource {
+		std::span<const float> positions;
+		std::span<const float> normals;
+		std::span<const float> texcoords;
+		std::vector<std::span<const tinyobj::index_t>> indexRanges;
+
+		static MeshSource fromObj(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes);
+	};
+
+	// Turns face corners into an indexed mesh, merging corners with identical attributes.
+	// Corners are partitioned by hash and deduplicated on the thread pool; unique vertices
+	// keep first-occurrence order, so the output matches a serial pass for any thread count.
+	class MeshBuilder
+	{
+	public:
+		static constexpr size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+		// appends to vertices and indices, offsetting new indices by the existing vertex count
+		static void build(const MeshSource& source, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+		static Vertex makeVertex(const MeshSource& source, const tinyobj::index_t& index);
+	};
+}
+
+#endif
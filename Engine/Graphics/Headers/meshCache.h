@@ -0,0 +1,82 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include "utility.h"
+
+namespace Engine::Graphics {
+	struct MeshBounds {
+		glm::vec3 min = glm::vec3(0.0f);
+		glm::vec3 max = glm::vec3(0.0f);
+	};
+
+	// Cooked .fmesh copies of OBJ models: the deduplicated vertex and index streams, the
+	// material table and the bounds, keyed by source path and fingerprinted by the size,
+	// timestamp and content hash of the OBJ and every material library it read. A hit is a
+	// memory-mapped copy with no parsing.
+	//
+	// The geometry does not depend on the material directory, so one copy serves every load
+	// of a model. A copy cooked with materials from one directory also serves loads without
+	// materials; a load that wants materials from a directory the copy was not cooked with
+	// re-cooks it.
+	class MeshCache
+	{
+	public:
+		static constexpr const char* DEFAULT_DIRECTORY = "cache/meshes";
+
+		// Appends the model's vertices and indices (offset by the existing vertex count) and,
+		// when materialDir is given, its materials. Parses and cooks the OBJ on a miss.
+		static MeshBounds loadObj(const std::string& modelPath, const std::optional<std::string>& materialDir, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<Materials>* materials = nullptr);
+
+		// parses the OBJ and writes its cooked copy whatever the cache already holds; vertices,
+		// indices and materials are replaced with what was written
+		static MeshBounds cook(const std::string& modelPath, const std::optional<std::string>& materialDir, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<Materials>& materials);
+
+		static std::string cachePath(const std::string& modelPath);
+		static uint64_t hashFile(const char* data, size_t size);
+
+	private:
+		static constexpr uint32_t MAGIC = 0x48534d46; // "FMSH"
+		static constexpr uint32_t VERSION = 3;
+		static constexpr size_t BLOB_ALIGNMENT = 64;
+		static constexpr size_t HASH_BLOCK_SIZE = 4 * 1024 * 1024;
+
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vertexStride;
+			uint32_t materialCount;
+			uint32_t sourceCount;
+			// set when the material table was read from a material directory, which is stored
+			// ahead of the table
+			uint32_t hasMaterials;
+			uint64_t sourceOffset;
+			uint64_t sourceTableSize;
+			uint64_t vertexCount;
+			uint64_t indexCount;
+			uint64_t materialOffset;
+			uint64_t materialSize;
+			uint64_t vertexOffset;
+			uint64_t indexOffset;
+			float boundsMin[3];
+			float boundsMax[3];
+		};
+
+		struct SourceInfo {
+			uint64_t size = 0;
+			int64_t time = 0;
+			bool exists = false;
+		};
+
+		static SourceInfo sourceInfo(const std::string& sourcePath);
+		static uint64_t hashSource(const std::string& sourcePath);
+
+		static std::string materialKey(const std::string& materialDir);
+
+		// materials, when given, must come from materialDir
+		static bool read(const std::string& path, const std::optional<std::string>& materialDir, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<Materials>* materials, MeshBounds& bounds);
+		// sources are the OBJ followed by its material libraries
+		static void write(const std::string& path, const std::vector<std::string>& sources, const std::optional<std::string>& materialDir, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Materials>& materials, const MeshBounds& bounds);
+	};
+}
+
+#endif
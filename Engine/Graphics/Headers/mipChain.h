@@ -0,0 +1,18 @@
+#ifndef MIPCHAIN_H
+#define MIPCHAIN_H
+
+#include "textureFormat.h"
+
+// CPU mip generation for the 8-bit layouts textures are decoded to, for chains the GPU
+// cannot build: levels that are block-compressed afterwards and assets cooked offline.
+namespace Engine::Graphics::MipChain {
+	// halves a level with a 2x2 box filter; sRGB colour is averaged in linear space. Rows are
+	// spread over the thread pool and filtered with SSE2 where available.
+	void downsample(VkFormat pixelFormat, const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dst);
+
+	// copies pixels and writes every level below it into out as laid out by mipRegions; out
+	// must hold imageDataSize(pixelFormat, width, height, mipLevelCount(width, height)) bytes
+	std::vector<ImageRegion> build(VkFormat pixelFormat, const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* out);
+}
+
+#endif
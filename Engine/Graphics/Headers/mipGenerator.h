@@ -0,0 +1,79 @@
+#ifndef MIPGENERATOR_H
+#define MIPGENERATOR_H
+
+#include "utility.h"
+
+namespace Engine::Graphics {
+	class Device;
+	class CommandBuffer;
+
+	// Builds mip chains with one compute dispatch per 12 levels instead of one blit and two
+	// barriers per level (see shaders/mipGen.glsl). Works on 8-bit RGBA, RG and R images,
+	// including sRGB ones through a UNORM storage view, and on every layer of arrays and
+	// cubemaps at once. Formats or devices it cannot handle keep using the blit chain.
+	class MipGenerator
+	{
+	public:
+		static constexpr uint32_t MAX_LEVELS_PER_PASS = 12;
+		static constexpr uint32_t TILE_SIZE = 64;
+		static constexpr uint32_t MAX_LAYERS = 2048;
+
+		// image views and descriptors of one recorded chain; released once its commands have run
+		struct Dispatch {
+			VkDescriptorPool pool = VK_NULL_HANDLE;
+			std::vector<VkImageView> views;
+		};
+
+	private:
+		enum Variant : uint32_t { RGBA, RG, R, VARIANT_COUNT };
+
+		struct PushConstants {
+			uint32_t sourceWidth;
+			uint32_t sourceHeight;
+			uint32_t levels;
+			uint32_t srgb;
+			uint32_t tilesPerLayer;
+		};
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+
+		VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		std::array<VkPipeline, VARIANT_COUNT> pipelines{};
+		std::array<bool, VARIANT_COUNT> variantSupported{};
+		VkSampler sampler = VK_NULL_HANDLE;
+
+		// one completion counter per layer; the shader resets each one after use
+		BufferResource* counters = nullptr;
+
+	public:
+		MipGenerator() = default;
+		~MipGenerator();
+
+		void create(const Engine::Graphics::Device& device, const std::string& shaderDirectory);
+		void destroy();
+
+		bool supports(VkFormat format) const;
+		// usage and create flags to add to an image of format so it can be passed to record
+		void prepareImage(VkFormat format, VkImageUsageFlags& usage, VkImageCreateFlags& flags) const;
+		bool canRecord(const ImageResource* image, VkFormat format, uint32_t layerCount) const;
+
+		// expects every level in image->layout with level 0 filled and leaves them all in
+		// SHADER_READ_ONLY_OPTIMAL; dispatch must outlive the command buffer
+		void record(VkCommandBuffer commandBuffer, ImageResource* image, VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layerCount, Dispatch& dispatch);
+		void release(Dispatch& dispatch);
+
+		// times the blit chain, this generator and the CPU chain on the same images and logs the results
+		void benchmark(const Engine::Graphics::Device& device, const Engine::Graphics::CommandBuffer& commandBuf);
+
+	private:
+		static Variant variantOf(VkFormat format);
+		static VkFormat storageFormat(VkFormat format);
+		VkImageView createView(VkImage image, VkFormat format, VkImageUsageFlags usage, uint32_t level, uint32_t layerCount);
+	};
+}
+
+extern std::unique_ptr<Engine::Graphics::MipGenerator> mipGenerator;
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include "utility.h"
+#include "meshBuilder.h"
+
+namespace Engine::Graphics {
+	// Flattened contents of an OBJ file: attribute streams plus one index triple per
+	// triangle corner, in file order, ready for MeshBuilder.
+	struct ObjMesh {
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> texcoords;
+		std::vector<tinyobj::index_t> corners;
+		std::vector<Materials> materials;
+		// the mtllib files materials were read from
+		std::vector<std::string> materialLibraries;
+
+		MeshSource source() const;
+	};
+
+	// Memory-maps the OBJ and parses line-aligned chunks on the thread pool. Files using
+	// features the fast path does not cover (line continuations, texture options in the
+	// MTL) are handed to tinyobj instead, so every file tinyobj accepts still loads.
+	class ObjLoader
+	{
+	public:
+		static constexpr size_t MIN_CHUNK_SIZE = 1024 * 1024;
+
+		// materialDir is where mtllib files are looked up; without one materials are skipped
+		static ObjMesh load(const std::string& path, const std::optional<std::string>& materialDir = std::nullopt);
+
+		// the mtllib files a load with materialDir reads, without parsing the rest of the OBJ
+		static std::vector<std::string> materialLibraries(const std::string& path, const std::string& materialDir);
+
+	private:
+		static bool parseChunked(const std::string& path, const std::optional<std::string>& materialDir, ObjMesh& mesh, size_t& bytes);
+		static bool parseMaterials(std::string_view text, std::vector<Materials>& materials);
+		static void loadWithTinyObj(const std::string& path, const std::optional<std::string>& materialDir, ObjMesh& mesh, size_t& bytes);
+	};
+}
+
+#endif
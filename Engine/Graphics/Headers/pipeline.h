@@ -3,6 +3,7 @@
 
 #include "utility.h"
 #include "renderPass.h"
+#include "pipelineCache.h"
 
 struct CubeVertex;
 
@@ -11,17 +12,24 @@ namespace Engine::Graphics {
 	class RenderPass;
 	class Sampler;
 
+	struct ObjectPushConstants {
+		glm::mat4 model;
+		alignas(16) glm::vec3 color;
+	};
+
 	class Pipeline
 	{
 	private:
-		VkPipelineLayout pipelineLayout;
-		VkPipeline graphicsPipeline;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		VkPipeline graphicsPipeline = VK_NULL_HANDLE;
 	public:
 		Pipeline() = default;
 		~Pipeline();
 
 		template<typename VertexType>
-		void createGraphicsPipeline(std::string vertexShaderPath, std::string fragmentShaderPath, VkDevice device, VkSampleCountFlagBits msaaSamples, Engine::Graphics::RenderPass renderpass, bool isCube) {
+		void createGraphicsPipeline(std::string vertexShaderPath, std::string fragmentShaderPath, VkDevice device, VkSampleCountFlagBits msaaSamples, const Engine::Graphics::RenderPass& renderpass, bool isCube, VkPipelineLayout layout) {
+			pipelineLayout = layout;
+
 			auto vertShaderCode = readFile(vertexShaderPath);
 			auto fragShaderCode = readFile(fragmentShaderPath);
 
@@ -132,18 +140,6 @@ namespace Engine::Graphics {
 			dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
 			dynamicState.pDynamicStates = dynamicStates.data();
 
-			VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-			pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-			pipelineLayoutInfo.setLayoutCount = 1;
-			VkDescriptorSetLayout descriptorsetlayout;
-			descriptorsetlayout = renderpass.getDescriptorSetLayout();
-			
-			pipelineLayoutInfo.pSetLayouts = &descriptorsetlayout;
-
-			if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-				throw std::runtime_error("failed to create pipeline layout!");
-			}
-
 			VkGraphicsPipelineCreateInfo pipelineInfo{};
 			pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 			pipelineInfo.stageCount = 2;
@@ -161,7 +157,7 @@ namespace Engine::Graphics {
 			pipelineInfo.subpass = 0;
 			pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-			if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+			if (vkCreateGraphicsPipelines(device, pipelineCache ? pipelineCache->get() : VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
 				throw std::runtime_error("failed to create graphics pipeline!");
 			}
 
@@ -169,8 +165,9 @@ namespace Engine::Graphics {
 			vkDestroyShaderModule(device, vertShaderModule, nullptr);
 		}
 
-		VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
-		std::vector<char> readFile(const std::string& filename);
+		static VkPipelineLayout createPipelineLayout(VkDevice device, const Engine::Graphics::RenderPass& renderpass);
+		static VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code);
+		static std::vector<char> readFile(const std::string& filename);
 
 		VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
 		VkPipeline getGraphicsPipeline() const { return graphicsPipeline; }
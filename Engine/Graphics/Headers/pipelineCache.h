@@ -0,0 +1,55 @@
+#ifndef PIPELINECACHE_H
+#define PIPELINECACHE_H
+
+#include "utility.h"
+
+namespace Engine::Graphics {
+	class Device;
+
+	// Engine-wide VkPipelineCache persisted between runs. The file is prefixed with the device
+	// identity and driver version so a cache from another GPU or driver is discarded, not fed
+	// to the driver.
+	class PipelineCache
+	{
+	public:
+		static constexpr const char* DEFAULT_PATH = "cache/pipelines.bin";
+
+	private:
+		static constexpr uint32_t MAGIC = 0x43504646; // "FFPC"
+		static constexpr uint32_t VERSION = 1;
+
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vendorID;
+			uint32_t deviceID;
+			uint32_t driverVersion;
+			uint8_t uuid[VK_UUID_SIZE];
+			uint64_t dataSize;
+		};
+
+		VkDevice device = VK_NULL_HANDLE;
+		VkPipelineCache cache = VK_NULL_HANDLE;
+		VkPhysicalDeviceProperties properties{};
+		std::string path;
+		size_t loadedSize = 0;
+
+	public:
+		PipelineCache() = default;
+
+		void create(const Engine::Graphics::Device& device, const std::string& path = DEFAULT_PATH);
+		void save() const;
+		void destroy();
+
+		VkPipelineCache get() const { return cache; }
+		bool isWarm() const { return loadedSize > 0; }
+
+	private:
+		std::vector<char> load() const;
+		bool validate(const FileHeader& header) const;
+	};
+}
+
+extern std::unique_ptr<Engine::Graphics::PipelineCache> pipelineCache;
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef PIPELINEREGISTRY_H
+#define PIPELINEREGISTRY_H
+
+#include "utility.h"
+#include "pipeline.h"
+#include "threadPool.h"
+#include <typeindex>
+
+namespace Engine::Graphics {
+	struct PipelineKey {
+		std::string vertexShader;
+		std::string fragmentShader;
+		std::type_index vertexType = typeid(void);
+		bool isCube = false;
+		VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+		bool operator==(const PipelineKey& other) const = default;
+	};
+
+	struct PipelineKeyHash {
+		size_t operator()(const PipelineKey& key) const;
+	};
+
+	// Hands out one graphics pipeline per distinct shader pair, vertex layout and raster state.
+	// Every pipeline shares a single layout, so descriptor sets and push constants stay valid
+	// across pipeline switches while recording. New pipelines compile on the thread pool and
+	// become visible through get() once poll() has collected them on the render thread.
+	class PipelineRegistry
+	{
+	private:
+		struct Entry {
+			Pipeline pipeline;
+			std::future<Pipeline> pending;
+			uint32_t refCount = 0;
+			bool resident = false;
+			// the compile threw; the entry stays so the key is not resubmitted every frame
+			bool failed = false;
+		};
+
+		std::unordered_map<PipelineKey, Entry, PipelineKeyHash> pipelines;
+		std::vector<std::future<Pipeline>> orphaned;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+
+	public:
+		template<typename VertexType>
+		PipelineKey acquire(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, VkDevice device, VkSampleCountFlagBits msaaSamples, const Engine::Graphics::RenderPass& renderpass, bool isCube) {
+			PipelineKey key = request<VertexType>(vertexShaderPath, fragmentShaderPath, device, msaaSamples, renderpass, isCube);
+			pipelines.at(key).refCount++;
+			return key;
+		}
+
+		// compiles ahead of use and keeps the pipeline alive with no entities referencing it
+		template<typename VertexType>
+		void prewarm(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, VkDevice device, VkSampleCountFlagBits msaaSamples, const Engine::Graphics::RenderPass& renderpass, bool isCube) {
+			PipelineKey key = request<VertexType>(vertexShaderPath, fragmentShaderPath, device, msaaSamples, renderpass, isCube);
+			pipelines.at(key).resident = true;
+		}
+
+		Pipeline get(const PipelineKey& key) const;
+		size_t poll();
+		void release(const PipelineKey& key);
+		void destroy(VkDevice device);
+
+		VkPipelineLayout getPipelineLayout() const { return pipelineLayout; }
+		size_t size() const { return pipelines.size(); }
+
+	private:
+		template<typename VertexType>
+		PipelineKey request(const std::string& vertexShaderPath, const std::string& fragmentShaderPath, VkDevice device, VkSampleCountFlagBits msaaSamples, const Engine::Graphics::RenderPass& renderpass, bool isCube) {
+			PipelineKey key{ normalizePath(vertexShaderPath), normalizePath(fragmentShaderPath), typeid(VertexType), isCube, msaaSamples };
+
+			if (!pipelines.contains(key)) {
+				if (pipelineLayout == VK_NULL_HANDLE)
+					pipelineLayout = Pipeline::createPipelineLayout(device, renderpass);
+
+				auto compile = [vert = key.vertexShader, frag = key.fragmentShader, device, msaaSamples, &renderpass, isCube, layout = pipelineLayout]() {
+					Pipeline pipeline;
+					pipeline.createGraphicsPipeline<VertexType>(vert, frag, device, msaaSamples, renderpass, isCube, layout);
+					return pipeline;
+				};
+
+				Entry& entry = pipelines[key];
+				entry.pending = threadPool ? threadPool->submit(std::move(compile)) : std::async(std::launch::deferred, std::move(compile));
+			}
+
+			return key;
+		}
+
+		static std::string normalizePath(const std::string& path);
+	};
+}
+
+#endif
@@ -14,14 +14,27 @@ struct AccelerationStructure {
 
 struct ScratchBuffer {
     VkBuffer handle;
-    VkDeviceMemory memory;
+    VmaAllocation allocation;
     VkDeviceAddress deviceAddress;
 
     ScratchBuffer(Engine::Graphics::Device device, VkDeviceSize size);
+    void destroy();
+};
+
+// what the host rewrites between frames, kept once per frame in flight so a frame never
+// touches a TLAS, instance buffer or descriptor an earlier frame may still be reading
+struct RaytracingFrame {
+    AccelerationStructure TLAS{};
+    BufferResource* instanceBuffer = nullptr;
+    BufferResource* textureFlagBuffer = nullptr;
+    std::optional<ScratchBuffer> scratchBuffer;
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    uint64_t instanceVersion = 0;
+    uint64_t modelVersion = 0;
 };
 
 struct StorageImage {
-    VkDeviceMemory memory;
+    VmaAllocation allocation = VK_NULL_HANDLE;
     VkImage image;
     VkImageView view;
     VkFormat format;
@@ -57,7 +70,7 @@ namespace Engine::Graphics {
         VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures{};
 
         std::vector<AccelerationStructure> BLAS;
-        AccelerationStructure TLAS;
+        std::array<RaytracingFrame, Engine::Settings::MAX_FRAMES_IN_FLIGHT> frames;
         
         std::vector<VkRayTracingShaderGroupCreateInfoKHR> shaderGroups;
 
@@ -74,7 +87,6 @@ namespace Engine::Graphics {
         VkPipelineLayout pipelineLayout;
         VkDescriptorSetLayout descriptorSetLayout;
         VkDescriptorPool descriptorPool;
-        VkDescriptorSet descriptorSet;
 
         BufferResource* raygenResource;
         BufferResource* missResource;
@@ -82,14 +94,18 @@ namespace Engine::Graphics {
         BufferResource* anyHitResource;
 
         BufferResource* uniformBuffer;
+        VkDeviceSize uniformStride = 0;
         RaytracingUniformBufferObject uboData;
 
-        BufferResource* instanceBuffer;
-        BufferResource* textureFlagBuffer;
-
         std::vector<std::shared_ptr<RTScene>> models;
 
         bool sceneUpdated = false;
+        // bumped when instance transforms change; each frame refits its own TLAS once it
+        // sees a newer version, after its fence has been waited on
+        uint64_t instanceVersion = 0;
+        // bumped when a model is removed; each frame then rebuilds its TLAS and rewrites the
+        // per-model descriptors in its own set
+        uint64_t modelVersion = 0;
 	public:
         VkDeviceAddress getBufferDeviceAddress(VkDevice device, VkBuffer buffer);
         std::vector<char> readFile(const std::string& filename);
@@ -100,18 +116,20 @@ namespace Engine::Graphics {
         auto createBottomLevelAccelerationStructure(Engine::Graphics::Device device, uint32_t index);
         void createBottomLevelAccelerationStructure(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::CommandBuffer commandBuffer, std::shared_ptr<RTScene> model);
         void createTopLevelAccelerationStructure(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::CommandBuffer commandBuffer);
-        void updateTopLevelAccelerationStructure(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::CommandBuffer commandBuffer, bool rebuild = false);
+        void updateTopLevelAccelerationStructure(Engine::Graphics::Device device, VkCommandBuffer commandBuffer, uint32_t frameIndex);
+        void removeModel(const std::shared_ptr<RTScene>& model);
         
         void buildAccelerationStructure(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandbuffer, Engine::Graphics::FrameBuffer framebuffer);
         void createShaderBindingTables(Engine::Graphics::Device device);
         void createDescriptorSets(const Engine::Graphics::Device& device, std::optional<Engine::Graphics::Texture> skyboxTexture = std::nullopt);
         void updateDescriptorSets(Engine::Graphics::Device device);
+        void writeModelDescriptors(VkDevice device, RaytracingFrame& frame);
         void createRayTracingPipeline(Engine::Graphics::Device device, std::string raygenShaderPath, std::string missShaderPath, std::string chitShaderPath, std::string ahitShaderPath, std::string intShaderPath);
         void createImage(Engine::Graphics::Device device, VkCommandPool commandPool, VkExtent2D extent);
-        void traceRays(VkDevice device, VkCommandBuffer commandBuffer, SwapchainResource* resource, uint32_t currentIndex);
+        void traceRays(VkDevice device, VkCommandBuffer commandBuffer, SwapchainResource* resource, uint32_t currentIndex, uint32_t frameIndex);
     
         void createUniformBuffer(Engine::Graphics::Device device);
-        void updateUBO(Engine::Graphics::Device device);
+        void updateUBO(Engine::Graphics::Device device, uint32_t frameIndex);
         void recreateScene(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::CommandBuffer commandBuffer, Engine::Graphics::Swapchain swapchain, Engine::Core::RT::SceneManager rtscenemanager, std::optional<Engine::Graphics::Texture> skyboxTexture = std::nullopt);
 
         void cleanup(VkDevice device, bool softClean = false);
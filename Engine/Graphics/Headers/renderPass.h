@@ -14,6 +14,7 @@ namespace Engine::Graphics {
 		VkRenderPass renderPass;
 		VkDescriptorSetLayout descriptorSetLayout;
 		VkDescriptorSetLayout pbrDescriptorSetLayout;
+		VkDescriptorSetLayout lightDescriptorSetLayout;
 
 	public:
 		RenderPass() = default;
@@ -30,6 +31,7 @@ namespace Engine::Graphics {
 		VkRenderPass getRenderPass() const { return renderPass; }
 		VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
 		VkDescriptorSetLayout getPBRDescriptorSetLayout() const { return pbrDescriptorSetLayout; }
+		VkDescriptorSetLayout getLightDescriptorSetLayout() const { return lightDescriptorSetLayout; }
 	};
 }
 #endif
\ No newline at end of file
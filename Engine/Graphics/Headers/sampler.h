@@ -21,6 +21,7 @@ namespace Engine::Graphics {
 
 		VkSampleCountFlagBits getMaxUsableSampleCount(VkPhysicalDevice physicalDevice);
 		void generateMipmaps(Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::Device device, ImageResource* image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels, uint32_t layerCount);
+		static void recordMipmaps(VkCommandBuffer commandBuffer, VkPhysicalDevice physicalDevice, ImageResource* image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels, uint32_t layerCount);
 	};
 }
 
@@ -0,0 +1,73 @@
+#ifndef STAGINGRING_H
+#define STAGINGRING_H
+
+#include "utility.h"
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace Engine::Graphics {
+	class Device;
+
+	struct StagingAllocation {
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		void* mapped = nullptr;
+		uint64_t id = 0;
+	};
+
+	// Persistently mapped staging memory shared by every upload. Regions are handed out in
+	// ring order and reclaimed once the fence of the submission that read them has signalled.
+	class StagingRing
+	{
+	public:
+		static constexpr VkDeviceSize DEFAULT_CAPACITY = 64ull * 1024 * 1024;
+
+	private:
+		struct Region {
+			uint64_t id;
+			VkDeviceSize begin;
+			VkDeviceSize end;
+			VkFence fence = VK_NULL_HANDLE;
+			bool retired = false;
+		};
+
+		VkDevice device = VK_NULL_HANDLE;
+		BufferResource* resource = nullptr;
+		VkDeviceSize capacity = 0;
+
+		std::deque<Region> regions;
+		uint64_t nextId = 0;
+		std::mutex mutex;
+		// signalled whenever regions are retired or released
+		std::condition_variable reclaimed;
+
+	public:
+		StagingRing() = default;
+		~StagingRing();
+
+		void create(const Engine::Graphics::Device& device, VkDeviceSize capacity = DEFAULT_CAPACITY);
+		void destroy();
+
+		// waits for submitted regions to retire when the ring is full, but returns nullopt
+		// when the oldest region has not been submitted, since its owner may be the caller
+		std::optional<StagingAllocation> allocate(VkDeviceSize size, VkDeviceSize alignment);
+		void submit(const std::vector<uint64_t>& ids, VkFence fence);
+		void retire(VkFence fence);
+		// gives back a region that was allocated but will never be submitted
+		void release(uint64_t id);
+
+		VkDeviceSize getCapacity() const { return capacity; }
+		VkDeviceSize getMaxChunkSize() const { return capacity / 4; }
+
+	private:
+		Region* find(uint64_t id);
+		void reclaim();
+		std::optional<VkDeviceSize> findSpace(VkDeviceSize size, VkDeviceSize alignment) const;
+	};
+}
+
+extern std::unique_ptr<Engine::Graphics::StagingRing> stagingRing;
+
+#endif
@@ -7,29 +7,29 @@
 namespace Engine::Graphics {
 	struct LightBuffer {
 		alignas(16) glm::vec3 pos;
+		float radius;
 		alignas(16) glm::vec3 color;
 	};
 
-	struct UniformBufferObject {
-		glm::mat4 model;
+	// Written once per frame and shared by every draw. The skybox shader reads only view and proj;
+	// the lights themselves live in the light culling SSBO.
+	struct SceneUBO {
 		glm::mat4 view;
 		glm::mat4 proj;
-		alignas(16) glm::vec3 color;
-		alignas(16) LightBuffer lights[99];
+		alignas(16) glm::uvec4 clusterGrid;
+		alignas(16) glm::vec4 clusterParams;
 		alignas(4) int numLights;
 	};
 
-	struct SkyboxUBO {
-		glm::mat4 view;
-		glm::mat4 proj;
-	};
-
 	class Device;
 	class FrameBuffer;
 	class Sampler;
 	class Pipeline;
 	class CommandBuffer;
 	class Swapchain;
+	class UploadBatch;
+	class TextureLoadJob;
+	struct DecodedImage;
 
 	class Texture
 	{
@@ -40,9 +40,6 @@ namespace Engine::Graphics {
 		BufferResource* vertexResource;
 		BufferResource* indexResource;
 
-		std::vector<BufferResource*> uniformResources;
-		std::vector<BufferResource*> skyboxUniformResources;
-
 	private:
 		uint32_t mipLevels;
 		std::vector<uint32_t> vecMipLevels;
@@ -60,18 +57,24 @@ namespace Engine::Graphics {
 		
 	public:
 		void createTextureImage(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::Sampler sampler, bool flipTexture, bool isPBR = false, bool isCube = false, bool useSampler = false);
+		void createTextureImage(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool flipTexture, bool isPBR = false, bool isCube = false, bool useSampler = false);
 		ImageResource* createImageResource(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::Sampler sampler, bool flipTexture, bool isPBR = false, bool isCube = false, bool useSampler = false);
+		ImageResource* createImageResource(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool flipTexture, bool isPBR = false, bool isCube = false, bool useSampler = false);
+		void createTextureImage(Engine::Graphics::DecodedImage& image, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool isPBR = false, bool isCube = false, bool useSampler = false);
+		ImageResource* createImageResource(Engine::Graphics::DecodedImage& decoded, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool isPBR = false, bool isCube = false, bool useSampler = false);
 		void loadModel(const std::string modelPath);
 		void loadModel(const std::string modelPath, const std::string materialPath);
 		MeshObject loadModelRT(const std::string modelPath, Engine::Graphics::Device device, Engine::Graphics::FrameBuffer fb);
 		MeshObject loadModelRT(const std::string modelPath, const std::string materialPath, Engine::Graphics::Device device, Engine::Graphics::FrameBuffer fb, Engine::Graphics::CommandBuffer cb, Engine::Graphics::Sampler sampler, Engine::Graphics::Swapchain swapchain);
 		void createVertexBuffer(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer fb);
 		void createIndexBuffer(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer fb);
-		void createUniformBuffers(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer fb);
+		void createVertexBuffer(Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer fb);
+		void createIndexBuffer(Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer fb);
 		void createSyncObjects(VkDevice device);
-		void updateUniformBuffer(uint32_t currentImage, Engine::Core::Camera& camera, VkExtent2D swapChainExtent, glm::mat4 model, glm::vec3 color, std::vector<LightBuffer> lights);
 
 		void createCubemap(const std::vector<std::string>& faces, Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuffer, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::Sampler sampler, bool flipTexture);
+		void createCubemap(const std::vector<std::string>& faces, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool flipTexture);
+		void createCubemap(Engine::Graphics::TextureLoadJob& faces, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer);
 		void createCube();
 		void createSkybox();
 		void createPlane();
@@ -79,8 +82,8 @@ namespace Engine::Graphics {
 		MeshObject createSphereRT(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer fb, float radius=1.0f, int stacks=50, int sectors=50);
 		void createCubeVertexBuffer(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer fb);
 		void createCubeIndexBuffer(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer fb);
-		void createSkyboxUniformBuffers(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer framebuffer);
-		void updateSkyboxUniformBuffer(uint32_t currentImage, Engine::Core::Camera& camera, VkExtent2D swapChainExtent);
+		void createCubeVertexBuffer(Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer fb);
+		void createCubeIndexBuffer(Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer fb);
 
 		void cleanup(VkDevice device);
 
@@ -90,16 +93,16 @@ namespace Engine::Graphics {
 		uint32_t getMipLevels() const { return mipLevels; }
 		uint32_t getMipLevels(int index) const { return vecMipLevels[index]; }
 
-		std::vector<VkSemaphore> getImageAvailableSemaphores() { return imageAvailableSemaphores; }
-		std::vector<VkSemaphore> getRenderFinishedSemaphores() { return renderFinishedSemaphores; }
-		std::vector<VkFence> getInFlightFences() { return inFlightFences; }
+		const std::vector<VkSemaphore>& getImageAvailableSemaphores() const { return imageAvailableSemaphores; }
+		const std::vector<VkSemaphore>& getRenderFinishedSemaphores() const { return renderFinishedSemaphores; }
+		const std::vector<VkFence>& getInFlightFences() const { return inFlightFences; }
 		
-		std::vector<Vertex> getVertices() const { return vertices; }
-		std::vector<uint32_t> getIndices() const { return indices; }
-		std::vector<Materials> getMaterials() const { return mats; }
+		const std::vector<Vertex>& getVertices() const { return vertices; }
+		const std::vector<uint32_t>& getIndices() const { return indices; }
+		const std::vector<Materials>& getMaterials() const { return mats; }
 
-		std::vector<CubeVertex> getCubeVertices() const { return cubeVertices; }
-		std::vector<uint32_t> getCubeIndices() const { return cubeIndices; }
+		const std::vector<CubeVertex>& getCubeVertices() const { return cubeVertices; }
+		const std::vector<uint32_t>& getCubeIndices() const { return cubeIndices; }
 	};
 }
 
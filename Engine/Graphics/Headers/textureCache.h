@@ -0,0 +1,59 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include "utility.h"
+
+namespace Engine::Graphics {
+	// The format carries the colour space too (SRGB and UNORM views of the same file are
+	// different textures).
+	struct TextureKey {
+		std::string path;
+		bool flip = false;
+		VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+
+		bool operator==(const TextureKey& other) const = default;
+	};
+
+	struct TextureKeyHash {
+		size_t operator()(const TextureKey& key) const;
+	};
+
+	// Shares one image, mip chain and sampler between every entity and material that samples
+	// the same file. Images are reference counted and destroyed when the last user releases
+	// them. Used from the main thread only.
+	class TextureCache
+	{
+	private:
+		struct Entry {
+			ImageResource* image = nullptr;
+			uint32_t mipLevels = 1;
+			uint32_t refCount = 0;
+		};
+
+		std::unordered_map<TextureKey, Entry, TextureKeyHash> entries;
+		std::unordered_map<ImageResource*, TextureKey> owners;
+
+	public:
+		static TextureKey makeKey(const std::string& path, bool flip, VkFormat format);
+
+		bool contains(const TextureKey& key) const { return entries.contains(key); }
+
+		// returns nullptr when the image is not resident; a hit takes a reference
+		ImageResource* acquire(const TextureKey& key, uint32_t& mipLevels);
+		// the caller holds the first reference
+		void insert(const TextureKey& key, ImageResource* image, uint32_t mipLevels);
+		// images the cache does not own are destroyed outright
+		void release(ImageResource* image);
+		void clear();
+
+		uint32_t useCount(ImageResource* image) const;
+		size_t size() const { return entries.size(); }
+	};
+
+	// drops one reference, falling back to a plain destroy once the cache is gone
+	void releaseTexture(ImageResource* image);
+}
+
+extern std::unique_ptr<Engine::Graphics::TextureCache> textureCache;
+
+#endif
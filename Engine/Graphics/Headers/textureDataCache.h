@@ -0,0 +1,91 @@
+#ifndef TEXTUREDATACACHE_H
+#define TEXTUREDATACACHE_H
+
+#include "textureCache.h"
+#include "ktxFile.h"
+#include "mappedFile.h"
+#include <mutex>
+#include <future>
+
+namespace Engine::Graphics {
+	// Cooked .ftex copies of decoded textures: the pixels in their final format (block
+	// compressed or not) with the whole mip chain, keyed by the texture key (source path,
+	// flip and format) and fingerprinted by each source's size, timestamp and content hash.
+	// A hit is a memory-mapped file whose levels are copied out as they are, with no decode
+	// and no mip generation. Misses are loaded the usual way and cooked on the thread pool.
+	class TextureDataCache
+	{
+	public:
+		static constexpr const char* DEFAULT_DIRECTORY = "cache/textures";
+		static constexpr size_t MAX_SOURCES = 3;
+
+		// maps the cooked copy of key; layout regions point into file like KtxFile::read's do
+		static bool find(const TextureKey& key, const std::vector<std::string>& sources, Engine::Utility::MappedFile& file, KtxImage& layout);
+
+		// cooks in the background. data holds the regions of a loaded texture: level 0 only,
+		// in which case the chain is built here, or a whole block-compressed chain. Keys that
+		// are already being cooked are skipped.
+		static void cook(const TextureKey& key, const std::vector<std::string>& sources, uint32_t width, uint32_t height, const void* data, const std::vector<ImageRegion>& regions);
+
+		// cooks on the calling thread; returns false if nothing was written
+		static bool store(const TextureKey& key, const std::vector<std::string>& sources, uint32_t width, uint32_t height, const void* data, const std::vector<ImageRegion>& regions);
+
+		// waits for every queued cook; call before the thread pool goes away
+		static void finish();
+
+		// named after the first source so the cache directory stays readable
+		static std::string cachePath(const TextureKey& key, const std::string& source);
+
+	private:
+		static constexpr uint32_t MAGIC = 0x58455446; // "FTEX"
+		static constexpr uint32_t VERSION = 1;
+		static constexpr size_t BLOB_ALIGNMENT = 64;
+
+		struct SourceStamp {
+			uint64_t size;
+			int64_t time;
+		};
+
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t format;
+			uint32_t width;
+			uint32_t height;
+			uint32_t levels;
+			uint32_t layers;
+			uint32_t regionCount;
+			uint32_t sourceCount;
+			uint32_t padding;
+			SourceStamp sources[MAX_SOURCES];
+			uint64_t sourceHash;
+			uint64_t regionOffset;
+			uint64_t dataOffset;
+			uint64_t dataSize;
+		};
+
+		// offsets are relative to the header's dataOffset
+		struct RegionEntry {
+			uint64_t offset;
+			uint64_t size;
+			uint32_t width;
+			uint32_t height;
+			uint32_t level;
+			uint32_t layer;
+		};
+
+		struct Cooking {
+			std::mutex mutex;
+			std::vector<std::string> paths;
+			std::vector<std::future<void>> pending;
+		};
+
+		static Cooking& cooking();
+		static bool sourceStamp(const std::string& path, SourceStamp& stamp);
+		static uint64_t hashSources(const std::vector<std::string>& sources);
+
+		static bool write(const std::string& path, const TextureKey& key, const std::vector<std::string>& sources, uint32_t width, uint32_t height, const uint8_t* data, const std::vector<ImageRegion>& regions);
+	};
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TEXTUREFORMAT_H
+#define TEXTUREFORMAT_H
+
+#include "utility.h"
+
+namespace Engine::Graphics {
+	// One mip level of one layer inside a block of texture data.
+	struct ImageRegion {
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t level = 0;
+		uint32_t layer = 0;
+	};
+
+	// levels and layers packed into one buffer start on this boundary, which satisfies the
+	// copy offset rules of every format used here
+	inline VkDeviceSize alignImageRegion(VkDeviceSize offset) { return (offset + 15) & ~VkDeviceSize(15); }
+
+	// bytes per texel of the uncompressed formats textures are decoded to
+	uint32_t formatTexelSize(VkFormat format);
+
+	bool isBlockCompressed(VkFormat format);
+	// bytes per 4x4 block, or per texel for uncompressed formats
+	uint32_t formatBlockBytes(VkFormat format);
+	uint32_t formatBlockExtent(VkFormat format);
+
+	VkDeviceSize imageLevelSize(VkFormat format, uint32_t width, uint32_t height);
+	VkDeviceSize imageDataSize(VkFormat format, uint32_t width, uint32_t height, uint32_t levels);
+	uint32_t mipLevelCount(uint32_t width, uint32_t height);
+	// offsets of each level packed back to back (aligned), largest first
+	std::vector<ImageRegion> mipRegions(VkFormat format, uint32_t width, uint32_t height, uint32_t levels, uint32_t layer = 0);
+
+	// the uncompressed layout a block format is encoded from; other formats map to themselves
+	VkFormat decodeFormat(VkFormat format);
+
+	// Picks the format a texture decoded as format is stored in on the GPU: its BC
+	// counterpart when the device samples BC formats and compression is enabled in the
+	// settings, otherwise the format itself.
+	VkFormat selectTextureFormat(VkFormat format);
+	void setBlockCompressionSupport(bool supported);
+	bool blockCompressionSupported();
+}
+
+#endif
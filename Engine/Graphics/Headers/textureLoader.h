@@ -0,0 +1,113 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include "utility.h"
+#include "stagingRing.h"
+#include "mappedFile.h"
+#include "textureCache.h"
+#include "textureFormat.h"
+#include "ktxFile.h"
+#include <future>
+#include <functional>
+
+namespace Engine::Graphics {
+	class UploadBatch;
+
+	// Pixels of one image in the layout of key.format, either in a staging ring region (ready
+	// to copy to the GPU) or, when the ring had no room, in a heap block owned by pixels.
+	// regions locate each level and layer in that data. Block-compressed images and KTX2
+	// files carry their whole mip chain; other images hold level 0 and get their mips on the
+	// GPU. Images the texture cache already holds are not decoded at all and are marked resident;
+	// images found in the texture data cache are copied out of it with their mips and marked cooked.
+	struct DecodedImage {
+		std::string path;
+		TextureKey key;
+		bool resident = false;
+		bool cooked = false;
+		std::unique_ptr<stbi_uc, void(*)(void*)> pixels{ nullptr, stbi_image_free };
+		StagingAllocation staging{};
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		uint32_t levels = 1;
+		uint32_t layers = 1;
+		std::vector<ImageRegion> regions;
+		double decodeMs = 0.0;
+		std::string error;
+
+		bool isStaged() const { return staging.mapped != nullptr; }
+		bool hasMipChain() const { return levels > 1 || isBlockCompressed(key.format); }
+		const void* data() const { return isStaged() ? staging.mapped : pixels.get(); }
+	};
+
+	// Decodes every image an asset needs on the thread pool while the caller keeps working
+	// (loading the model, recording other uploads). Results are handed back in the order
+	// they were added, so uploads and descriptor bindings stay deterministic.
+	//
+	// Given an UploadBatch, files are memory-mapped, their size read from the header and
+	// the pixels decoded straight into staging memory. Staged results must be uploaded in
+	// add order before the batch stages anything else, since the ring cannot reclaim past
+	// a region that is still waiting for its upload.
+	class TextureLoadJob
+	{
+	private:
+		using FileList = std::vector<std::shared_ptr<Engine::Utility::MappedFile>>;
+
+		std::vector<std::unique_ptr<DecodedImage>> images;
+		std::vector<std::future<void>> pending;
+		VkDeviceSize stagingAlignment = 0;
+		bool stageDecodes = false;
+
+	public:
+		TextureLoadJob() = default;
+		explicit TextureLoadJob(const Engine::Graphics::UploadBatch& batch);
+		~TextureLoadJob();
+
+		TextureLoadJob(const TextureLoadJob&) = delete;
+		TextureLoadJob& operator=(const TextureLoadJob&) = delete;
+
+		// starts decoding right away unless the texture cache, or an earlier image in this
+		// job, already covers the key; returns the index to fetch the result with. A cooked
+		// copy is used instead of the source when it is up to date, and decoded sources are
+		// cooked in the background for the next run. Formats with fewer than four channels
+		// keep the leading channels of the source. The format is passed through
+		// selectTextureFormat, so it may come back block compressed. KTX2 files keep the
+		// format and mips they were stored with and ignore flip. Images that never enter the
+		// texture cache, like cubemap faces, pass shared = false so they are always decoded.
+		size_t add(const std::string& path, bool flip, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB, bool shared = true);
+
+		// packs the first channel of each source into R, G and B of one RGBA8 UNORM image (or
+		// its selected BC format), scaled to the largest source; channels without a path are
+		// filled with the default
+		size_t addPacked(const std::array<std::string, 3>& paths, const std::array<uint8_t, 3>& defaults, bool flip);
+
+		// a 1x1 image of texel's leading channels in format, which must be uncompressed
+		size_t addSolid(const std::array<uint8_t, 4>& texel, VkFormat format);
+
+		// the key addPacked files the packed image under
+		static TextureKey packedKey(const std::array<std::string, 3>& paths, const std::array<uint8_t, 3>& defaults, bool flip);
+
+		// waits for the image and throws if it failed to decode
+		DecodedImage& get(size_t index);
+
+		size_t size() const { return images.size(); }
+
+	private:
+		size_t enqueue(std::unique_ptr<DecodedImage> image, std::function<void(DecodedImage&)> work);
+		size_t addKtx(const std::string& path, bool shared);
+		std::optional<size_t> addCooked(std::unique_ptr<DecodedImage>& image, const std::vector<std::string>& sources);
+		size_t enqueueLayout(std::unique_ptr<DecodedImage> image, std::shared_ptr<Engine::Utility::MappedFile> file, const KtxImage& layout);
+		bool markResident(DecodedImage& image) const;
+		void reserveStaging(DecodedImage& image, int width, int height);
+		bool reserveStaging(DecodedImage& image, VkDeviceSize size);
+		static bool readHeader(const Engine::Utility::MappedFile& file, int& width, int& height);
+		static stbi_uc* output(DecodedImage& image, size_t size);
+		static void encode(DecodedImage& image, const stbi_uc* pixels, int width, int height);
+		static void decode(DecodedImage& image, const Engine::Utility::MappedFile& file, bool flip);
+		static void copyLayout(DecodedImage& image, const Engine::Utility::MappedFile& file, const KtxImage& layout);
+		static void cookDecoded(const DecodedImage& image, const std::vector<std::string>& sources);
+		static void decodePacked(DecodedImage& image, const std::array<std::string, 3>& paths, const FileList& files, const std::array<uint8_t, 3>& defaults, bool flip);
+	};
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef UPLOADBATCH_H
+#define UPLOADBATCH_H
+
+#include "utility.h"
+#include "stagingRing.h"
+#include "textureFormat.h"
+#include "mipGenerator.h"
+
+namespace Engine::Graphics {
+	class Device;
+	class CommandBuffer;
+
+	// Records transfers and mip generation for any number of assets into one command buffer
+	// and signals a single fence, instead of draining the queue after every step.
+	class UploadBatch
+	{
+	private:
+		VkDevice device = VK_NULL_HANDLE;
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+		VkQueue queue = VK_NULL_HANDLE;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		VkFence fence = VK_NULL_HANDLE;
+		VkDeviceSize copyAlignment = 16;
+
+		bool recording = false;
+		bool submitted = false;
+
+		std::vector<uint64_t> stagingRegions;
+		// one-off staging for data the ring had no room for, freed once the batch completes
+		std::vector<BufferResource*> stagingBuffers;
+		std::vector<MipGenerator::Dispatch> mipDispatches;
+
+	public:
+		UploadBatch() = default;
+		UploadBatch(const Engine::Graphics::Device& device, const Engine::Graphics::CommandBuffer& commandBuf);
+		~UploadBatch();
+
+		UploadBatch(const UploadBatch&) = delete;
+		UploadBatch& operator=(const UploadBatch&) = delete;
+
+		void begin(const Engine::Graphics::Device& device, const Engine::Graphics::CommandBuffer& commandBuf);
+		void submit();
+		void wait();
+		bool isComplete();
+		void flush();
+
+		StagingAllocation stage(VkDeviceSize size);
+		void uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+		// pixels point at the region's data; the region's layer is offset by baseLayer
+		void uploadImage(ImageResource* image, const void* pixels, VkFormat format, const ImageRegion& region, uint32_t baseLayer = 0);
+		// copies a region of staging filled outside the batch; the batch takes over the allocation
+		void uploadStagedImage(ImageResource* image, const StagingAllocation& staging, const ImageRegion& region, uint32_t baseLayer = 0);
+		// every region in one copy command, for images staged with their whole mip chain
+		void uploadStagedImage(ImageResource* image, const StagingAllocation& staging, const std::vector<ImageRegion>& regions, uint32_t baseLayer = 0);
+
+		void transitionImageLayout(ImageResource* image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount);
+		void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
+		void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+		// compute dispatches where the mip generator handles the image, a blit chain otherwise
+		void generateMipmaps(ImageResource* image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels, uint32_t layerCount);
+
+		VkCommandBuffer getCommandBuffer() const { return commandBuffer; }
+		VkDeviceSize getCopyAlignment() const { return copyAlignment; }
+		bool isRecording() const { return recording; }
+		bool isSubmitted() const { return submitted; }
+
+	private:
+		void start();
+		void release();
+		StagingAllocation stageBuffer(VkDeviceSize size);
+	};
+}
+
+#endif
@@ -0,0 +1,561 @@
+#include "blockCompression.h"
+#include "mipChain.h"
+#include "threadPool.h"
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FORTIFY_BC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+	// texels of one block split by channel, so four texels fill one SSE register
+	struct BlockTexels {
+		alignas(16) float c[4][16];
+	};
+
+	using Palette = float[16][4];
+
+	constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	void loadBlock(const uint8_t* rgba, BlockTexels& block)
+	{
+		for (int i = 0; i < 16; i++) {
+			for (int c = 0; c < 4; c++)
+				block.c[c][i] = static_cast<float>(rgba[i * 4 + c]);
+		}
+	}
+
+	// mean and dominant direction of the texels, by power iteration on the covariance
+	void principalAxis(const BlockTexels& block, int channels, float mean[4], float axis[4])
+	{
+		float lo[4] = {}, hi[4] = {};
+		for (int c = 0; c < 4; c++) {
+			mean[c] = 0.0f;
+			axis[c] = 0.0f;
+			if (c >= channels)
+				continue;
+
+			lo[c] = hi[c] = block.c[c][0];
+			for (int i = 0; i < 16; i++) {
+				mean[c] += block.c[c][i];
+				lo[c] = std::min(lo[c], block.c[c][i]);
+				hi[c] = std::max(hi[c], block.c[c][i]);
+			}
+			mean[c] /= 16.0f;
+		}
+
+		float covariance[4][4] = {};
+		for (int i = 0; i < 16; i++) {
+			for (int a = 0; a < channels; a++) {
+				for (int b = a; b < channels; b++)
+					covariance[a][b] += (block.c[a][i] - mean[a]) * (block.c[b][i] - mean[b]);
+			}
+		}
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < a; b++)
+				covariance[a][b] = covariance[b][a];
+		}
+
+		// the bounding box diagonal is a good start and keeps flat blocks stable
+		for (int c = 0; c < channels; c++)
+			axis[c] = hi[c] - lo[c];
+
+		for (int iteration = 0; iteration < 8; iteration++) {
+			float next[4] = {};
+			float length = 0.0f;
+			for (int a = 0; a < channels; a++) {
+				for (int b = 0; b < channels; b++)
+					next[a] += covariance[a][b] * axis[b];
+				length = std::max(length, std::abs(next[a]));
+			}
+
+			if (length < 1e-6f)
+				break;
+
+			for (int c = 0; c < channels; c++)
+				axis[c] = next[c] / length;
+		}
+
+		float length = 0.0f;
+		for (int c = 0; c < channels; c++)
+			length += axis[c] * axis[c];
+
+		length = std::sqrt(length);
+		for (int c = 0; c < channels; c++)
+			axis[c] = length > 1e-6f ? axis[c] / length : 0.0f;
+	}
+
+	// positions of the texels along axis, relative to origin
+	void project(const BlockTexels& block, int channels, const float origin[4], const float axis[4], float t[16])
+	{
+#ifdef FORTIFY_BC_SSE2
+		for (int i = 0; i < 16; i += 4) {
+			__m128 sum = _mm_setzero_ps();
+			for (int c = 0; c < channels; c++) {
+				__m128 d = _mm_sub_ps(_mm_load_ps(&block.c[c][i]), _mm_set1_ps(origin[c]));
+				sum = _mm_add_ps(sum, _mm_mul_ps(d, _mm_set1_ps(axis[c])));
+			}
+			_mm_storeu_ps(t + i, sum);
+		}
+#else
+		for (int i = 0; i < 16; i++) {
+			t[i] = 0.0f;
+			for (int c = 0; c < channels; c++)
+				t[i] += (block.c[c][i] - origin[c]) * axis[c];
+		}
+#endif
+	}
+
+	// picks the closest palette entry for every texel and returns the summed squared error
+	float fitIndices(const BlockTexels& block, int channels, const Palette& palette, int count, uint8_t indices[16])
+	{
+		float total = 0.0f;
+
+#ifdef FORTIFY_BC_SSE2
+		for (int i = 0; i < 16; i += 4) {
+			__m128 best = _mm_set1_ps(FLT_MAX);
+			__m128i bestIndex = _mm_setzero_si128();
+
+			for (int k = 0; k < count; k++) {
+				__m128 error = _mm_setzero_ps();
+				for (int c = 0; c < channels; c++) {
+					__m128 d = _mm_sub_ps(_mm_load_ps(&block.c[c][i]), _mm_set1_ps(palette[k][c]));
+					error = _mm_add_ps(error, _mm_mul_ps(d, d));
+				}
+
+				__m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, best));
+				bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(k)), _mm_andnot_si128(closer, bestIndex));
+				best = _mm_min_ps(error, best);
+			}
+
+			alignas(16) float errors[4];
+			alignas(16) int32_t chosen[4];
+			_mm_store_ps(errors, best);
+			_mm_store_si128(reinterpret_cast<__m128i*>(chosen), bestIndex);
+
+			for (int j = 0; j < 4; j++) {
+				total += errors[j];
+				indices[i + j] = static_cast<uint8_t>(chosen[j]);
+			}
+		}
+#else
+		for (int i = 0; i < 16; i++) {
+			float best = FLT_MAX;
+			for (int k = 0; k < count; k++) {
+				float error = 0.0f;
+				for (int c = 0; c < channels; c++) {
+					float d = block.c[c][i] - palette[k][c];
+					error += d * d;
+				}
+
+				if (error < best) {
+					best = error;
+					indices[i] = static_cast<uint8_t>(k);
+				}
+			}
+			total += best;
+		}
+#endif
+
+		return total;
+	}
+
+	// endpoints minimising the error for fixed interpolation weights (0 = e0, 1 = e1);
+	// returns false when every texel sits on the same weight
+	bool refineEndpoints(const BlockTexels& block, int channels, const float weights[16], float e0[4], float e1[4])
+	{
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+		float ax[4] = {}, bx[4] = {};
+
+		for (int i = 0; i < 16; i++) {
+			const float b = weights[i];
+			const float a = 1.0f - b;
+			aa += a * a;
+			bb += b * b;
+			ab += a * b;
+
+			for (int c = 0; c < channels; c++) {
+				ax[c] += a * block.c[c][i];
+				bx[c] += b * block.c[c][i];
+			}
+		}
+
+		const float det = aa * bb - ab * ab;
+		if (std::abs(det) < 1e-6f)
+			return false;
+
+		for (int c = 0; c < channels; c++) {
+			e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+			e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+		}
+
+		return true;
+	}
+
+	class BitWriter
+	{
+	private:
+		uint8_t* out;
+		uint32_t position = 0;
+
+	public:
+		BitWriter(uint8_t* out, size_t size) : out(out) { memset(out, 0, size); }
+
+		void write(uint32_t value, uint32_t bits) {
+			for (uint32_t i = 0; i < bits; i++, position++) {
+				if ((value >> i) & 1u)
+					out[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+			}
+		}
+	};
+
+	uint16_t packRGB565(const float rgb[3])
+	{
+		const uint32_t r = static_cast<uint32_t>(std::lround(std::clamp(rgb[0], 0.0f, 255.0f) * 31.0f / 255.0f));
+		const uint32_t g = static_cast<uint32_t>(std::lround(std::clamp(rgb[1], 0.0f, 255.0f) * 63.0f / 255.0f));
+		const uint32_t b = static_cast<uint32_t>(std::lround(std::clamp(rgb[2], 0.0f, 255.0f) * 31.0f / 255.0f));
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void unpackRGB565(uint16_t color, float rgb[4])
+	{
+		const uint32_t r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+		rgb[0] = static_cast<float>((r << 3) | (r >> 2));
+		rgb[1] = static_cast<float>((g << 2) | (g >> 4));
+		rgb[2] = static_cast<float>((b << 3) | (b >> 2));
+		rgb[3] = 255.0f;
+	}
+
+	void bc1Palette(uint16_t c0, uint16_t c1, Palette& palette)
+	{
+		unpackRGB565(c0, palette[0]);
+		unpackRGB565(c1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		}
+	}
+
+	struct BC7Candidate {
+		uint32_t q0[4];
+		uint32_t q1[4];
+		uint32_t p0;
+		uint32_t p1;
+		uint8_t indices[16];
+		float error = FLT_MAX;
+	};
+
+	// mode 6 endpoints are 7 bits per channel plus one shared low bit per endpoint
+	void tryBC7Endpoints(const BlockTexels& block, const float e0[4], const float e1[4], BC7Candidate& best)
+	{
+		for (uint32_t p = 0; p < 4; p++) {
+			BC7Candidate candidate{};
+			candidate.p0 = p & 1;
+			candidate.p1 = p >> 1;
+
+			float v0[4], v1[4];
+			for (int c = 0; c < 4; c++) {
+				candidate.q0[c] = static_cast<uint32_t>(std::clamp(std::lround((e0[c] - candidate.p0) * 0.5f), 0l, 127l));
+				candidate.q1[c] = static_cast<uint32_t>(std::clamp(std::lround((e1[c] - candidate.p1) * 0.5f), 0l, 127l));
+				v0[c] = static_cast<float>((candidate.q0[c] << 1) | candidate.p0);
+				v1[c] = static_cast<float>((candidate.q1[c] << 1) | candidate.p1);
+			}
+
+			Palette palette;
+			for (int k = 0; k < 16; k++) {
+				for (int c = 0; c < 4; c++)
+					palette[k][c] = std::floor(((64 - BC7_WEIGHTS[k]) * v0[c] + BC7_WEIGHTS[k] * v1[c] + 32.0f) / 64.0f);
+			}
+
+			candidate.error = fitIndices(block, 4, palette, 16, candidate.indices);
+			if (candidate.error < best.error)
+				best = candidate;
+		}
+	}
+
+	uint8_t blockMin(const uint8_t values[16])
+	{
+#ifdef FORTIFY_BC_SSE2
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+		v = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+		v = _mm_min_epu8(v, _mm_srli_si128(v, 4));
+		v = _mm_min_epu8(v, _mm_srli_si128(v, 2));
+		v = _mm_min_epu8(v, _mm_srli_si128(v, 1));
+		return static_cast<uint8_t>(_mm_cvtsi128_si32(v) & 0xFF);
+#else
+		return *std::min_element(values, values + 16);
+#endif
+	}
+
+	uint8_t blockMax(const uint8_t values[16])
+	{
+#ifdef FORTIFY_BC_SSE2
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+		v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+		v = _mm_max_epu8(v, _mm_srli_si128(v, 4));
+		v = _mm_max_epu8(v, _mm_srli_si128(v, 2));
+		v = _mm_max_epu8(v, _mm_srli_si128(v, 1));
+		return static_cast<uint8_t>(_mm_cvtsi128_si32(v) & 0xFF);
+#else
+		return *std::max_element(values, values + 16);
+#endif
+	}
+}
+
+void Engine::Graphics::BlockCompression::encodeBC1(const uint8_t* rgba, uint8_t* out)
+{
+	BlockTexels block;
+	loadBlock(rgba, block);
+
+	float mean[4], axis[4];
+	principalAxis(block, 3, mean, axis);
+
+	float t[16];
+	project(block, 3, mean, axis, t);
+	float tMin = *std::min_element(t, t + 16);
+	float tMax = *std::max_element(t, t + 16);
+
+	// pulling the ends in a little trades the extremes for the bulk of the block
+	const float inset = (tMax - tMin) / 16.0f;
+	tMin += inset;
+	tMax -= inset;
+
+	float e0[4], e1[4];
+	for (int c = 0; c < 3; c++) {
+		e0[c] = mean[c] + axis[c] * tMax;
+		e1[c] = mean[c] + axis[c] * tMin;
+	}
+
+	uint16_t c0 = packRGB565(e0);
+	uint16_t c1 = packRGB565(e1);
+
+	Palette palette;
+	uint8_t indices[16];
+	bc1Palette(c0, c1, palette);
+	float error = fitIndices(block, 3, palette, 4, indices);
+
+	static constexpr float BC1_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	float weights[16];
+	for (int i = 0; i < 16; i++)
+		weights[i] = BC1_WEIGHTS[indices[i]];
+
+	if (refineEndpoints(block, 3, weights, e0, e1)) {
+		const uint16_t r0 = packRGB565(e0);
+		const uint16_t r1 = packRGB565(e1);
+
+		Palette refined;
+		uint8_t refinedIndices[16];
+		bc1Palette(r0, r1, refined);
+		if (fitIndices(block, 3, refined, 4, refinedIndices) < error) {
+			c0 = r0;
+			c1 = r1;
+			memcpy(indices, refinedIndices, sizeof(indices));
+		}
+	}
+
+	// c0 > c1 selects the four-colour mode; equal endpoints decode every index to c0 anyway
+	static constexpr uint8_t SWAPPED[4] = { 1, 0, 3, 2 };
+	if (c0 < c1) {
+		std::swap(c0, c1);
+		for (uint8_t& index : indices)
+			index = SWAPPED[index];
+	}
+	else if (c0 == c1) {
+		memset(indices, 0, sizeof(indices));
+	}
+
+	uint32_t bits = 0;
+	for (int i = 0; i < 16; i++)
+		bits |= static_cast<uint32_t>(indices[i]) << (i * 2);
+
+	out[0] = static_cast<uint8_t>(c0 & 0xFF);
+	out[1] = static_cast<uint8_t>(c0 >> 8);
+	out[2] = static_cast<uint8_t>(c1 & 0xFF);
+	out[3] = static_cast<uint8_t>(c1 >> 8);
+	for (int i = 0; i < 4; i++)
+		out[4 + i] = static_cast<uint8_t>(bits >> (i * 8));
+}
+
+void Engine::Graphics::BlockCompression::encodeBC4(const uint8_t* rgba, int channel, uint8_t* out)
+{
+	alignas(16) uint8_t values[16];
+	for (int i = 0; i < 16; i++)
+		values[i] = rgba[i * 4 + channel];
+
+	const uint8_t r0 = blockMax(values);
+	const uint8_t r1 = blockMin(values);
+
+	out[0] = r0;
+	out[1] = r1;
+
+	uint64_t bits = 0;
+	if (r0 > r1) {
+		// eight-value mode: index 0 and 1 are the endpoints, 2..7 step from r0 towards r1
+		int palette[8] = { r0, r1 };
+		for (int k = 2; k < 8; k++)
+			palette[k] = ((8 - k) * r0 + (k - 1) * r1) / 7;
+
+		for (int i = 0; i < 16; i++) {
+			uint64_t best = 0;
+			int bestError = std::abs(values[i] - palette[0]);
+			for (int k = 1; k < 8; k++) {
+				const int error = std::abs(values[i] - palette[k]);
+				if (error < bestError) {
+					bestError = error;
+					best = k;
+				}
+			}
+			bits |= best << (i * 3);
+		}
+	}
+
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+}
+
+void Engine::Graphics::BlockCompression::encodeBC5(const uint8_t* rgba, uint8_t* out)
+{
+	encodeBC4(rgba, 0, out);
+	encodeBC4(rgba, 1, out + 8);
+}
+
+void Engine::Graphics::BlockCompression::encodeBC7(const uint8_t* rgba, uint8_t* out)
+{
+	BlockTexels block;
+	loadBlock(rgba, block);
+
+	float mean[4], axis[4];
+	principalAxis(block, 4, mean, axis);
+
+	float t[16];
+	project(block, 4, mean, axis, t);
+	const float tMin = *std::min_element(t, t + 16);
+	const float tMax = *std::max_element(t, t + 16);
+
+	float e0[4], e1[4];
+	for (int c = 0; c < 4; c++) {
+		e0[c] = std::clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+		e1[c] = std::clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+	}
+
+	BC7Candidate best;
+	tryBC7Endpoints(block, e0, e1, best);
+
+	float weights[16];
+	for (int i = 0; i < 16; i++)
+		weights[i] = BC7_WEIGHTS[best.indices[i]] / 64.0f;
+
+	if (best.error > 0.0f && refineEndpoints(block, 4, weights, e0, e1))
+		tryBC7Endpoints(block, e0, e1, best);
+
+	// the first index is stored without its top bit, so it has to be in the lower half
+	if (best.indices[0] & 8) {
+		std::swap(best.q0, best.q1);
+		std::swap(best.p0, best.p1);
+		for (uint8_t& index : best.indices)
+			index = 15 - index;
+	}
+
+	BitWriter writer(out, 16);
+	writer.write(1u << 6, 7);
+	for (int c = 0; c < 4; c++) {
+		writer.write(best.q0[c], 7);
+		writer.write(best.q1[c], 7);
+	}
+	writer.write(best.p0, 1);
+	writer.write(best.p1, 1);
+
+	writer.write(best.indices[0], 3);
+	for (int i = 1; i < 16; i++)
+		writer.write(best.indices[i], 4);
+}
+
+void Engine::Graphics::BlockCompression::encodeLevel(VkFormat format, const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* out)
+{
+	const uint32_t channels = formatTexelSize(decodeFormat(format));
+	const uint32_t blockBytes = formatBlockBytes(format);
+	const uint32_t blocksX = (width + 3) / 4;
+	const uint32_t blocksY = (height + 3) / 4;
+
+	auto encodeRows = [&](uint32_t firstRow, uint32_t lastRow) {
+		alignas(16) uint8_t rgba[64];
+
+		for (uint32_t by = firstRow; by < lastRow; by++) {
+			for (uint32_t bx = 0; bx < blocksX; bx++) {
+				// edge blocks repeat the last row and column
+				for (uint32_t i = 0; i < 16; i++) {
+					const uint32_t x = std::min(bx * 4 + (i & 3), width - 1);
+					const uint32_t y = std::min(by * 4 + (i >> 2), height - 1);
+					const uint8_t* texel = pixels + (static_cast<size_t>(y) * width + x) * channels;
+
+					for (uint32_t c = 0; c < 4; c++)
+						rgba[i * 4 + c] = c < channels ? texel[c] : (c == 3 ? 255 : 0);
+				}
+
+				uint8_t* block = out + (static_cast<size_t>(by) * blocksX + bx) * blockBytes;
+
+				switch (format) {
+					case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+					case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+					case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+					case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+						encodeBC1(rgba, block);
+						break;
+					case VK_FORMAT_BC4_UNORM_BLOCK:
+						encodeBC4(rgba, 0, block);
+						break;
+					case VK_FORMAT_BC5_UNORM_BLOCK:
+						encodeBC5(rgba, block);
+						break;
+					case VK_FORMAT_BC7_UNORM_BLOCK:
+					case VK_FORMAT_BC7_SRGB_BLOCK:
+						encodeBC7(rgba, block);
+						break;
+					default:
+						throw std::runtime_error("no encoder for texture format " + std::to_string(format));
+				}
+			}
+		}
+	};
+
+	if (!threadPool) {
+		encodeRows(0, blocksY);
+		return;
+	}
+
+	const size_t chunks = threadPool->chunkCount(blocksY, 4);
+	const uint32_t rowsPerChunk = static_cast<uint32_t>((blocksY + chunks - 1) / chunks);
+
+	threadPool->parallelFor(chunks, [&](size_t chunk) {
+		const uint32_t first = static_cast<uint32_t>(chunk) * rowsPerChunk;
+		encodeRows(first, std::min(first + rowsPerChunk, blocksY));
+	});
+}
+
+std::vector<Engine::Graphics::ImageRegion> Engine::Graphics::BlockCompression::encodeMipChain(VkFormat format, const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* out)
+{
+	const VkFormat pixelFormat = decodeFormat(format);
+	const uint32_t channels = formatTexelSize(pixelFormat);
+	std::vector<ImageRegion> regions = mipRegions(format, width, height, mipLevelCount(width, height));
+
+	std::vector<uint8_t> current, next;
+	const uint8_t* level = pixels;
+
+	for (size_t i = 0; i < regions.size(); i++) {
+		const ImageRegion& region = regions[i];
+		encodeLevel(format, level, region.width, region.height, out + region.offset);
+
+		if (i + 1 == regions.size())
+			break;
+
+		next.resize(static_cast<size_t>(regions[i + 1].width) * regions[i + 1].height * channels);
+		MipChain::downsample(pixelFormat, level, region.width, region.height, next.data());
+
+		current.swap(next);
+		level = current.data();
+	}
+
+	return regions;
+}
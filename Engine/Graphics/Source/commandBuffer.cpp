@@ -76,6 +76,28 @@ void Engine::Graphics::CommandBuffer::createCommandBuffers(VkDevice device)
 void Engine::Graphics::CommandBuffer::transitionImageLayout(const Engine::Graphics::Device& device, ImageResource* image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount) {
     VkCommandBuffer commandBuffer = beginSingleTimeCommands(device.getDevice());
 
+    recordTransitionImageLayout(commandBuffer, image, format, oldLayout, newLayout, mipLevels, layerCount);
+
+    endSingleTimeCommands(commandBuffer, device.getGraphicsQueue(), device.getDevice());
+}
+
+void Engine::Graphics::CommandBuffer::copyBufferToImage(const Engine::Graphics::Device& device, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount) {
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands(device.getDevice());
+
+    recordCopyBufferToImage(commandBuffer, buffer, image, width, height, layerCount);
+
+    endSingleTimeCommands(commandBuffer, device.getGraphicsQueue(), device.getDevice());
+}
+
+void Engine::Graphics::CommandBuffer::copyBuffer(const Engine::Graphics::Device& device, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+    VkCommandBuffer commandBuffer = beginSingleTimeCommands(device.getDevice());
+
+    recordCopyBuffer(commandBuffer, srcBuffer, dstBuffer, size);
+
+    endSingleTimeCommands(commandBuffer, device.getGraphicsQueue(), device.getDevice());
+}
+
+void Engine::Graphics::CommandBuffer::recordTransitionImageLayout(VkCommandBuffer commandBuffer, ImageResource* image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount) {
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = oldLayout;
@@ -138,13 +160,9 @@ void Engine::Graphics::CommandBuffer::transitionImageLayout(const Engine::Graphi
     );
 
     image->updateLayout(newLayout);
-
-    endSingleTimeCommands(commandBuffer, device.getGraphicsQueue(), device.getDevice());
 }
 
-void Engine::Graphics::CommandBuffer::copyBufferToImage(const Engine::Graphics::Device& device, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount) {
-    VkCommandBuffer commandBuffer = beginSingleTimeCommands(device.getDevice());
-
+void Engine::Graphics::CommandBuffer::recordCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount) {
     VkDeviceSize layerSize = width * height * 4;
 
     for(uint32_t i = 0; i < layerCount; i++)
@@ -164,16 +182,10 @@ void Engine::Graphics::CommandBuffer::copyBufferToImage(const Engine::Graphics::
 
         vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
     }
-
-    endSingleTimeCommands(commandBuffer, device.getGraphicsQueue(), device.getDevice());
 }
 
-void Engine::Graphics::CommandBuffer::copyBuffer(const Engine::Graphics::Device& device, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-    VkCommandBuffer commandBuffer = beginSingleTimeCommands(device.getDevice());
-
+void Engine::Graphics::CommandBuffer::recordCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
     VkBufferCopy copyRegion{};
 	copyRegion.size = size;
 	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-    endSingleTimeCommands(commandBuffer, device.getGraphicsQueue(), device.getDevice());
 }
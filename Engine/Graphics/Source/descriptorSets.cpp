@@ -9,7 +9,7 @@ void Engine::Graphics::DescriptorSets::createDescriptorPool(VkDevice device)
     poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     poolSizes[0].descriptorCount = static_cast<uint32_t>(Engine::Settings::MAX_FRAMES_IN_FLIGHT);
     poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = static_cast<uint32_t>(Engine::Settings::MAX_FRAMES_IN_FLIGHT) * 5;
+    poolSizes[1].descriptorCount = static_cast<uint32_t>(Engine::Settings::MAX_FRAMES_IN_FLIGHT) * PBR_TEXTURE_BINDINGS;
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -22,7 +22,7 @@ void Engine::Graphics::DescriptorSets::createDescriptorPool(VkDevice device)
     }
 }
 
-void Engine::Graphics::DescriptorSets::createDescriptorSets(VkDevice device, Engine::Graphics::Texture texture, VkDescriptorSetLayout descriptorSetLayout, bool isCube, std::unordered_map<PBRTextureType, std::string> texturePaths, bool hasTexture)
+void Engine::Graphics::DescriptorSets::createDescriptorSets(VkDevice device, const Engine::Graphics::Texture& texture, const std::vector<BufferResource*>& sceneBuffers, VkDescriptorSetLayout descriptorSetLayout, bool hasTexture, std::span<const PBRTextureType> textureSlots)
 {
     std::vector<VkDescriptorSetLayout> layouts(Engine::Settings::MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
     VkDescriptorSetAllocateInfo allocInfo{};
@@ -40,18 +40,11 @@ void Engine::Graphics::DescriptorSets::createDescriptorSets(VkDevice device, Eng
 
     for (size_t i = 0; i < Engine::Settings::MAX_FRAMES_IN_FLIGHT; i++) {
         VkDescriptorBufferInfo bufferInfo{};
-        if (isCube) {
-            bufferInfo.buffer = texture.skyboxUniformResources[i]->buffer;
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(SkyboxUBO);
-        }
-        else {
-            bufferInfo.buffer = texture.uniformResources[i]->buffer;
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(UniformBufferObject);
-        }
+        bufferInfo.buffer = sceneBuffers[i]->buffer;
+        bufferInfo.offset = 0;
+        bufferInfo.range = sizeof(SceneUBO);
 
-        std::vector<VkDescriptorImageInfo> imageInfos(texturePaths.size());
+        std::vector<VkDescriptorImageInfo> imageInfos;
         VkDescriptorImageInfo imageInfo{};
         
         if (hasTexture) {
@@ -62,17 +55,20 @@ void Engine::Graphics::DescriptorSets::createDescriptorSets(VkDevice device, Eng
                 imageInfos.push_back(imageInfo);
             }
             else {
-                int index = 0;
-                for (auto& texturePair : texturePaths) {
-                    PBRTextureType textureType = texturePair.first;
-                    const std::string& texturePath = texturePair.second;
+                // imageInfos is indexed by slot in PBR_UPLOAD_ORDER. Every material fills all of its
+                // slots, so the first texture of a slot is the first material's and later ones are
+                // never mixed in.
+                for (PBRTextureType type : PBR_UPLOAD_ORDER) {
+                    auto slot = std::find(textureSlots.begin(), textureSlots.end(), type);
+                    if (slot == textureSlots.end() || slot - textureSlots.begin() >= textureCount)
+                        throw std::runtime_error("PBR texture slot " + std::to_string(static_cast<int>(type)) + " has no texture!");
 
+                    const ImageResource* image = texture.textureResources[slot - textureSlots.begin()];
                     imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                    imageInfo.imageView = texture.textureResources[index]->view;
-                    imageInfo.sampler = texture.textureResources[index]->sampler;
+                    imageInfo.imageView = image->view;
+                    imageInfo.sampler = image->sampler;
 
-                    imageInfos[index] = (imageInfo);
-                    index++;
+                    imageInfos.push_back(imageInfo);
                 }
             }
         }
@@ -103,6 +99,7 @@ void Engine::Graphics::DescriptorSets::createDescriptorSets(VkDevice device, Eng
                 descriptorWrites.push_back(imageWrite);
             }
             else {
+                // binding 1 onwards, one per slot
                 for (uint32_t j = 0; j < imageInfos.size(); j++) {
                     VkWriteDescriptorSet imageWrite{};
                     imageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -1,6 +1,7 @@
 #include "device.h"
 #include "instance.h"
 #include "swapchain.h"
+#include "textureFormat.h"
 
 Engine::Graphics::Device::~Device()
 {
@@ -110,8 +111,16 @@ void Engine::Graphics::Device::createLogicalDevice(VkSurfaceKHR surface)
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
     VkPhysicalDeviceFeatures vkFeatures{};
     vkFeatures.samplerAnisotropy = VK_TRUE;
+    // textures fall back to uncompressed formats without it
+    vkFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    // the compute mip generator checks these and falls back to blits without them
+    vkFeatures.shaderStorageImageArrayDynamicIndexing = supportedFeatures.shaderStorageImageArrayDynamicIndexing;
+    vkFeatures.shaderStorageImageExtendedFormats = supportedFeatures.shaderStorageImageExtendedFormats;
 
     // Vulkan 1.2 promoted features
     VkPhysicalDeviceAccelerationStructureFeaturesKHR accelFeatures{};
@@ -157,6 +166,8 @@ void Engine::Graphics::Device::createLogicalDevice(VkSurfaceKHR surface)
         throw std::runtime_error("failed to create logical device!");
     }
 
+    Engine::Graphics::setBlockCompressionSupport(vkFeatures.textureCompressionBC == VK_TRUE);
+
     vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
     graphicsQueueFamilyIndex = indices.graphicsFamily.value();
     vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
@@ -0,0 +1,119 @@
+#include "ktxFile.h"
+
+namespace {
+	constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+	constexpr size_t KTX2_HEADER_SIZE = 80;
+	constexpr size_t KTX2_LEVEL_ENTRY_SIZE = 24;
+
+	template<typename T>
+	T readValue(const uint8_t* bytes, size_t offset)
+	{
+		T value;
+		memcpy(&value, bytes + offset, sizeof(T));
+		return value;
+	}
+}
+
+VkDeviceSize Engine::Graphics::KtxImage::dataSize() const
+{
+	VkDeviceSize size = 0;
+	for (const auto& region : regions)
+		size = alignImageRegion(size) + region.size;
+
+	return size;
+}
+
+bool Engine::Graphics::KtxFile::isKtx2(const std::string& path)
+{
+	std::string extension = std::filesystem::path(path).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	return extension == ".ktx2";
+}
+
+bool Engine::Graphics::KtxFile::isSupportedFormat(VkFormat format)
+{
+	switch (format) {
+		case VK_FORMAT_R8_UNORM:
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return true;
+		default:
+			return isBlockCompressed(format);
+	}
+}
+
+bool Engine::Graphics::KtxFile::read(const void* data, size_t size, KtxImage& image, std::string& error)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+	if (size < KTX2_HEADER_SIZE || memcmp(bytes, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+		error = "not a KTX2 file";
+		return false;
+	}
+
+	const VkFormat format = static_cast<VkFormat>(readValue<uint32_t>(bytes, 12));
+	const uint32_t width = readValue<uint32_t>(bytes, 20);
+	const uint32_t height = readValue<uint32_t>(bytes, 24);
+	const uint32_t depth = readValue<uint32_t>(bytes, 28);
+	const uint32_t layerCount = readValue<uint32_t>(bytes, 32);
+	const uint32_t faceCount = readValue<uint32_t>(bytes, 36);
+	const uint32_t levelCount = readValue<uint32_t>(bytes, 40);
+	const uint32_t supercompression = readValue<uint32_t>(bytes, 44);
+
+	if (!isSupportedFormat(format)) {
+		error = "unsupported KTX2 format " + std::to_string(format);
+		return false;
+	}
+	if (supercompression != 0) {
+		error = "supercompressed KTX2 files are not supported";
+		return false;
+	}
+	if (width == 0 || height == 0 || depth > 1 || (faceCount != 1 && faceCount != 6)) {
+		error = "only 2D textures, arrays and cubemaps are supported";
+		return false;
+	}
+
+	// a level count of 0 asks the loader to generate the mips
+	const uint32_t levels = std::max(levelCount, 1u);
+	if (levels > mipLevelCount(width, height) || size < KTX2_HEADER_SIZE + levels * KTX2_LEVEL_ENTRY_SIZE) {
+		error = "corrupt KTX2 level index";
+		return false;
+	}
+
+	image = {};
+	image.format = format;
+	image.width = width;
+	image.height = height;
+	image.levels = levels;
+	image.layers = std::max(layerCount, 1u) * faceCount;
+
+	for (uint32_t level = 0; level < levels; level++) {
+		const size_t entry = KTX2_HEADER_SIZE + level * KTX2_LEVEL_ENTRY_SIZE;
+		const uint64_t byteOffset = readValue<uint64_t>(bytes, entry);
+		const uint64_t byteLength = readValue<uint64_t>(bytes, entry + 8);
+
+		const uint32_t levelWidth = std::max(width >> level, 1u);
+		const uint32_t levelHeight = std::max(height >> level, 1u);
+		const VkDeviceSize layerSize = imageLevelSize(format, levelWidth, levelHeight);
+
+		if (byteLength < layerSize * image.layers || byteOffset > size || byteLength > size - byteOffset) {
+			error = "KTX2 level " + std::to_string(level) + " is out of bounds";
+			return false;
+		}
+
+		for (uint32_t layer = 0; layer < image.layers; layer++) {
+			ImageRegion region{};
+			region.offset = byteOffset + layerSize * layer;
+			region.size = layerSize;
+			region.width = levelWidth;
+			region.height = levelHeight;
+			region.level = level;
+			region.layer = layer;
+			image.regions.push_back(region);
+		}
+	}
+
+	return true;
+}
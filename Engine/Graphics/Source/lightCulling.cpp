@@ -0,0 +1,187 @@
+#include "lightCulling.h"
+#include "device.h"
+#include "pipeline.h"
+#include "pipelineCache.h"
+
+void Engine::Graphics::LightCulling::create(const Engine::Graphics::Device& device, VkDescriptorSetLayout setLayout, const std::vector<BufferResource*>& sceneBuffers, const std::string& shaderPath)
+{
+	this->device = device.getDevice();
+	this->physicalDevice = device.getPhysicalDevice();
+
+	const size_t frames = Engine::Settings::MAX_FRAMES_IN_FLIGHT;
+
+	lightResources.resize(frames);
+	lightCapacity.assign(frames, INITIAL_LIGHT_CAPACITY);
+	clusterCountResources.resize(frames);
+	clusterIndexResources.resize(frames);
+
+	for (size_t i = 0; i < frames; i++) {
+		lightResources[i] = resources->create<BufferResource>(this->device, physicalDevice, sizeof(LightBuffer) * INITIAL_LIGHT_CAPACITY, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		clusterCountResources[i] = resources->create<BufferResource>(this->device, physicalDevice, sizeof(uint32_t) * CLUSTER_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		clusterIndexResources[i] = resources->create<BufferResource>(this->device, physicalDevice, sizeof(uint32_t) * CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	}
+
+	std::array<VkDescriptorPoolSize, 2> poolSizes{};
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSizes[0].descriptorCount = static_cast<uint32_t>(frames) * 3;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSizes[1].descriptorCount = static_cast<uint32_t>(frames);
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolInfo.maxSets = static_cast<uint32_t>(frames);
+
+	if (vkCreateDescriptorPool(this->device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+		throw std::runtime_error("failed to create light culling descriptor pool");
+
+	std::vector<VkDescriptorSetLayout> layouts(frames, setLayout);
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = descriptorPool;
+	allocInfo.descriptorSetCount = static_cast<uint32_t>(frames);
+	allocInfo.pSetLayouts = layouts.data();
+
+	descriptorSets.resize(frames);
+	if (vkAllocateDescriptorSets(this->device, &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+		throw std::runtime_error("failed to allocate light culling descriptor sets");
+
+	for (uint32_t i = 0; i < frames; i++) {
+		std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+		bufferInfos[0] = { clusterCountResources[i]->buffer, 0, VK_WHOLE_SIZE };
+		bufferInfos[1] = { clusterIndexResources[i]->buffer, 0, VK_WHOLE_SIZE };
+		bufferInfos[2] = { sceneBuffers[i]->buffer, 0, sizeof(SceneUBO) };
+
+		std::array<VkWriteDescriptorSet, 3> writes{};
+		for (uint32_t j = 0; j < writes.size(); j++) {
+			writes[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[j].dstSet = descriptorSets[i];
+			writes[j].dstBinding = j + 1;
+			writes[j].descriptorCount = 1;
+			writes[j].descriptorType = j == 2 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writes[j].pBufferInfo = &bufferInfos[j];
+		}
+
+		vkUpdateDescriptorSets(this->device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+		writeLightDescriptor(i);
+	}
+
+	VkPipelineLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutInfo.setLayoutCount = 1;
+	layoutInfo.pSetLayouts = &setLayout;
+
+	if (vkCreatePipelineLayout(this->device, &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+		throw std::runtime_error("failed to create light culling pipeline layout");
+
+	auto shaderCode = Engine::Graphics::Pipeline::readFile(shaderPath);
+	VkShaderModule shaderModule = Engine::Graphics::Pipeline::createShaderModule(this->device, shaderCode);
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = shaderModule;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = pipelineLayout;
+
+	VkResult result = vkCreateComputePipelines(this->device, pipelineCache ? pipelineCache->get() : VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+	vkDestroyShaderModule(this->device, shaderModule, nullptr);
+
+	if (result != VK_SUCCESS)
+		throw std::runtime_error("failed to create light culling pipeline");
+}
+
+void Engine::Graphics::LightCulling::destroy()
+{
+	if (device == VK_NULL_HANDLE)
+		return;
+
+	resources->defer([pipeline = pipeline, layout = pipelineLayout, pool = descriptorPool](VkDevice device) {
+		vkDestroyPipeline(device, pipeline, nullptr);
+		vkDestroyPipelineLayout(device, layout, nullptr);
+		vkDestroyDescriptorPool(device, pool, nullptr);
+	});
+
+	for (size_t i = 0; i < lightResources.size(); i++) {
+		resources->destroy(lightResources[i]);
+		resources->destroy(clusterCountResources[i]);
+		resources->destroy(clusterIndexResources[i]);
+	}
+
+	lightResources.clear();
+	lightCapacity.clear();
+	clusterCountResources.clear();
+	clusterIndexResources.clear();
+	descriptorSets.clear();
+
+	pipeline = VK_NULL_HANDLE;
+	pipelineLayout = VK_NULL_HANDLE;
+	descriptorPool = VK_NULL_HANDLE;
+	device = VK_NULL_HANDLE;
+}
+
+void Engine::Graphics::LightCulling::updateLights(uint32_t currentFrame, const std::vector<LightBuffer>& lights)
+{
+	if (lights.size() > lightCapacity[currentFrame]) {
+		uint32_t capacity = std::max(static_cast<uint32_t>(lights.size()), lightCapacity[currentFrame] * 2);
+
+		resources->destroy(lightResources[currentFrame]);
+		lightResources[currentFrame] = resources->create<BufferResource>(device, physicalDevice, sizeof(LightBuffer) * capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		lightCapacity[currentFrame] = capacity;
+
+		writeLightDescriptor(currentFrame);
+	}
+
+	if (!lights.empty())
+		memcpy(lightResources[currentFrame]->mapped, lights.data(), sizeof(LightBuffer) * lights.size());
+}
+
+void Engine::Graphics::LightCulling::record(VkCommandBuffer commandBuffer, uint32_t currentFrame) const
+{
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
+	vkCmdDispatch(commandBuffer, (CLUSTER_COUNT + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		1, &barrier,
+		0, nullptr,
+		0, nullptr
+	);
+}
+
+float Engine::Graphics::LightCulling::lightRadius(const glm::vec3& color)
+{
+	// distance at which the attenuated contribution drops below one 8-bit step
+	float intensity = std::max(std::max(color.r, color.g), color.b) * 256.0f;
+	if (intensity <= 1.0f)
+		return 0.0f;
+
+	float c = 1.0f - intensity;
+	return (-ATTENUATION_LINEAR + std::sqrt(ATTENUATION_LINEAR * ATTENUATION_LINEAR - 4.0f * ATTENUATION_QUADRATIC * c)) / (2.0f * ATTENUATION_QUADRATIC);
+}
+
+void Engine::Graphics::LightCulling::writeLightDescriptor(uint32_t frame)
+{
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = lightResources[frame]->buffer;
+	bufferInfo.offset = 0;
+	bufferInfo.range = VK_WHOLE_SIZE;
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = descriptorSets[frame];
+	write.dstBinding = 0;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.pBufferInfo = &bufferInfo;
+
+	vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
@@ -0,0 +1,188 @@
+#include "meshBuilder.h"
+#include "threadPool.h"
+
+namespace {
+	template<typename F>
+	void runChunks(size_t chunks, F&& body)
+	{
+		if (threadPool) {
+			threadPool->parallelFor(chunks, std::forward<F>(body));
+			return;
+		}
+
+		for (size_t chunk = 0; chunk < chunks; chunk++)
+			body(chunk);
+	}
+
+	size_t partitionOf(const Vertex& vertex, size_t partitions)
+	{
+		// high bits pick the partition; the per-partition table re-mixes the full hash
+		return static_cast<size_t>((Engine::Utility::hashVertex(vertex) >> 32) % partitions);
+	}
+}
+
+Engine::Graphics::MeshSource Engine::Graphics::MeshSource::fromObj(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes)
+{
+	MeshSource source;
+	source.positions = attrib.vertices;
+	source.normals = attrib.normals;
+	source.texcoords = attrib.texcoords;
+
+	source.indexRanges.reserve(shapes.size());
+	for (const auto& shape : shapes)
+		source.indexRanges.emplace_back(shape.mesh.indices);
+
+	return source;
+}
+
+Vertex Engine::Graphics::MeshBuilder::makeVertex(const MeshSource& source, const tinyobj::index_t& index)
+{
+	Vertex vertex{};
+
+	vertex.pos = {
+		source.positions[3 * index.vertex_index + 0],
+		source.positions[3 * index.vertex_index + 1],
+		source.positions[3 * index.vertex_index + 2]
+	};
+
+	if (index.texcoord_index >= 0) {
+		vertex.texCoord = {
+			source.texcoords[2 * index.texcoord_index + 0],
+			1.0f - source.texcoords[2 * index.texcoord_index + 1],
+		};
+	}
+	else {
+		vertex.texCoord = { 0.0f, 0.0f };
+	}
+
+	if (index.normal_index >= 0) {
+		vertex.normal = {
+			source.normals[3 * index.normal_index + 0],
+			source.normals[3 * index.normal_index + 1],
+			source.normals[3 * index.normal_index + 2]
+		};
+	}
+	else {
+		vertex.normal = { 0.0, 1.0, 0.0 };
+	}
+
+	return vertex;
+}
+
+void Engine::Graphics::MeshBuilder::build(const MeshSource& source, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<tinyobj::index_t> flattened;
+	std::span<const tinyobj::index_t> corners;
+
+	if (source.indexRanges.size() == 1) {
+		corners = source.indexRanges.front();
+	}
+	else {
+		size_t total = 0;
+		for (const auto& range : source.indexRanges)
+			total += range.size();
+
+		flattened.reserve(total);
+		for (const auto& range : source.indexRanges)
+			flattened.insert(flattened.end(), range.begin(), range.end());
+
+		corners = flattened;
+	}
+
+	const size_t cornerCount = corners.size();
+	if (cornerCount == 0)
+		return;
+
+	const size_t baseVertex = vertices.size();
+	const size_t baseIndex = indices.size();
+
+	if (baseVertex + cornerCount > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error("mesh has too many vertices for 32-bit indices");
+
+	const size_t chunks = threadPool ? threadPool->chunkCount(cornerCount, MIN_CHUNK_SIZE) : 1;
+	const size_t chunkSize = (cornerCount + chunks - 1) / chunks;
+	const size_t partitions = chunks;
+
+	auto chunkBegin = [&](size_t chunk) { return std::min(cornerCount, chunk * chunkSize); };
+	auto chunkEnd = [&](size_t chunk) { return std::min(cornerCount, (chunk + 1) * chunkSize); };
+
+	// 1. bucket every corner by the hash of its vertex; each bucket stays in corner order
+	std::vector<std::vector<std::vector<uint32_t>>> buckets(chunks, std::vector<std::vector<uint32_t>>(partitions));
+
+	runChunks(chunks, [&](size_t chunk) {
+		auto& local = buckets[chunk];
+		size_t end = chunkEnd(chunk);
+
+		for (auto& bucket : local)
+			bucket.reserve((end - chunkBegin(chunk)) / partitions + 1);
+
+		for (size_t i = chunkBegin(chunk); i < end; i++)
+			local[partitionOf(makeVertex(source, corners[i]), partitions)].push_back(static_cast<uint32_t>(i));
+	});
+
+	// 2. dedup each partition independently; walking chunks in order visits corners in
+	// ascending order, so the first corner seen for a vertex is its global first occurrence
+	std::vector<uint32_t> firstCorner(cornerCount);
+
+	runChunks(partitions, [&](size_t partition) {
+		size_t expected = 0;
+		for (size_t chunk = 0; chunk < chunks; chunk++)
+			expected += buckets[chunk][partition].size();
+
+		Engine::Utility::FlatHashMap<Vertex, uint32_t> unique;
+		unique.reserve(expected / 2);
+
+		for (size_t chunk = 0; chunk < chunks; chunk++) {
+			for (uint32_t i : buckets[chunk][partition]) {
+				auto [it, inserted] = unique.try_emplace(makeVertex(source, corners[i]), i);
+				firstCorner[i] = it->second;
+			}
+
+			std::vector<uint32_t>().swap(buckets[chunk][partition]);
+		}
+	});
+
+	buckets.clear();
+
+	// 3. number the first occurrences in corner order and emit them
+	std::vector<size_t> uniqueBase(chunks + 1, 0);
+
+	runChunks(chunks, [&](size_t chunk) {
+		size_t count = 0;
+		for (size_t i = chunkBegin(chunk); i < chunkEnd(chunk); i++)
+			count += firstCorner[i] == i;
+		uniqueBase[chunk + 1] = count;
+	});
+
+	for (size_t chunk = 0; chunk < chunks; chunk++)
+		uniqueBase[chunk + 1] += uniqueBase[chunk];
+
+	vertices.resize(baseVertex + uniqueBase[chunks]);
+	indices.resize(baseIndex + cornerCount);
+
+	runChunks(chunks, [&](size_t chunk) {
+		size_t next = baseVertex + uniqueBase[chunk];
+
+		for (size_t i = chunkBegin(chunk); i < chunkEnd(chunk); i++) {
+			if (firstCorner[i] != i)
+				continue;
+
+			vertices[next] = makeVertex(source, corners[i]);
+			indices[baseIndex + i] = static_cast<uint32_t>(next);
+			next++;
+		}
+	});
+
+	// 4. every other corner copies the index assigned to its first occurrence
+	runChunks(chunks, [&](size_t chunk) {
+		for (size_t i = chunkBegin(chunk); i < chunkEnd(chunk); i++) {
+			if (firstCorner[i] != i)
+				indices[baseIndex + i] = indices[baseIndex + firstCorner[i]];
+		}
+	});
+
+	double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	g_console.add("[Mesh Builder] %zu indices -> %zu vertices in %.1f ms (%zu chunks)\n", cornerCount, vertices.size() - baseVertex, elapsed, chunks);
+}
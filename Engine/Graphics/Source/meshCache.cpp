@@ -0,0 +1,395 @@
+#include "meshCache.h"
+#include "meshBuilder.h"
+#include "objLoader.h"
+#include "mappedFile.h"
+#include "threadPool.h"
+
+namespace {
+	size_t alignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	template<typename T>
+	void writeValue(std::vector<char>& out, const T& value)
+	{
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		out.insert(out.end(), bytes, bytes + sizeof(value));
+	}
+
+	void writeString(std::vector<char>& out, const std::string& value)
+	{
+		writeValue(out, static_cast<uint32_t>(value.size()));
+		out.insert(out.end(), value.begin(), value.end());
+	}
+
+	bool readString(const char*& p, const char* end, std::string& value)
+	{
+		uint32_t length;
+		if (static_cast<size_t>(end - p) < sizeof(length))
+			return false;
+
+		memcpy(&length, p, sizeof(length));
+		p += sizeof(length);
+
+		if (static_cast<size_t>(end - p) < length)
+			return false;
+
+		value.assign(p, length);
+		p += length;
+		return true;
+	}
+
+	constexpr std::string Materials::* MATERIAL_FIELDS[] = {
+		&Materials::name,
+		&Materials::diffusePath,
+		&Materials::normalPath,
+		&Materials::roughnessPath,
+		&Materials::metalnessPath,
+		&Materials::aoPath,
+		&Materials::specularPath,
+	};
+}
+
+Engine::Graphics::MeshBounds Engine::Graphics::MeshCache::loadObj(const std::string& modelPath, const std::optional<std::string>& materialDir, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<Materials>* materials)
+{
+	auto start = std::chrono::steady_clock::now();
+	std::string path = cachePath(modelPath);
+
+	MeshBounds bounds;
+	size_t baseVertex = vertices.size();
+	size_t baseIndex = indices.size();
+
+	if (read(path, materialDir, vertices, indices, materialDir ? materials : nullptr, bounds)) {
+		double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		g_console.add("[Mesh Cache] %s: %zu vertices, %zu indices from %s in %.1f ms\n", modelPath.c_str(), vertices.size() - baseVertex, indices.size() - baseIndex, path.c_str(), elapsed);
+		return bounds;
+	}
+
+	std::vector<Vertex> cookedVertices;
+	std::vector<uint32_t> cookedIndices;
+	std::vector<Materials> cookedMaterials;
+	bounds = cook(modelPath, materialDir, cookedVertices, cookedIndices, cookedMaterials);
+
+	if (baseVertex + cookedVertices.size() > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error("mesh has too many vertices for 32-bit indices");
+
+	vertices.insert(vertices.end(), cookedVertices.begin(), cookedVertices.end());
+	indices.reserve(baseIndex + cookedIndices.size());
+	for (uint32_t index : cookedIndices)
+		indices.push_back(static_cast<uint32_t>(baseVertex + index));
+
+	if (materials && materialDir)
+		materials->insert(materials->end(), cookedMaterials.begin(), cookedMaterials.end());
+
+	return bounds;
+}
+
+Engine::Graphics::MeshBounds Engine::Graphics::MeshCache::cook(const std::string& modelPath, const std::optional<std::string>& materialDir, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<Materials>& materials)
+{
+	ObjMesh mesh = ObjLoader::load(modelPath, materialDir);
+
+	vertices.clear();
+	indices.clear();
+	MeshBuilder::build(mesh.source(), vertices, indices);
+
+	MeshBounds bounds;
+	if (!vertices.empty()) {
+		bounds.min = bounds.max = vertices.front().pos;
+		for (const Vertex& vertex : vertices) {
+			bounds.min = glm::min(bounds.min, vertex.pos);
+			bounds.max = glm::max(bounds.max, vertex.pos);
+		}
+	}
+
+	std::vector<std::string> sources = { modelPath };
+	sources.insert(sources.end(), mesh.materialLibraries.begin(), mesh.materialLibraries.end());
+	write(cachePath(modelPath), sources, materialDir, vertices, indices, mesh.materials, bounds);
+
+	materials = std::move(mesh.materials);
+	return bounds;
+}
+
+uint64_t Engine::Graphics::MeshCache::hashFile(const char* data, size_t size)
+{
+	// fixed block size so the result does not depend on the thread count
+	size_t blocks = std::max<size_t>(1, (size + HASH_BLOCK_SIZE - 1) / HASH_BLOCK_SIZE);
+	std::vector<uint64_t> blockHashes(blocks);
+
+	auto hashBlock = [&](size_t block) {
+		size_t begin = block * HASH_BLOCK_SIZE;
+		size_t length = std::min(HASH_BLOCK_SIZE, size - std::min(size, begin));
+		blockHashes[block] = Engine::Utility::hashBytes(data + begin, length, block);
+	};
+
+	if (threadPool && blocks > 1)
+		threadPool->parallelFor(blocks, hashBlock);
+	else
+		for (size_t block = 0; block < blocks; block++)
+			hashBlock(block);
+
+	return Engine::Utility::hashBytes(blockHashes.data(), blockHashes.size() * sizeof(uint64_t), size);
+}
+
+std::string Engine::Graphics::MeshCache::cachePath(const std::string& modelPath)
+{
+	std::error_code ec;
+	std::filesystem::path source = std::filesystem::weakly_canonical(modelPath, ec);
+	if (ec)
+		source = std::filesystem::path(modelPath).lexically_normal();
+
+	std::string key = source.generic_string();
+
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(Engine::Utility::hashBytes(key.data(), key.size())));
+
+	std::filesystem::path path(DEFAULT_DIRECTORY);
+	path /= source.stem().string() + "-" + name + ".fmesh";
+	return path.string();
+}
+
+Engine::Graphics::MeshCache::SourceInfo Engine::Graphics::MeshCache::sourceInfo(const std::string& sourcePath)
+{
+	SourceInfo info;
+	std::error_code ec;
+
+	auto size = std::filesystem::file_size(sourcePath, ec);
+	if (ec)
+		return info;
+
+	auto time = std::filesystem::last_write_time(sourcePath, ec);
+	if (ec)
+		return info;
+
+	info.size = static_cast<uint64_t>(size);
+	info.time = static_cast<int64_t>(time.time_since_epoch().count());
+	info.exists = true;
+	return info;
+}
+
+std::string Engine::Graphics::MeshCache::materialKey(const std::string& materialDir)
+{
+	return std::filesystem::path(materialDir).lexically_normal().generic_string();
+}
+
+uint64_t Engine::Graphics::MeshCache::hashSource(const std::string& sourcePath)
+{
+	// the loose file, the same one sourceInfo stamps
+	Engine::Utility::MappedFile source;
+	if (!source.openFile(sourcePath))
+		return 0;
+
+	return hashFile(source.data(), source.size());
+}
+
+bool Engine::Graphics::MeshCache::read(const std::string& path, const std::optional<std::string>& materialDir, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<Materials>* materials, MeshBounds& bounds)
+{
+	// a loose copy is the freshest cook, the pack's is only used when there is none
+	Engine::Utility::MappedFile file;
+	if (!(file.openFile(path) || file.open(path)) || file.size() < sizeof(FileHeader))
+		return false;
+
+	FileHeader header{};
+	memcpy(&header, file.data(), sizeof(header));
+
+	if (header.magic != MAGIC || header.version != VERSION || header.vertexStride != sizeof(Vertex))
+		return false;
+
+	const uint64_t fileSize = file.size();
+	const uint64_t maxCount = fileSize / sizeof(uint32_t);
+	if (header.vertexCount > maxCount || header.indexCount > maxCount ||
+		header.sourceOffset > fileSize || header.sourceTableSize > fileSize - header.sourceOffset ||
+		header.materialOffset > fileSize || header.materialSize > fileSize - header.materialOffset ||
+		header.vertexOffset > fileSize || header.vertexCount * sizeof(Vertex) > fileSize - header.vertexOffset ||
+		header.indexOffset > fileSize || header.indexCount * sizeof(uint32_t) > fileSize - header.indexOffset)
+		return false;
+
+	// a missing source is fine (shipped caches); a changed one is re-hashed only when the
+	// timestamp moved but the size did not, so a touched-but-identical file stays a hit and
+	// gets its new timestamp written back
+	struct Restamp {
+		uint64_t offset;
+		int64_t time;
+	};
+	std::vector<Restamp> restamps;
+
+	const char* stamp = file.data() + header.sourceOffset;
+	const char* stampEnd = stamp + header.sourceTableSize;
+	for (uint32_t i = 0; i < header.sourceCount; i++) {
+		std::string sourcePath;
+		uint64_t size, hash;
+		int64_t time;
+
+		if (!readString(stamp, stampEnd, sourcePath) || static_cast<size_t>(stampEnd - stamp) < sizeof(size) + sizeof(time) + sizeof(hash))
+			return false;
+
+		const uint64_t timeOffset = static_cast<uint64_t>(stamp - file.data()) + sizeof(size);
+		memcpy(&size, stamp, sizeof(size));
+		memcpy(&time, stamp + sizeof(size), sizeof(time));
+		memcpy(&hash, stamp + sizeof(size) + sizeof(time), sizeof(hash));
+		stamp += sizeof(size) + sizeof(time) + sizeof(hash);
+
+		SourceInfo info = sourceInfo(sourcePath);
+		if (!info.exists || (info.size == size && info.time == time))
+			continue;
+
+		if (info.size != size || hashSource(sourcePath) != hash) {
+			g_console.add("[Mesh Cache] %s is stale (%s changed), re-cooking\n", path.c_str(), sourcePath.c_str());
+			return false;
+		}
+
+		restamps.push_back({ timeOffset, info.time });
+	}
+
+	size_t baseVertex = vertices.size();
+	if (baseVertex + header.vertexCount > std::numeric_limits<uint32_t>::max())
+		return false;
+
+	std::vector<Materials> table;
+	if (materials) {
+		const char* p = file.data() + header.materialOffset;
+		const char* end = p + header.materialSize;
+
+		// a copy cooked without materials, or with another directory's, cannot supply them
+		std::string cookedDir;
+		if (!header.hasMaterials || !materialDir || !readString(p, end, cookedDir) || cookedDir != materialKey(*materialDir))
+			return false;
+
+		table.resize(header.materialCount);
+		for (Materials& material : table) {
+			for (auto field : MATERIAL_FIELDS) {
+				if (!readString(p, end, material.*field))
+					return false;
+			}
+		}
+	}
+
+	vertices.resize(baseVertex + static_cast<size_t>(header.vertexCount));
+	memcpy(vertices.data() + baseVertex, file.data() + header.vertexOffset, static_cast<size_t>(header.vertexCount) * sizeof(Vertex));
+
+	size_t baseIndex = indices.size();
+	indices.resize(baseIndex + static_cast<size_t>(header.indexCount));
+	memcpy(indices.data() + baseIndex, file.data() + header.indexOffset, static_cast<size_t>(header.indexCount) * sizeof(uint32_t));
+
+	// an index past the vertex stream would read out of bounds on the GPU
+	for (size_t i = baseIndex; i < indices.size(); i++) {
+		if (indices[i] >= header.vertexCount) {
+			vertices.resize(baseVertex);
+			indices.resize(baseIndex);
+			g_console.add("[Mesh Cache] %s is corrupt, re-cooking\n", path.c_str());
+			return false;
+		}
+
+		indices[i] += static_cast<uint32_t>(baseVertex);
+	}
+
+	if (materials)
+		materials->insert(materials->end(), table.begin(), table.end());
+
+	bounds.min = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+	bounds.max = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+
+	// the stamps are patched in place; a copy that cannot be written is simply hashed again next time
+	if (!restamps.empty()) {
+		file.close();
+
+		std::fstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+		for (const Restamp& restamp : restamps) {
+			out.seekp(static_cast<std::streamoff>(restamp.offset));
+			out.write(reinterpret_cast<const char*>(&restamp.time), sizeof(restamp.time));
+		}
+	}
+
+	return true;
+}
+
+void Engine::Graphics::MeshCache::write(const std::string& path, const std::vector<std::string>& sources, const std::optional<std::string>& materialDir, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Materials>& materials, const MeshBounds& bounds)
+{
+	if (sources.empty() || !sourceInfo(sources.front()).exists)
+		return;
+
+	std::vector<char> sourceTable;
+	uint32_t sourceCount = 0;
+	for (const std::string& source : sources) {
+		SourceInfo info = sourceInfo(source);
+		if (!info.exists)
+			continue;
+
+		writeString(sourceTable, source);
+		writeValue(sourceTable, info.size);
+		writeValue(sourceTable, info.time);
+		writeValue(sourceTable, hashSource(source));
+		sourceCount++;
+	}
+
+	std::vector<char> materialTable;
+	if (materialDir)
+		writeString(materialTable, materialKey(*materialDir));
+
+	for (const Materials& material : materials) {
+		for (auto field : MATERIAL_FIELDS)
+			writeString(materialTable, material.*field);
+	}
+
+	FileHeader header{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.vertexStride = sizeof(Vertex);
+	header.materialCount = static_cast<uint32_t>(materials.size());
+	header.sourceCount = sourceCount;
+	header.hasMaterials = materialDir ? 1 : 0;
+	header.sourceOffset = sizeof(FileHeader);
+	header.sourceTableSize = sourceTable.size();
+	header.vertexCount = vertices.size();
+	header.indexCount = indices.size();
+	header.materialOffset = header.sourceOffset + header.sourceTableSize;
+	header.materialSize = materialTable.size();
+	header.vertexOffset = alignUp(header.materialOffset + header.materialSize, BLOB_ALIGNMENT);
+	header.indexOffset = alignUp(header.vertexOffset + vertices.size() * sizeof(Vertex), BLOB_ALIGNMENT);
+	memcpy(header.boundsMin, &bounds.min, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, &bounds.max, sizeof(header.boundsMax));
+
+	std::filesystem::path target(path);
+	std::filesystem::path temp = target;
+	temp += ".tmp";
+
+	std::error_code ec;
+	std::filesystem::create_directories(target.parent_path(), ec);
+
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			g_console.add("[Mesh Cache] failed to open %s for writing\n", temp.string().c_str());
+			return;
+		}
+
+		const char padding[BLOB_ALIGNMENT] = {};
+		auto pad = [&](uint64_t offset) {
+			file.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(file.tellp())));
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(sourceTable.data(), static_cast<std::streamsize>(sourceTable.size()));
+		file.write(materialTable.data(), static_cast<std::streamsize>(materialTable.size()));
+		pad(header.vertexOffset);
+		file.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size() * sizeof(Vertex)));
+		pad(header.indexOffset);
+		file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size() * sizeof(uint32_t)));
+
+		if (!file.good()) {
+			file.close();
+			std::filesystem::remove(temp, ec);
+			g_console.add("[Mesh Cache] failed to write %s\n", temp.string().c_str());
+			return;
+		}
+	}
+
+	std::filesystem::rename(temp, target, ec);
+	if (ec) {
+		std::filesystem::remove(temp, ec);
+		g_console.add("[Mesh Cache] failed to replace %s\n", path.c_str());
+		return;
+	}
+
+	g_console.add("[Mesh Cache] cooked %s into %s\n", sources.front().c_str(), path.c_str());
+}
@@ -0,0 +1,232 @@
+#include "mipChain.h"
+#include "threadPool.h"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FORTIFY_MIP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+	const std::array<float, 256>& srgbToLinear()
+	{
+		static const std::array<float, 256> table = []() {
+			std::array<float, 256> values{};
+			for (int i = 0; i < 256; i++) {
+				const float c = i / 255.0f;
+				values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			return values;
+		}();
+		return table;
+	}
+
+	const std::array<uint8_t, 4096>& linearToSrgbTable()
+	{
+		static const std::array<uint8_t, 4096> table = []() {
+			std::array<uint8_t, 4096> values{};
+			for (int i = 0; i < 4096; i++) {
+				const float l = i / 4095.0f;
+				const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+				values[i] = static_cast<uint8_t>(std::lround(std::clamp(c, 0.0f, 1.0f) * 255.0f));
+			}
+			return values;
+		}();
+		return table;
+	}
+
+	uint8_t linearToSrgb(float value)
+	{
+		return linearToSrgbTable()[static_cast<size_t>(std::clamp(value, 0.0f, 1.0f) * 4095.0f + 0.5f)];
+	}
+
+	// the rows of one output row's 2x2 footprint; x0/x1 clamp for 1 texel wide levels
+	struct RowPair {
+		const uint8_t* row0;
+		const uint8_t* row1;
+		uint32_t width;
+		uint32_t channels;
+	};
+
+	void downsampleTexels(const RowPair& rows, uint32_t first, uint32_t last, uint8_t* out)
+	{
+		const uint32_t channels = rows.channels;
+
+		for (uint32_t x = first; x < last; x++) {
+			const size_t x0 = static_cast<size_t>(std::min(x * 2, rows.width - 1)) * channels;
+			const size_t x1 = static_cast<size_t>(std::min(x * 2 + 1, rows.width - 1)) * channels;
+
+			for (uint32_t c = 0; c < channels; c++)
+				out[x * channels + c] = static_cast<uint8_t>((rows.row0[x0 + c] + rows.row0[x1 + c] + rows.row1[x0 + c] + rows.row1[x1 + c] + 2) / 4);
+		}
+	}
+
+	void downsampleSrgbTexels(const RowPair& rows, uint32_t first, uint32_t last, uint8_t* out)
+	{
+		const auto& toLinear = srgbToLinear();
+
+		for (uint32_t x = first; x < last; x++) {
+			const size_t x0 = static_cast<size_t>(std::min(x * 2, rows.width - 1)) * 4;
+			const size_t x1 = static_cast<size_t>(std::min(x * 2 + 1, rows.width - 1)) * 4;
+
+			for (uint32_t c = 0; c < 3; c++) {
+				const float sum = toLinear[rows.row0[x0 + c]] + toLinear[rows.row0[x1 + c]] + toLinear[rows.row1[x0 + c]] + toLinear[rows.row1[x1 + c]];
+				out[x * 4 + c] = linearToSrgb(sum * 0.25f);
+			}
+
+			out[x * 4 + 3] = static_cast<uint8_t>((rows.row0[x0 + 3] + rows.row0[x1 + 3] + rows.row1[x0 + 3] + rows.row1[x1 + 3] + 2) / 4);
+		}
+	}
+
+#ifdef FORTIFY_MIP_SSE2
+	// lo and hi hold the column sums of 16 source bytes as 16-bit lanes; returns the sums of
+	// each horizontal pair of texels, one 16-bit lane per output byte
+	__m128i pairSums(__m128i lo, __m128i hi, uint32_t channels)
+	{
+		switch (channels) {
+			case 4:
+				return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+			case 2: {
+				const __m128 a = _mm_castsi128_ps(lo);
+				const __m128 b = _mm_castsi128_ps(hi);
+				return _mm_add_epi16(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))), _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))));
+			}
+			default: {
+				const __m128i ones = _mm_set1_epi16(1);
+				return _mm_packs_epi32(_mm_madd_epi16(lo, ones), _mm_madd_epi16(hi, ones));
+			}
+		}
+	}
+
+	// 16 output bytes per step from 32 bytes of each source row; returns the first texel left over
+	uint32_t downsampleTexelsSse2(const RowPair& rows, uint32_t dstWidth, uint8_t* out)
+	{
+		// a 1 texel wide source clamps x1 back onto x0, which the vector path does not do
+		if (rows.width < 2)
+			return 0;
+
+		const uint32_t step = 16 / rows.channels;
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i round = _mm_set1_epi16(2);
+
+		uint32_t x = 0;
+		for (; x + step <= dstWidth; x += step) {
+			const size_t offset = static_cast<size_t>(x) * 2 * rows.channels;
+			__m128i results[2];
+
+			for (int half = 0; half < 2; half++) {
+				const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.row0 + offset + half * 16));
+				const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.row1 + offset + half * 16));
+				const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+				const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+				results[half] = _mm_srli_epi16(_mm_add_epi16(pairSums(lo, hi, rows.channels), round), 2);
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + static_cast<size_t>(x) * rows.channels), _mm_packus_epi16(results[0], results[1]));
+		}
+
+		return x;
+	}
+
+	// colour goes through the lookup tables one texel at a time, but the four linear values of
+	// a footprint are summed and turned back into table indices four channels at once
+	uint32_t downsampleSrgbTexelsSse2(const RowPair& rows, uint32_t dstWidth, uint8_t* out)
+	{
+		if (rows.width < 2)
+			return 0;
+
+		const auto& toLinear = srgbToLinear();
+		const auto& toSrgb = linearToSrgbTable();
+		const __m128 quarter = _mm_set1_ps(0.25f);
+		const __m128 scale = _mm_set1_ps(4095.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 zero = _mm_setzero_ps();
+
+		auto load = [&](const uint8_t* texel) {
+			return _mm_setr_ps(toLinear[texel[0]], toLinear[texel[1]], toLinear[texel[2]], 0.0f);
+		};
+
+		for (uint32_t x = 0; x < dstWidth; x++) {
+			const uint8_t* a = rows.row0 + static_cast<size_t>(x) * 8;
+			const uint8_t* b = rows.row1 + static_cast<size_t>(x) * 8;
+
+			__m128 sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(load(a), load(a + 4)), load(b)), load(b + 4));
+			sum = _mm_min_ps(_mm_max_ps(_mm_mul_ps(sum, quarter), zero), one);
+
+			alignas(16) int32_t index[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(sum, scale), half)));
+
+			uint8_t* texel = out + static_cast<size_t>(x) * 4;
+			texel[0] = toSrgb[index[0]];
+			texel[1] = toSrgb[index[1]];
+			texel[2] = toSrgb[index[2]];
+			texel[3] = static_cast<uint8_t>((a[3] + a[7] + b[3] + b[7] + 2) / 4);
+		}
+
+		return dstWidth;
+	}
+#endif
+
+	void downsampleRow(VkFormat pixelFormat, const RowPair& rows, uint32_t dstWidth, uint8_t* out)
+	{
+		const bool srgb = pixelFormat == VK_FORMAT_R8G8B8A8_SRGB;
+		uint32_t x = 0;
+
+#ifdef FORTIFY_MIP_SSE2
+		x = srgb ? downsampleSrgbTexelsSse2(rows, dstWidth, out) : downsampleTexelsSse2(rows, dstWidth, out);
+#endif
+
+		if (srgb)
+			downsampleSrgbTexels(rows, x, dstWidth, out);
+		else
+			downsampleTexels(rows, x, dstWidth, out);
+	}
+}
+
+void Engine::Graphics::MipChain::downsample(VkFormat pixelFormat, const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dst)
+{
+	const uint32_t channels = formatTexelSize(pixelFormat);
+	const uint32_t dstWidth = std::max(width / 2, 1u);
+	const uint32_t dstHeight = std::max(height / 2, 1u);
+
+	auto downsampleRows = [&](uint32_t first, uint32_t last) {
+		for (uint32_t y = first; y < last; y++) {
+			RowPair rows{};
+			rows.row0 = src + static_cast<size_t>(std::min(y * 2, height - 1)) * width * channels;
+			rows.row1 = src + static_cast<size_t>(std::min(y * 2 + 1, height - 1)) * width * channels;
+			rows.width = width;
+			rows.channels = channels;
+
+			downsampleRow(pixelFormat, rows, dstWidth, dst + static_cast<size_t>(y) * dstWidth * channels);
+		}
+	};
+
+	const size_t chunks = threadPool ? threadPool->chunkCount(static_cast<size_t>(dstHeight) * dstWidth, 64 * 1024) : 1;
+	if (chunks == 1) {
+		downsampleRows(0, dstHeight);
+		return;
+	}
+
+	const uint32_t rowsPerChunk = static_cast<uint32_t>((dstHeight + chunks - 1) / chunks);
+
+	threadPool->parallelFor(chunks, [&](size_t chunk) {
+		const uint32_t first = std::min(static_cast<uint32_t>(chunk) * rowsPerChunk, dstHeight);
+		downsampleRows(first, std::min(first + rowsPerChunk, dstHeight));
+	});
+}
+
+std::vector<Engine::Graphics::ImageRegion> Engine::Graphics::MipChain::build(VkFormat pixelFormat, const uint8_t* pixels, uint32_t width, uint32_t height, uint8_t* out)
+{
+	std::vector<ImageRegion> regions = mipRegions(pixelFormat, width, height, mipLevelCount(width, height));
+
+	memcpy(out + regions[0].offset, pixels, static_cast<size_t>(regions[0].size));
+
+	for (size_t i = 1; i < regions.size(); i++) {
+		const ImageRegion& source = regions[i - 1];
+		downsample(pixelFormat, out + source.offset, source.width, source.height, out + regions[i].offset);
+	}
+
+	return regions;
+}
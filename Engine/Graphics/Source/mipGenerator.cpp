@@ -0,0 +1,558 @@
+#include "mipGenerator.h"
+#include "device.h"
+#include "commandBuffer.h"
+#include "pipeline.h"
+#include "pipelineCache.h"
+#include "sampler.h"
+#include "uploadBatch.h"
+#include "mipChain.h"
+
+std::unique_ptr<Engine::Graphics::MipGenerator> mipGenerator;
+
+namespace {
+	constexpr const char* SHADER_NAMES[] = { "mipGenRGBA.comp.spv", "mipGenRG.comp.spv", "mipGenR.comp.spv" };
+	constexpr uint32_t STORAGE_BINDINGS = Engine::Graphics::MipGenerator::MAX_LEVELS_PER_PASS + 1;
+
+	VkImageMemoryBarrier levelBarrier(VkImage image, uint32_t baseLevel, uint32_t levelCount, uint32_t layerCount, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+	{
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.image = image;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = baseLevel;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = layerCount;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstAccessMask = dstAccess;
+		return barrier;
+	}
+
+	// levels one pass can produce: after six levels each 64x64 tile is down to one texel, and the
+	// last workgroup can only carry on when those texels fit in a single tile again
+	uint32_t passLevels(uint32_t width, uint32_t height, uint32_t remaining)
+	{
+		const uint32_t levels = std::min(remaining, Engine::Graphics::MipGenerator::MAX_LEVELS_PER_PASS);
+		if ((std::max(width, height) >> 6) > Engine::Graphics::MipGenerator::TILE_SIZE)
+			return std::min(levels, 6u);
+
+		return levels;
+	}
+}
+
+Engine::Graphics::MipGenerator::~MipGenerator()
+{
+}
+
+void Engine::Graphics::MipGenerator::create(const Engine::Graphics::Device& device, const std::string& shaderDirectory)
+{
+	this->device = device.getDevice();
+	this->physicalDevice = device.getPhysicalDevice();
+
+	VkPhysicalDeviceSubgroupProperties subgroupProperties{};
+	subgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &subgroupProperties;
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+	VkPhysicalDeviceFeatures features;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
+
+	const bool quadOps = (subgroupProperties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) && (subgroupProperties.supportedOperations & VK_SUBGROUP_FEATURE_QUAD_BIT);
+	if (!quadOps || !features.shaderStorageImageArrayDynamicIndexing) {
+		g_console.add("[MipGen] compute mip generation unavailable on this device, using blits\n");
+		return;
+	}
+
+	std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+	bindings[0].binding = 0;
+	bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	bindings[0].descriptorCount = 1;
+	bindings[1].binding = 1;
+	bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	bindings[1].descriptorCount = MAX_LEVELS_PER_PASS;
+	bindings[2].binding = 2;
+	bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	bindings[2].descriptorCount = 1;
+	bindings[3].binding = 3;
+	bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	bindings[3].descriptorCount = 1;
+	for (auto& binding : bindings)
+		binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	VkDescriptorSetLayoutCreateInfo setLayoutInfo{};
+	setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	setLayoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	setLayoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(this->device, &setLayoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+		throw std::runtime_error("failed to create mip generator descriptor set layout");
+
+	VkPushConstantRange pushConstant{};
+	pushConstant.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstant.offset = 0;
+	pushConstant.size = sizeof(PushConstants);
+
+	VkPipelineLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutInfo.setLayoutCount = 1;
+	layoutInfo.pSetLayouts = &setLayout;
+	layoutInfo.pushConstantRangeCount = 1;
+	layoutInfo.pPushConstantRanges = &pushConstant;
+
+	if (vkCreatePipelineLayout(this->device, &layoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+		throw std::runtime_error("failed to create mip generator pipeline layout");
+
+	for (uint32_t variant = 0; variant < VARIANT_COUNT; variant++) {
+		// two-channel and single-channel storage images need the extended formats
+		if (variant != RGBA && !features.shaderStorageImageExtendedFormats)
+			continue;
+
+		auto shaderCode = Engine::Graphics::Pipeline::readFile(shaderDirectory + SHADER_NAMES[variant]);
+		VkShaderModule shaderModule = Engine::Graphics::Pipeline::createShaderModule(this->device, shaderCode);
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = shaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.layout = pipelineLayout;
+
+		VkResult result = vkCreateComputePipelines(this->device, pipelineCache ? pipelineCache->get() : VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipelines[variant]);
+		vkDestroyShaderModule(this->device, shaderModule, nullptr);
+
+		if (result != VK_SUCCESS)
+			throw std::runtime_error(std::string("failed to create mip generator pipeline ") + SHADER_NAMES[variant]);
+
+		variantSupported[variant] = true;
+	}
+
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = VK_FILTER_LINEAR;
+	samplerInfo.minFilter = VK_FILTER_LINEAR;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.maxLod = 0.0f;
+
+	if (vkCreateSampler(this->device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+		throw std::runtime_error("failed to create mip generator sampler");
+
+	counters = resources->create<BufferResource>(this->device, physicalDevice, sizeof(uint32_t) * MAX_LAYERS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	memset(counters->mapped, 0, sizeof(uint32_t) * MAX_LAYERS);
+}
+
+void Engine::Graphics::MipGenerator::destroy()
+{
+	if (device == VK_NULL_HANDLE)
+		return;
+
+	resources->defer([pipelines = pipelines, layout = pipelineLayout, setLayout = setLayout, sampler = sampler](VkDevice device) {
+		for (VkPipeline pipeline : pipelines)
+			vkDestroyPipeline(device, pipeline, nullptr);
+		vkDestroyPipelineLayout(device, layout, nullptr);
+		vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+		vkDestroySampler(device, sampler, nullptr);
+	});
+
+	if (counters)
+		resources->destroy(counters);
+
+	counters = nullptr;
+	pipelines = {};
+	variantSupported = {};
+	pipelineLayout = VK_NULL_HANDLE;
+	setLayout = VK_NULL_HANDLE;
+	sampler = VK_NULL_HANDLE;
+	device = VK_NULL_HANDLE;
+}
+
+Engine::Graphics::MipGenerator::Variant Engine::Graphics::MipGenerator::variantOf(VkFormat format)
+{
+	switch (format) {
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return RGBA;
+		case VK_FORMAT_R8G8_UNORM:
+			return RG;
+		case VK_FORMAT_R8_UNORM:
+			return R;
+		default:
+			return VARIANT_COUNT;
+	}
+}
+
+VkFormat Engine::Graphics::MipGenerator::storageFormat(VkFormat format)
+{
+	// sRGB formats have no storage support; the shader encodes through a UNORM view instead
+	return format == VK_FORMAT_R8G8B8A8_SRGB ? VK_FORMAT_R8G8B8A8_UNORM : format;
+}
+
+bool Engine::Graphics::MipGenerator::supports(VkFormat format) const
+{
+	const Variant variant = variantOf(format);
+	if (variant == VARIANT_COUNT || !variantSupported[variant])
+		return false;
+
+	VkFormatProperties sampled, storage;
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &sampled);
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, storageFormat(format), &storage);
+
+	return (sampled.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) && (storage.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+}
+
+void Engine::Graphics::MipGenerator::prepareImage(VkFormat format, VkImageUsageFlags& usage, VkImageCreateFlags& flags) const
+{
+	if (!supports(format))
+		return;
+
+	usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+	if (storageFormat(format) != format)
+		flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+}
+
+bool Engine::Graphics::MipGenerator::canRecord(const ImageResource* image, VkFormat format, uint32_t layerCount) const
+{
+	if (layerCount > MAX_LAYERS || !(image->usage & VK_IMAGE_USAGE_STORAGE_BIT) || !supports(format))
+		return false;
+
+	return storageFormat(format) == format || (image->flags & VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT);
+}
+
+VkImageView Engine::Graphics::MipGenerator::createView(VkImage image, VkFormat format, VkImageUsageFlags usage, uint32_t level, uint32_t layerCount)
+{
+	VkImageViewUsageCreateInfo viewUsage{};
+	viewUsage.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+	viewUsage.usage = usage;
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.pNext = &viewUsage;
+	viewInfo.image = image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	viewInfo.format = format;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.baseMipLevel = level;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.baseArrayLayer = 0;
+	viewInfo.subresourceRange.layerCount = layerCount;
+
+	VkImageView view;
+	if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+		throw std::runtime_error("failed to create mip generator image view");
+
+	return view;
+}
+
+void Engine::Graphics::MipGenerator::record(VkCommandBuffer commandBuffer, ImageResource* image, VkFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layerCount, Dispatch& dispatch)
+{
+	if (!canRecord(image, format, layerCount))
+		throw std::runtime_error("mip generator cannot handle texture format " + std::to_string(format));
+
+	if (mipLevels <= 1) {
+		VkImageMemoryBarrier barrier = levelBarrier(image->image, 0, 1, layerCount, image->layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			0, nullptr,
+			0, nullptr,
+			1, &barrier
+		);
+
+		image->updateLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		return;
+	}
+
+	uint32_t passes = 0;
+	for (uint32_t base = 0; base + 1 < mipLevels; passes++)
+		base += passLevels(std::max(width >> base, 1u), std::max(height >> base, 1u), mipLevels - 1 - base);
+
+	std::array<VkDescriptorPoolSize, 3> poolSizes{};
+	poolSizes[0] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, passes };
+	poolSizes[1] = { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, passes * STORAGE_BINDINGS };
+	poolSizes[2] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, passes };
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+	poolInfo.pPoolSizes = poolSizes.data();
+	poolInfo.maxSets = passes;
+
+	if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &dispatch.pool) != VK_SUCCESS)
+		throw std::runtime_error("failed to create mip generator descriptor pool");
+
+	const VkFormat viewFormat = storageFormat(format);
+
+	// level 0 is read through the sampler, every other level is written as a storage image;
+	// the counter barrier orders this chain after any earlier one using the same counters
+	std::array<VkImageMemoryBarrier, 2> barriers{};
+	barriers[0] = levelBarrier(image->image, 0, 1, layerCount, image->layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+	barriers[1] = levelBarrier(image->image, 1, mipLevels - 1, layerCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+	VkBufferMemoryBarrier counterBarrier{};
+	counterBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	counterBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	counterBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	counterBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	counterBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	counterBarrier.buffer = counters->buffer;
+	counterBarrier.offset = 0;
+	counterBarrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		0, nullptr,
+		1, &counterBarrier,
+		static_cast<uint32_t>(barriers.size()), barriers.data()
+	);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines[variantOf(format)]);
+
+	std::vector<VkImageMemoryBarrier> finalBarriers;
+
+	for (uint32_t base = 0; base + 1 < mipLevels;) {
+		const uint32_t sourceWidth = std::max(width >> base, 1u);
+		const uint32_t sourceHeight = std::max(height >> base, 1u);
+		const uint32_t levels = passLevels(sourceWidth, sourceHeight, mipLevels - 1 - base);
+		const bool lastPass = base + levels + 1 >= mipLevels;
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = dispatch.pool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &setLayout;
+
+		VkDescriptorSet descriptorSet;
+		if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate mip generator descriptor set");
+
+		VkDescriptorImageInfo sourceInfo{};
+		sourceInfo.sampler = sampler;
+		sourceInfo.imageView = createView(image->image, format, VK_IMAGE_USAGE_SAMPLED_BIT, base, layerCount);
+		sourceInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		dispatch.views.push_back(sourceInfo.imageView);
+
+		// levels the pass does not reach repeat its last view; the shader never writes them
+		std::array<VkDescriptorImageInfo, MAX_LEVELS_PER_PASS> levelInfos{};
+		for (uint32_t i = 0; i < MAX_LEVELS_PER_PASS; i++) {
+			if (i < levels) {
+				levelInfos[i].imageView = createView(image->image, viewFormat, VK_IMAGE_USAGE_STORAGE_BIT, base + 1 + i, layerCount);
+				dispatch.views.push_back(levelInfos[i].imageView);
+			}
+			else {
+				levelInfos[i].imageView = levelInfos[levels - 1].imageView;
+			}
+			levelInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		}
+
+		VkDescriptorBufferInfo counterInfo{};
+		counterInfo.buffer = counters->buffer;
+		counterInfo.offset = 0;
+		counterInfo.range = VK_WHOLE_SIZE;
+
+		std::array<VkWriteDescriptorSet, 4> writes{};
+		for (uint32_t j = 0; j < writes.size(); j++) {
+			writes[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[j].dstSet = descriptorSet;
+			writes[j].dstBinding = j;
+			writes[j].descriptorCount = 1;
+			writes[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		}
+		writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		writes[0].pImageInfo = &sourceInfo;
+		writes[1].descriptorCount = MAX_LEVELS_PER_PASS;
+		writes[1].pImageInfo = levelInfos.data();
+		writes[2].pImageInfo = &levelInfos[std::min(levels, 6u) - 1];
+		writes[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		writes[3].pBufferInfo = &counterInfo;
+
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+		const uint32_t tilesX = (sourceWidth + TILE_SIZE - 1) / TILE_SIZE;
+		const uint32_t tilesY = (sourceHeight + TILE_SIZE - 1) / TILE_SIZE;
+
+		PushConstants constants{};
+		constants.sourceWidth = sourceWidth;
+		constants.sourceHeight = sourceHeight;
+		constants.levels = levels;
+		constants.srgb = format == VK_FORMAT_R8G8B8A8_SRGB ? 1 : 0;
+		constants.tilesPerLayer = tilesX * tilesY;
+
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &constants);
+		vkCmdDispatch(commandBuffer, tilesX, tilesY, layerCount);
+
+		if (lastPass) {
+			finalBarriers.push_back(levelBarrier(image->image, base + 1, levels, layerCount, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+			break;
+		}
+
+		// the last level written becomes the next pass's source
+		if (levels > 1)
+			finalBarriers.push_back(levelBarrier(image->image, base + 1, levels - 1, layerCount, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+
+		VkImageMemoryBarrier sourceBarrier = levelBarrier(image->image, base + levels, 1, layerCount, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			0, nullptr,
+			1, &counterBarrier,
+			1, &sourceBarrier
+		);
+
+		base += levels;
+	}
+
+	// also makes the levels that served as pass sources visible to fragment shaders
+	VkMemoryBarrier memoryBarrier{};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		1, &memoryBarrier,
+		0, nullptr,
+		static_cast<uint32_t>(finalBarriers.size()), finalBarriers.data()
+	);
+
+	image->updateLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void Engine::Graphics::MipGenerator::release(Dispatch& dispatch)
+{
+	for (VkImageView view : dispatch.views)
+		vkDestroyImageView(device, view, nullptr);
+
+	if (dispatch.pool != VK_NULL_HANDLE)
+		vkDestroyDescriptorPool(device, dispatch.pool, nullptr);
+
+	dispatch = {};
+}
+
+void Engine::Graphics::MipGenerator::benchmark(const Engine::Graphics::Device& device, const Engine::Graphics::CommandBuffer& commandBuf)
+{
+	struct Case {
+		const char* name;
+		VkFormat format;
+		uint32_t size;
+		uint32_t layers;
+	};
+
+	const Case cases[] = {
+		{ "1024 RGBA8", VK_FORMAT_R8G8B8A8_UNORM, 1024, 1 },
+		{ "2048 RGBA8", VK_FORMAT_R8G8B8A8_UNORM, 2048, 1 },
+		{ "2048 RGBA8 sRGB", VK_FORMAT_R8G8B8A8_SRGB, 2048, 1 },
+		{ "4096 RGBA8 sRGB", VK_FORMAT_R8G8B8A8_SRGB, 4096, 1 },
+		{ "2048 RG8", VK_FORMAT_R8G8_UNORM, 2048, 1 },
+		{ "2048 R8", VK_FORMAT_R8_UNORM, 2048, 1 },
+		{ "1024 cube RGBA8 sRGB", VK_FORMAT_R8G8B8A8_SRGB, 1024, 6 },
+	};
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	if (!properties.limits.timestampComputeAndGraphics) {
+		g_console.add("[MipGen] benchmark needs timestamp queries on the graphics queue\n");
+		return;
+	}
+
+	VkQueryPoolCreateInfo queryInfo{};
+	queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryInfo.queryCount = 4;
+
+	VkQueryPool queryPool;
+	if (vkCreateQueryPool(this->device, &queryInfo, nullptr, &queryPool) != VK_SUCCESS)
+		throw std::runtime_error("failed to create mip benchmark query pool");
+
+	const double tickMs = properties.limits.timestampPeriod / 1e6;
+
+	for (const Case& test : cases) {
+		const uint32_t levels = mipLevelCount(test.size, test.size);
+		const bool cube = test.layers == 6;
+
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, test.format, &formatProperties);
+		const bool blit = formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		const bool compute = supports(test.format);
+
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		VkImageCreateFlags flags = cube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+		prepareImage(test.format, usage, flags);
+
+		ImageResource* image = resources->create<ImageResource>(this->device, physicalDevice, test.size, test.size, levels, VK_SAMPLE_COUNT_1_BIT, test.format, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, test.layers, flags, VK_IMAGE_ASPECT_COLOR_BIT, cube, false);
+
+		// the image contents do not matter for timing, so level 0 is left as it comes
+		Engine::Graphics::UploadBatch batch(device, commandBuf);
+		VkCommandBuffer commandBuffer = batch.getCommandBuffer();
+		vkCmdResetQueryPool(commandBuffer, queryPool, 0, 4);
+
+		batch.transitionImageLayout(image, test.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levels, test.layers);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 0);
+		if (blit)
+			Engine::Graphics::Sampler::recordMipmaps(commandBuffer, physicalDevice, image, test.format, test.size, test.size, levels, test.layers);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 1);
+
+		// keep the compute run from overlapping the tail of the blit chain
+		VkMemoryBarrier drain{};
+		drain.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		drain.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+		drain.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+			1, &drain,
+			0, nullptr,
+			0, nullptr
+		);
+
+		Dispatch dispatch;
+		batch.transitionImageLayout(image, test.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, levels, test.layers);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, 2);
+		if (compute)
+			record(commandBuffer, image, test.format, test.size, test.size, levels, test.layers, dispatch);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, 3);
+
+		batch.flush();
+		release(dispatch);
+		resources->destroy(image);
+
+		std::array<uint64_t, 4> timestamps{};
+		vkGetQueryPoolResults(this->device, queryPool, 0, 4, sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+		const double blitMs = (timestamps[1] - timestamps[0]) * tickMs;
+		const double computeMs = (timestamps[3] - timestamps[2]) * tickMs;
+
+		// the CPU chain cookers fall back on, over the same levels
+		const VkDeviceSize chainSize = imageDataSize(test.format, test.size, test.size, levels);
+		std::vector<uint8_t> pixels(static_cast<size_t>(imageLevelSize(test.format, test.size, test.size)));
+		std::vector<uint8_t> chain(static_cast<size_t>(chainSize));
+		for (size_t i = 0; i < pixels.size(); i++)
+			pixels[i] = static_cast<uint8_t>(i * 31 + (i >> 12));
+
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t layer = 0; layer < test.layers; layer++)
+			Engine::Graphics::MipChain::build(test.format, pixels.data(), test.size, test.size, chain.data());
+		const double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		auto gpuTime = [](bool ran, double ms) {
+			char text[32];
+			snprintf(text, sizeof(text), ran ? "%.3f ms" : "n/a", ms);
+			return std::string(text);
+		};
+
+		g_console.add("[MipGen] %s, %u levels: blit %s, compute %s, cpu %.1f ms\n", test.name, levels, gpuTime(blit, blitMs).c_str(), gpuTime(compute, computeMs).c_str(), cpuMs);
+	}
+
+	vkDestroyQueryPool(this->device, queryPool, nullptr);
+}
@@ -0,0 +1,575 @@
+#include "objLoader.h"
+#include "mappedFile.h"
+#include "threadPool.h"
+
+#include <charconv>
+#include <istream>
+#include <atomic>
+#include <map>
+
+namespace {
+	constexpr int32_t ABSENT = -1;
+
+	enum RelativeFlags : uint8_t {
+		RELATIVE_VERTEX = 1 << 0,
+		RELATIVE_TEXCOORD = 1 << 1,
+		RELATIVE_NORMAL = 1 << 2,
+	};
+
+	// negative OBJ indices count back from the attributes seen so far; inside a chunk they are
+	// stored relative to the chunk start and rebased once every chunk's counts are known
+	struct RawCorner {
+		int32_t vertex = ABSENT;
+		int32_t texcoord = ABSENT;
+		int32_t normal = ABSENT;
+		uint8_t relative = 0;
+	};
+
+	struct ObjChunk {
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> texcoords;
+		std::vector<RawCorner> corners;
+		std::vector<std::vector<std::string>> materialLibs;
+		bool valid = true;
+	};
+
+	// serves a mapped file to tinyobj's stream API without copying it
+	class MappedStreamBuffer : public std::streambuf
+	{
+	public:
+		explicit MappedStreamBuffer(std::string_view bytes) {
+			char* begin = const_cast<char*>(bytes.data());
+			setg(begin, begin, begin + bytes.size());
+		}
+	};
+
+	// resolves mtllib names against the material directory through MappedFile, recording
+	// each library that loaded the way the chunked parser does
+	class MappedMaterialReader : public tinyobj::MaterialReader
+	{
+	private:
+		std::string directory;
+
+	public:
+		std::vector<std::string> libraries;
+
+		explicit MappedMaterialReader(std::string directory) : directory(std::move(directory)) {}
+
+		bool operator()(const std::string& name, std::vector<tinyobj::material_t>* materials, std::map<std::string, int>* materialMap, std::string* warn, std::string* err) override {
+			const std::string libraryPath = (std::filesystem::path(directory) / name).string();
+
+			Engine::Utility::MappedFile library;
+			if (!library.open(libraryPath)) {
+				if (warn)
+					*warn += "Material file [ " + libraryPath + " ] not found.\n";
+				return false;
+			}
+
+			MappedStreamBuffer buffer(library.view());
+			std::istream stream(&buffer);
+			tinyobj::LoadMtl(materialMap, materials, &stream, warn, err);
+
+			if (std::find(libraries.begin(), libraries.end(), libraryPath) == libraries.end())
+				libraries.push_back(libraryPath);
+			return true;
+		}
+	};
+
+	template<typename F>
+	void runChunks(size_t chunks, F&& body)
+	{
+		if (threadPool) {
+			threadPool->parallelFor(chunks, std::forward<F>(body));
+			return;
+		}
+
+		for (size_t chunk = 0; chunk < chunks; chunk++)
+			body(chunk);
+	}
+
+	bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	const char* skipSpace(const char* p, const char* end)
+	{
+		while (p < end && isSpace(*p))
+			p++;
+		return p;
+	}
+
+	const char* skipToken(const char* p, const char* end)
+	{
+		while (p < end && !isSpace(*p))
+			p++;
+		return p;
+	}
+
+	bool parseFloat(const char*& p, const char* end, float& value)
+	{
+		if (p < end && *p == '+')
+			p++;
+
+		auto [next, error] = std::from_chars(p, end, value);
+		if (error != std::errc())
+			return false;
+
+		p = next;
+		return p == end || isSpace(*p);
+	}
+
+	bool parseIndex(const char*& p, const char* end, int32_t& value)
+	{
+		auto [next, error] = std::from_chars(p, end, value);
+		if (error != std::errc() || value == 0)
+			return false;
+
+		p = next;
+		return true;
+	}
+
+	// reads up to count floats, defaulting missing trailing components to zero
+	bool parseVector(const char* p, const char* end, std::vector<float>& out, size_t count)
+	{
+		for (size_t i = 0; i < count; i++) {
+			p = skipSpace(p, end);
+			if (p == end) {
+				if (i == 0)
+					return false;
+				out.push_back(0.0f);
+				continue;
+			}
+
+			float value;
+			if (!parseFloat(p, end, value))
+				return false;
+			out.push_back(value);
+		}
+
+		return true;
+	}
+
+	int32_t resolveIndex(int32_t index, size_t localCount, uint8_t flag, uint8_t& relative)
+	{
+		if (index > 0)
+			return index - 1;
+
+		relative |= flag;
+		return static_cast<int32_t>(localCount) + index;
+	}
+
+	bool parseFace(const char* p, const char* end, ObjChunk& chunk, std::vector<RawCorner>& polygon)
+	{
+		polygon.clear();
+
+		for (p = skipSpace(p, end); p < end; p = skipSpace(p, end)) {
+			RawCorner corner;
+			int32_t index;
+
+			if (!parseIndex(p, end, index))
+				return false;
+			corner.vertex = resolveIndex(index, chunk.positions.size() / 3, RELATIVE_VERTEX, corner.relative);
+
+			if (p < end && *p == '/') {
+				p++;
+
+				if (p < end && *p != '/') {
+					if (!parseIndex(p, end, index))
+						return false;
+					corner.texcoord = resolveIndex(index, chunk.texcoords.size() / 2, RELATIVE_TEXCOORD, corner.relative);
+				}
+
+				if (p < end && *p == '/') {
+					p++;
+					if (!parseIndex(p, end, index))
+						return false;
+					corner.normal = resolveIndex(index, chunk.normals.size() / 3, RELATIVE_NORMAL, corner.relative);
+				}
+			}
+
+			if (p < end && !isSpace(*p))
+				return false;
+
+			polygon.push_back(corner);
+		}
+
+		if (polygon.size() < 3)
+			return false;
+
+		for (size_t i = 1; i + 1 < polygon.size(); i++) {
+			chunk.corners.push_back(polygon[0]);
+			chunk.corners.push_back(polygon[i]);
+			chunk.corners.push_back(polygon[i + 1]);
+		}
+
+		return true;
+	}
+
+	// walks the statements in [p, end), skipping blank and comment lines and trimming trailing
+	// space; body gets the keyword, the start of its arguments and the end of the line, and
+	// returning false from it stops the walk
+	template<typename F>
+	bool forEachStatement(const char* p, const char* end, F&& body)
+	{
+		while (p < end) {
+			const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+			if (!lineEnd)
+				lineEnd = end;
+
+			const char* line = skipSpace(p, lineEnd);
+			const char* contentEnd = lineEnd;
+			while (contentEnd > line && isSpace(contentEnd[-1]))
+				contentEnd--;
+
+			p = lineEnd < end ? lineEnd + 1 : end;
+
+			if (line == contentEnd || *line == '#')
+				continue;
+
+			const char* keywordEnd = skipToken(line, contentEnd);
+			if (!body(std::string_view(line, keywordEnd - line), keywordEnd, contentEnd))
+				return false;
+		}
+
+		return true;
+	}
+
+	// the whitespace separated names of an mtllib statement
+	std::vector<std::string> parseNames(const char* p, const char* end)
+	{
+		std::vector<std::string> names;
+		for (const char* name = skipSpace(p, end); name < end; ) {
+			const char* nameEnd = skipToken(name, end);
+			names.emplace_back(name, nameEnd);
+			name = skipSpace(nameEnd, end);
+		}
+		return names;
+	}
+
+	void parseChunk(const char* p, const char* end, ObjChunk& chunk)
+	{
+		std::vector<RawCorner> polygon;
+
+		bool parsed = forEachStatement(p, end, [&](std::string_view keyword, const char* args, const char* contentEnd) {
+			if (contentEnd[-1] == '\\')
+				return false;
+
+			if (keyword == "v")
+				return parseVector(args, contentEnd, chunk.positions, 3);
+			if (keyword == "vn")
+				return parseVector(args, contentEnd, chunk.normals, 3);
+			if (keyword == "vt")
+				return parseVector(args, contentEnd, chunk.texcoords, 2);
+			if (keyword == "f")
+				return parseFace(args, contentEnd, chunk, polygon);
+			if (keyword == "mtllib")
+				chunk.materialLibs.push_back(parseNames(args, contentEnd));
+
+			return true;
+		});
+
+		if (!parsed)
+			chunk.valid = false;
+	}
+
+	bool rebase(int32_t& index, bool relative, size_t base, size_t count)
+	{
+		if (index == ABSENT && !relative)
+			return true;
+
+		int64_t resolved = static_cast<int64_t>(index) + (relative ? static_cast<int64_t>(base) : 0);
+		if (resolved < 0 || resolved >= static_cast<int64_t>(count))
+			return false;
+
+		index = static_cast<int32_t>(resolved);
+		return true;
+	}
+
+	Materials toMaterial(const tinyobj::material_t& mat)
+	{
+		Materials material;
+
+		material.name = mat.name;
+		material.diffusePath = mat.diffuse_texname;
+		material.normalPath = mat.normal_texname;
+		material.roughnessPath = mat.roughness_texname;
+		material.metalnessPath = mat.metallic_texname;
+		material.aoPath = mat.ambient_texname;
+		material.specularPath = mat.specular_texname;
+
+		return material;
+	}
+}
+
+Engine::Graphics::MeshSource Engine::Graphics::ObjMesh::source() const
+{
+	MeshSource source;
+	source.positions = positions;
+	source.normals = normals;
+	source.texcoords = texcoords;
+	source.indexRanges.emplace_back(corners);
+
+	return source;
+}
+
+Engine::Graphics::ObjMesh Engine::Graphics::ObjLoader::load(const std::string& path, const std::optional<std::string>& materialDir)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	ObjMesh mesh;
+	size_t bytes = 0;
+	const char* parser = "chunked parser";
+
+	if (!parseChunked(path, materialDir, mesh, bytes)) {
+		mesh = ObjMesh();
+		loadWithTinyObj(path, materialDir, mesh, bytes);
+		parser = "tinyobj";
+	}
+
+	double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	double megabytes = static_cast<double>(bytes) / (1024.0 * 1024.0);
+	g_console.add("[OBJ Loader] %s: %.1f MB in %.1f ms (%.0f MB/s) via %s\n", path.c_str(), megabytes, elapsed, elapsed > 0.0 ? megabytes / (elapsed / 1000.0) : 0.0, parser);
+
+	return mesh;
+}
+
+bool Engine::Graphics::ObjLoader::parseChunked(const std::string& path, const std::optional<std::string>& materialDir, ObjMesh& mesh, size_t& bytes)
+{
+	Engine::Utility::MappedFile file;
+	if (!file.open(path))
+		return false;
+
+	const char* begin = file.data();
+	const char* end = begin + file.size();
+	bytes = file.size();
+
+	// split on line boundaries so no statement straddles two chunks
+	const size_t chunkCount = threadPool ? threadPool->chunkCount(file.size(), MIN_CHUNK_SIZE) : 1;
+	std::vector<const char*> bounds(chunkCount + 1, end);
+	bounds[0] = begin;
+
+	for (size_t i = 1; i < chunkCount; i++) {
+		const char* target = std::max(bounds[i - 1], begin + file.size() * i / chunkCount);
+		const char* newline = static_cast<const char*>(std::memchr(target, '\n', end - target));
+		bounds[i] = newline ? newline + 1 : end;
+	}
+
+	std::vector<ObjChunk> chunks(chunkCount);
+	runChunks(chunkCount, [&](size_t chunk) {
+		parseChunk(bounds[chunk], bounds[chunk + 1], chunks[chunk]);
+	});
+
+	struct Offsets { size_t positions = 0, normals = 0, texcoords = 0, corners = 0; };
+	std::vector<Offsets> offsets(chunkCount + 1);
+
+	for (size_t i = 0; i < chunkCount; i++) {
+		if (!chunks[i].valid)
+			return false;
+
+		offsets[i + 1].positions = offsets[i].positions + chunks[i].positions.size();
+		offsets[i + 1].normals = offsets[i].normals + chunks[i].normals.size();
+		offsets[i + 1].texcoords = offsets[i].texcoords + chunks[i].texcoords.size();
+		offsets[i + 1].corners = offsets[i].corners + chunks[i].corners.size();
+	}
+
+	const Offsets& total = offsets[chunkCount];
+	if (total.positions / 3 > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+		return false;
+
+	mesh.positions.resize(total.positions);
+	mesh.normals.resize(total.normals);
+	mesh.texcoords.resize(total.texcoords);
+	mesh.corners.resize(total.corners);
+
+	std::atomic<bool> valid = true;
+	runChunks(chunkCount, [&](size_t i) {
+		ObjChunk& chunk = chunks[i];
+		const Offsets& base = offsets[i];
+
+		std::copy(chunk.positions.begin(), chunk.positions.end(), mesh.positions.begin() + base.positions);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), mesh.normals.begin() + base.normals);
+		std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), mesh.texcoords.begin() + base.texcoords);
+
+		for (size_t c = 0; c < chunk.corners.size(); c++) {
+			RawCorner raw = chunk.corners[c];
+
+			bool ok = rebase(raw.vertex, raw.relative & RELATIVE_VERTEX, base.positions / 3, total.positions / 3) && raw.vertex != ABSENT;
+			ok = ok && rebase(raw.texcoord, raw.relative & RELATIVE_TEXCOORD, base.texcoords / 2, total.texcoords / 2);
+			ok = ok && rebase(raw.normal, raw.relative & RELATIVE_NORMAL, base.normals / 3, total.normals / 3);
+
+			if (!ok) {
+				valid = false;
+				return;
+			}
+
+			tinyobj::index_t& corner = mesh.corners[base.corners + c];
+			corner.vertex_index = raw.vertex;
+			corner.texcoord_index = raw.texcoord;
+			corner.normal_index = raw.normal;
+		}
+
+		std::vector<float>().swap(chunk.positions);
+		std::vector<float>().swap(chunk.normals);
+		std::vector<float>().swap(chunk.texcoords);
+		std::vector<RawCorner>().swap(chunk.corners);
+	});
+
+	if (!valid)
+		return false;
+
+	if (!materialDir)
+		return true;
+
+	// like tinyobj, each mtllib statement loads the first of its files that exists
+	for (const auto& chunk : chunks) {
+		for (const auto& names : chunk.materialLibs) {
+			for (const auto& name : names) {
+				const std::string libraryPath = (std::filesystem::path(*materialDir) / name).string();
+
+				Engine::Utility::MappedFile library;
+				if (!library.open(libraryPath))
+					continue;
+
+				if (!parseMaterials(library.view(), mesh.materials))
+					return false;
+
+				if (std::find(mesh.materialLibraries.begin(), mesh.materialLibraries.end(), libraryPath) == mesh.materialLibraries.end())
+					mesh.materialLibraries.push_back(libraryPath);
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool Engine::Graphics::ObjLoader::parseMaterials(std::string_view text, std::vector<Materials>& materials)
+{
+	const char* p = text.data();
+	const char* end = p + text.size();
+	Materials* current = nullptr;
+
+	while (p < end) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		if (!lineEnd)
+			lineEnd = end;
+
+		const char* line = skipSpace(p, lineEnd);
+		const char* contentEnd = lineEnd;
+		while (contentEnd > line && isSpace(contentEnd[-1]))
+			contentEnd--;
+
+		p = lineEnd < end ? lineEnd + 1 : end;
+
+		if (line == contentEnd || *line == '#')
+			continue;
+
+		const char* keywordEnd = skipToken(line, contentEnd);
+		std::string_view keyword(line, keywordEnd - line);
+		const char* valueBegin = skipSpace(keywordEnd, contentEnd);
+		std::string value(valueBegin, contentEnd);
+
+		if (keyword == "newmtl") {
+			current = &materials.emplace_back();
+			current->name = value;
+			continue;
+		}
+
+		std::string Materials::* field = nullptr;
+		if (keyword == "map_Kd")
+			field = &Materials::diffusePath;
+		else if (keyword == "norm")
+			field = &Materials::normalPath;
+		else if (keyword == "map_Pr")
+			field = &Materials::roughnessPath;
+		else if (keyword == "map_Pm")
+			field = &Materials::metalnessPath;
+		else if (keyword == "map_Ka")
+			field = &Materials::aoPath;
+		else if (keyword == "map_Ks")
+			field = &Materials::specularPath;
+
+		if (!field || !current)
+			continue;
+
+		// texture options (-bm, -o, ...) need tinyobj's option parser
+		if (!value.empty() && value.front() == '-')
+			return false;
+
+		current->*field = value;
+	}
+
+	return true;
+}
+
+void Engine::Graphics::ObjLoader::loadWithTinyObj(const std::string& path, const std::optional<std::string>& materialDir, ObjMesh& mesh, size_t& bytes)
+{
+	// tinyobj reads through the same mappings as the fast path, so the asset pack is honoured
+	Engine::Utility::MappedFile file;
+	if (!file.open(path))
+		throw std::runtime_error("failed to open " + path);
+
+	bytes = file.size();
+	MappedStreamBuffer buffer(file.view());
+	std::istream stream(&buffer);
+
+	tinyobj::attrib_t attrib;
+	std::vector<tinyobj::shape_t> shapes;
+	std::vector<tinyobj::material_t> materials;
+	std::string warn, err;
+
+	// without a reader mtllib statements are skipped, as materials would be dropped anyway
+	std::optional<MappedMaterialReader> reader;
+	if (materialDir)
+		reader.emplace(*materialDir);
+
+	if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &stream, reader ? &*reader : nullptr))
+		throw std::runtime_error(warn + err);
+
+	mesh.positions = std::move(attrib.vertices);
+	mesh.normals = std::move(attrib.normals);
+	mesh.texcoords = std::move(attrib.texcoords);
+
+	for (const auto& shape : shapes)
+		mesh.corners.insert(mesh.corners.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
+
+	if (reader) {
+		for (const auto& mat : materials)
+			mesh.materials.push_back(toMaterial(mat));
+
+		mesh.materialLibraries = std::move(reader->libraries);
+	}
+}
+
+std::vector<std::string> Engine::Graphics::ObjLoader::materialLibraries(const std::string& path, const std::string& materialDir)
+{
+	std::vector<std::string> libraries;
+
+	Engine::Utility::MappedFile file;
+	if (!file.open(path))
+		return libraries;
+
+	// the parser's own tokenizer, so both see the same statements; each mtllib uses the first
+	// of its files that exists
+	forEachStatement(file.data(), file.data() + file.size(), [&](std::string_view keyword, const char* args, const char* contentEnd) {
+		if (keyword != "mtllib")
+			return true;
+
+		for (const std::string& name : parseNames(args, contentEnd)) {
+			std::string libraryPath = (std::filesystem::path(materialDir) / name).string();
+
+			Engine::Utility::MappedFile library;
+			if (library.open(libraryPath)) {
+				if (std::find(libraries.begin(), libraries.end(), libraryPath) == libraries.end())
+					libraries.push_back(libraryPath);
+				break;
+			}
+		}
+
+		return true;
+	});
+
+	return libraries;
+}
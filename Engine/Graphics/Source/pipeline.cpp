@@ -7,6 +7,33 @@ Engine::Graphics::Pipeline::~Pipeline()
 {
 }
 
+VkPipelineLayout Engine::Graphics::Pipeline::createPipelineLayout(VkDevice device, const Engine::Graphics::RenderPass& renderpass)
+{
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	std::array<VkDescriptorSetLayout, 2> descriptorsetlayouts = {
+		renderpass.getDescriptorSetLayout(),
+		renderpass.getLightDescriptorSetLayout()
+	};
+
+	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorsetlayouts.size());
+	pipelineLayoutInfo.pSetLayouts = descriptorsetlayouts.data();
+
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(ObjectPushConstants);
+
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+	VkPipelineLayout pipelineLayout;
+	if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+		throw std::runtime_error("failed to create pipeline layout");
+
+	return pipelineLayout;
+}
+
 VkShaderModule Engine::Graphics::Pipeline::createShaderModule(VkDevice device, const std::vector<char>& code)
 {
 	VkShaderModuleCreateInfo createInfo{};
@@ -0,0 +1,163 @@
+#include "pipelineCache.h"
+#include "device.h"
+
+std::unique_ptr<Engine::Graphics::PipelineCache> pipelineCache;
+
+void Engine::Graphics::PipelineCache::create(const Engine::Graphics::Device& device, const std::string& path)
+{
+	this->device = device.getDevice();
+	this->path = path;
+	vkGetPhysicalDeviceProperties(device.getPhysicalDevice(), &properties);
+
+	std::vector<char> data = load();
+	loadedSize = data.size();
+
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = data.size();
+	createInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+	if (vkCreatePipelineCache(this->device, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+		// the driver may still reject data that passed our checks; start cold instead
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData = nullptr;
+		loadedSize = 0;
+
+		if (vkCreatePipelineCache(this->device, &createInfo, nullptr, &cache) != VK_SUCCESS)
+			throw std::runtime_error("failed to create pipeline cache");
+	}
+
+	if (isWarm())
+		g_console.add("[Pipeline Cache] loaded %zu bytes from %s\n", loadedSize, path.c_str());
+	else
+		g_console.add("[Pipeline Cache] starting cold\n");
+}
+
+void Engine::Graphics::PipelineCache::save() const
+{
+	if (cache == VK_NULL_HANDLE)
+		return;
+
+	size_t size = 0;
+	if (vkGetPipelineCacheData(device, cache, &size, nullptr) != VK_SUCCESS || size == 0)
+		return;
+
+	std::vector<char> data(size);
+	if (vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS)
+		return;
+
+	FileHeader header{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.vendorID = properties.vendorID;
+	header.deviceID = properties.deviceID;
+	header.driverVersion = properties.driverVersion;
+	memcpy(header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+	header.dataSize = size;
+
+	std::filesystem::path target(path);
+	std::filesystem::path temp = target;
+	temp += ".tmp";
+
+	std::error_code ec;
+	if (target.has_parent_path())
+		std::filesystem::create_directories(target.parent_path(), ec);
+
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			g_console.add("[Pipeline Cache] failed to open %s for writing\n", temp.string().c_str());
+			return;
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(data.data(), static_cast<std::streamsize>(size));
+
+		if (!file.good()) {
+			file.close();
+			std::filesystem::remove(temp, ec);
+			g_console.add("[Pipeline Cache] failed to write %s\n", temp.string().c_str());
+			return;
+		}
+	}
+
+	// rename over the old file so a crash mid-write never leaves a truncated cache behind
+	std::filesystem::rename(temp, target, ec);
+	if (ec) {
+		std::filesystem::remove(temp, ec);
+		g_console.add("[Pipeline Cache] failed to replace %s\n", path.c_str());
+		return;
+	}
+
+	g_console.add("[Pipeline Cache] saved %zu bytes to %s\n", size, path.c_str());
+}
+
+void Engine::Graphics::PipelineCache::destroy()
+{
+	if (cache != VK_NULL_HANDLE) {
+		vkDestroyPipelineCache(device, cache, nullptr);
+		cache = VK_NULL_HANDLE;
+	}
+
+	device = VK_NULL_HANDLE;
+	loadedSize = 0;
+}
+
+std::vector<char> Engine::Graphics::PipelineCache::load() const
+{
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open())
+		return {};
+
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	if (fileSize < sizeof(FileHeader))
+		return {};
+
+	FileHeader header{};
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (header.magic != MAGIC || header.version != VERSION) {
+		g_console.add("[Pipeline Cache] discarding %s, it is not a pipeline cache of this version\n", path.c_str());
+		return {};
+	}
+
+	if (!validate(header)) {
+		g_console.add("[Pipeline Cache] discarding %s, it was written by another device or driver\n", path.c_str());
+		return {};
+	}
+
+	if (header.dataSize != fileSize - sizeof(FileHeader)) {
+		g_console.add("[Pipeline Cache] discarding %s, it is truncated or corrupt\n", path.c_str());
+		return {};
+	}
+
+	std::vector<char> data(static_cast<size_t>(header.dataSize));
+	file.read(data.data(), static_cast<std::streamsize>(data.size()));
+	if (!file.good())
+		return {};
+
+	if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne))
+		return {};
+
+	VkPipelineCacheHeaderVersionOne vkHeader{};
+	memcpy(&vkHeader, data.data(), sizeof(vkHeader));
+
+	if (vkHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+		vkHeader.vendorID != properties.vendorID ||
+		vkHeader.deviceID != properties.deviceID ||
+		memcmp(vkHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+		return {};
+
+	return data;
+}
+
+bool Engine::Graphics::PipelineCache::validate(const FileHeader& header) const
+{
+	return header.magic == MAGIC &&
+		header.version == VERSION &&
+		header.vendorID == properties.vendorID &&
+		header.deviceID == properties.deviceID &&
+		header.driverVersion == properties.driverVersion &&
+		memcmp(header.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,130 @@
+#include "pipelineRegistry.h"
+
+size_t Engine::Graphics::PipelineKeyHash::operator()(const PipelineKey& key) const
+{
+	size_t seed = std::hash<std::string>()(key.vertexShader);
+
+	auto combine = [&seed](size_t value) {
+		seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	};
+
+	combine(std::hash<std::string>()(key.fragmentShader));
+	combine(key.vertexType.hash_code());
+	combine(static_cast<size_t>(key.isCube));
+	combine(static_cast<size_t>(key.samples));
+
+	return seed;
+}
+
+Engine::Graphics::Pipeline Engine::Graphics::PipelineRegistry::get(const PipelineKey& key) const
+{
+	auto it = pipelines.find(key);
+	if (it == pipelines.end() || it->second.pending.valid())
+		return Pipeline{};
+
+	return it->second.pipeline;
+}
+
+size_t Engine::Graphics::PipelineRegistry::poll()
+{
+	size_t completed = 0;
+
+	for (auto& [key, entry] : pipelines) {
+		if (!entry.pending.valid() || entry.pending.wait_for(std::chrono::seconds(0)) == std::future_status::timeout)
+			continue;
+
+		// a failed compile leaves the entry without a pipeline, so its entities stay out of the
+		// draw order instead of the exception escaping the frame loop
+		try {
+			entry.pipeline = entry.pending.get();
+		}
+		catch (const std::exception& e) {
+			entry.failed = true;
+			g_console.add("[Pipeline Registry] failed to compile %s + %s: %s\n", key.vertexShader.c_str(), key.fragmentShader.c_str(), e.what());
+			continue;
+		}
+		completed++;
+
+		g_console.add("[Pipeline Registry] compiled %s + %s\n", key.vertexShader.c_str(), key.fragmentShader.c_str());
+	}
+
+	std::erase_if(orphaned, [](std::future<Pipeline>& pending) {
+		if (pending.wait_for(std::chrono::seconds(0)) == std::future_status::timeout)
+			return false;
+
+		try {
+			resources->defer([handle = pending.get().getGraphicsPipeline()](VkDevice device) {
+				vkDestroyPipeline(device, handle, nullptr);
+			});
+		}
+		catch (const std::exception& e) {
+			g_console.add("[Pipeline Registry] discarded failed compile: %s\n", e.what());
+		}
+		return true;
+	});
+
+	return completed;
+}
+
+void Engine::Graphics::PipelineRegistry::release(const PipelineKey& key)
+{
+	auto it = pipelines.find(key);
+	if (it == pipelines.end())
+		return;
+
+	Entry& entry = it->second;
+	if (entry.refCount > 0)
+		entry.refCount--;
+
+	if (entry.refCount > 0 || entry.resident)
+		return;
+
+	if (entry.pending.valid()) {
+		// still compiling; destroy it once the worker hands it back
+		orphaned.push_back(std::move(entry.pending));
+	}
+	else if (!entry.failed) {
+		resources->defer([handle = entry.pipeline.getGraphicsPipeline()](VkDevice device) {
+			vkDestroyPipeline(device, handle, nullptr);
+		});
+	}
+
+	pipelines.erase(it);
+}
+
+void Engine::Graphics::PipelineRegistry::destroy(VkDevice device)
+{
+	for (auto& [key, entry] : pipelines) {
+		if (entry.pending.valid())
+			orphaned.push_back(std::move(entry.pending));
+		else if (!entry.failed)
+			vkDestroyPipeline(device, entry.pipeline.getGraphicsPipeline(), nullptr);
+	}
+	pipelines.clear();
+
+	for (auto& pending : orphaned) {
+		try {
+			vkDestroyPipeline(device, pending.get().getGraphicsPipeline(), nullptr);
+		}
+		catch (const std::exception& e) {
+			g_console.add("[Pipeline Registry] discarded failed compile: %s\n", e.what());
+		}
+	}
+	orphaned.clear();
+
+	if (pipelineLayout != VK_NULL_HANDLE) {
+		vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+		pipelineLayout = VK_NULL_HANDLE;
+	}
+}
+
+std::string Engine::Graphics::PipelineRegistry::normalizePath(const std::string& path)
+{
+	// entities added through the file browser use absolute paths, built-ins use relative ones
+	std::error_code ec;
+	std::filesystem::path normalized = std::filesystem::weakly_canonical(path, ec);
+	if (ec)
+		return std::filesystem::path(path).lexically_normal().string();
+
+	return normalized.string();
+}
@@ -4,6 +4,7 @@
 #include "commandBuffer.h"
 #include "rtSceneManager.h"
 #include "swapchain.h"
+#include "pipelineCache.h"
 
 void AccelerationStructure::create(Engine::Graphics::Device device, VkAccelerationStructureTypeKHR type, VkAccelerationStructureBuildSizesInfoKHR buildSizeInfo)
 {
@@ -16,22 +17,13 @@ ScratchBuffer::ScratchBuffer(Engine::Graphics::Device device, VkDeviceSize size)
 	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	bufferCreateInfo.size = size;
 	bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
-	vkCreateBuffer(device.getDevice(), &bufferCreateInfo, nullptr, &handle);
 
-	VkMemoryRequirements memoryRequirements{};
-	vkGetBufferMemoryRequirements(device.getDevice(), handle, &memoryRequirements);
+	VmaAllocationCreateInfo allocCreateInfo{};
+	allocCreateInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	allocCreateInfo.pool = resources->getAccelerationStructurePool();
 
-	VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo{};
-	memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-	memoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
-	
-	VkMemoryAllocateInfo memoryAllocateInfo{};
-	memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	memoryAllocateInfo.pNext = &memoryAllocateFlagsInfo;
-	memoryAllocateInfo.allocationSize = memoryRequirements.size;
-	memoryAllocateInfo.memoryTypeIndex = Engine::Utility::findMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, device.getPhysicalDevice());
-	vkAllocateMemory(device.getDevice(), &memoryAllocateInfo, nullptr, &memory);
-	vkBindBufferMemory(device.getDevice(), handle, memory, 0);
+	if (vmaCreateBuffer(resources->getAllocator(), &bufferCreateInfo, &allocCreateInfo, &handle, &allocation, nullptr) != VK_SUCCESS)
+		throw std::runtime_error("failed to create scratch buffer");
 
 	VkBufferDeviceAddressInfoKHR bufferDeviceAddressInfo{};
 	bufferDeviceAddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
@@ -39,6 +31,13 @@ ScratchBuffer::ScratchBuffer(Engine::Graphics::Device device, VkDeviceSize size)
 	deviceAddress = fpGetBufferDeviceAddressKHR(device.getDevice(), &bufferDeviceAddressInfo);
 }
 
+void ScratchBuffer::destroy()
+{
+	vmaDestroyBuffer(resources->getAllocator(), handle, allocation);
+	handle = VK_NULL_HANDLE;
+	allocation = VK_NULL_HANDLE;
+}
+
 void StorageImage::create(Engine::Graphics::Device device, VkQueue queue, VkCommandPool commandPool, VkFormat format, VkExtent3D extent) 
 {
 	VkImageCreateInfo imageInfo{};
@@ -52,17 +51,13 @@ void StorageImage::create(Engine::Graphics::Device device, VkQueue queue, VkComm
 	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
 	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	vkCreateImage(device.getDevice(), &imageInfo, nullptr, &image);
 
-	VkMemoryRequirements memoryRequirements{};
-	vkGetImageMemoryRequirements(device.getDevice(), image, &memoryRequirements);
+	VmaAllocationCreateInfo allocCreateInfo{};
+	allocCreateInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	allocCreateInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
 
-	VkMemoryAllocateInfo memoryAllocateInfo{};
-	memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	memoryAllocateInfo.allocationSize = memoryRequirements.size;
-	memoryAllocateInfo.memoryTypeIndex = Engine::Utility::findMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, device.getPhysicalDevice());
-	vkAllocateMemory(device.getDevice(), &memoryAllocateInfo, nullptr, &memory);
-	vkBindImageMemory(device.getDevice(), image, memory, 0);
+	if (vmaCreateImage(resources->getAllocator(), &imageInfo, &allocCreateInfo, &image, &allocation, nullptr) != VK_SUCCESS)
+		throw std::runtime_error("failed to create storage image");
 
 	VkImageViewCreateInfo colorImageView{};
 	colorImageView.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -137,12 +132,9 @@ void StorageImage::destroy(VkDevice device)
 		view = VK_NULL_HANDLE;
 	}
 	if (image != VK_NULL_HANDLE) {
-		vkDestroyImage(device, image, nullptr);
+		vmaDestroyImage(resources->getAllocator(), image, allocation);
 		image = VK_NULL_HANDLE;
-	}
-	if (memory != VK_NULL_HANDLE) {
-		vkFreeMemory(device, memory, nullptr);
-		memory = VK_NULL_HANDLE;
+		allocation = VK_NULL_HANDLE;
 	}
 }
 
@@ -359,62 +351,69 @@ void Engine::Graphics::Raytracing::createTopLevelAccelerationStructure(Engine::G
 		blasInstances.push_back(createBottomLevelAccelerationStructure(device, i));
 	}
 
-	instanceBuffer = framebuffer.createBuffer(device, sizeof(VkAccelerationStructureInstanceKHR) * blasInstances.size(), VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, blasInstances.data());
+	constexpr uint32_t frameCount = Engine::Settings::MAX_FRAMES_IN_FLIGHT;
+	uint32_t primitiveCount = static_cast<uint32_t>(blasInstances.size());
 
-	VkDeviceOrHostAddressConstKHR instanceDataDeviceAddress{};
-	instanceDataDeviceAddress.deviceAddress = getBufferDeviceAddress(device.getDevice(), instanceBuffer->buffer);
+	std::array<VkAccelerationStructureGeometryKHR, frameCount> geometries{};
+	std::array<VkAccelerationStructureBuildGeometryInfoKHR, frameCount> buildInfos{};
 
-	VkAccelerationStructureGeometryKHR accelerationStructureGeometry{};
-	accelerationStructureGeometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
-	accelerationStructureGeometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
-	accelerationStructureGeometry.flags = VK_GEOMETRY_NO_DUPLICATE_ANY_HIT_INVOCATION_BIT_KHR;
-	accelerationStructureGeometry.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
-	accelerationStructureGeometry.geometry.instances.arrayOfPointers = VK_FALSE;
-	accelerationStructureGeometry.geometry.instances.data = instanceDataDeviceAddress;
+	VkAccelerationStructureBuildRangeInfoKHR accelerationStructureBuildRangeInfo{};
+	accelerationStructureBuildRangeInfo.primitiveCount = primitiveCount;
+	accelerationStructureBuildRangeInfo.primitiveOffset = 0;
+	accelerationStructureBuildRangeInfo.firstVertex = 0;
+	accelerationStructureBuildRangeInfo.transformOffset = 0;
 
-	VkAccelerationStructureBuildGeometryInfoKHR accelerationStructureBuildGeometryInfo{};
-	accelerationStructureBuildGeometryInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
-	accelerationStructureBuildGeometryInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-	accelerationStructureBuildGeometryInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
-	accelerationStructureBuildGeometryInfo.geometryCount = 1;
-	accelerationStructureBuildGeometryInfo.pGeometries = &accelerationStructureGeometry;
-	accelerationStructureBuildGeometryInfo.pNext = nullptr;
+	std::vector<VkAccelerationStructureBuildRangeInfoKHR*> accelerationBuildStructureRangeInfos(frameCount, &accelerationStructureBuildRangeInfo);
 
-	uint32_t primitiveCount = static_cast<uint32_t>(blasInstances.size());
+	for (uint32_t i = 0; i < frameCount; i++) {
+		RaytracingFrame& frame = frames[i];
 
-	VkAccelerationStructureBuildSizesInfoKHR accelerationStructureBuildSizesInfo{};
-	accelerationStructureBuildSizesInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-	
-	fpGetAccelerationStructureBuildSizesKHR(device.getDevice(), VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &accelerationStructureBuildGeometryInfo, &primitiveCount, &accelerationStructureBuildSizesInfo);
+		frame.instanceBuffer = framebuffer.createBuffer(device, sizeof(VkAccelerationStructureInstanceKHR) * blasInstances.size(), VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, blasInstances.data());
 
-	TLAS.create(device, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR, accelerationStructureBuildSizesInfo);
+		VkDeviceOrHostAddressConstKHR instanceDataDeviceAddress{};
+		instanceDataDeviceAddress.deviceAddress = getBufferDeviceAddress(device.getDevice(), frame.instanceBuffer->buffer);
 
-	if (TLAS.resource->handle == VK_NULL_HANDLE) {
-		throw std::runtime_error("failed to create TLAS acceleration structures");
-	}
+		VkAccelerationStructureGeometryKHR& accelerationStructureGeometry = geometries[i];
+		accelerationStructureGeometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
+		accelerationStructureGeometry.geometryType = VK_GEOMETRY_TYPE_INSTANCES_KHR;
+		accelerationStructureGeometry.flags = VK_GEOMETRY_NO_DUPLICATE_ANY_HIT_INVOCATION_BIT_KHR;
+		accelerationStructureGeometry.geometry.instances.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
+		accelerationStructureGeometry.geometry.instances.arrayOfPointers = VK_FALSE;
+		accelerationStructureGeometry.geometry.instances.data = instanceDataDeviceAddress;
 
-	ScratchBuffer scratchBuffer(device, accelerationStructureBuildSizesInfo.buildScratchSize);
+		VkAccelerationStructureBuildGeometryInfoKHR accelerationStructureBuildGeometryInfo{};
+		accelerationStructureBuildGeometryInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+		accelerationStructureBuildGeometryInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+		accelerationStructureBuildGeometryInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
+		accelerationStructureBuildGeometryInfo.geometryCount = 1;
+		accelerationStructureBuildGeometryInfo.pGeometries = &accelerationStructureGeometry;
+		accelerationStructureBuildGeometryInfo.pNext = nullptr;
 
-	VkAccelerationStructureBuildGeometryInfoKHR accelerationBuildGeometryInfo{};
-	accelerationBuildGeometryInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
-	accelerationBuildGeometryInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-	accelerationBuildGeometryInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
-	accelerationBuildGeometryInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-	accelerationBuildGeometryInfo.dstAccelerationStructure = TLAS.resource->handle;
-	accelerationBuildGeometryInfo.geometryCount = 1;
-	accelerationBuildGeometryInfo.pGeometries = &accelerationStructureGeometry;
-	accelerationBuildGeometryInfo.scratchData.deviceAddress = scratchBuffer.deviceAddress;
+		VkAccelerationStructureBuildSizesInfoKHR accelerationStructureBuildSizesInfo{};
+		accelerationStructureBuildSizesInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
 
-	VkAccelerationStructureBuildRangeInfoKHR accelerationStructureBuildRangeInfo{};
-	accelerationStructureBuildRangeInfo.primitiveCount = primitiveCount;
-	accelerationStructureBuildRangeInfo.primitiveOffset = 0;
-	accelerationStructureBuildRangeInfo.firstVertex = 0;
-	accelerationStructureBuildRangeInfo.transformOffset = 0;
+		fpGetAccelerationStructureBuildSizesKHR(device.getDevice(), VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &accelerationStructureBuildGeometryInfo, &primitiveCount, &accelerationStructureBuildSizesInfo);
 
-	std::vector<VkAccelerationStructureBuildRangeInfoKHR*> accelerationBuildStructureRangeInfos = { &accelerationStructureBuildRangeInfo };
+		frame.TLAS.create(device, VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR, accelerationStructureBuildSizesInfo);
+
+		if (frame.TLAS.resource->handle == VK_NULL_HANDLE) {
+			throw std::runtime_error("failed to create TLAS acceleration structures");
+		}
+
+		// kept for the frame's later refits instead of being allocated per update
+		frame.scratchBuffer.emplace(device, std::max(accelerationStructureBuildSizesInfo.buildScratchSize, accelerationStructureBuildSizesInfo.updateScratchSize));
+		frame.instanceVersion = instanceVersion;
+		frame.modelVersion = modelVersion;
+
+		VkAccelerationStructureBuildGeometryInfoKHR& accelerationBuildGeometryInfo = buildInfos[i];
+		accelerationBuildGeometryInfo = accelerationStructureBuildGeometryInfo;
+		accelerationBuildGeometryInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+		accelerationBuildGeometryInfo.dstAccelerationStructure = frame.TLAS.resource->handle;
+		accelerationBuildGeometryInfo.scratchData.deviceAddress = frame.scratchBuffer->deviceAddress;
+	}
 
 	if (accelerationStructureFeatures.accelerationStructureHostCommands) {
-		fpBuildAccelerationStructuresKHR(device.getDevice(), VK_NULL_HANDLE, 1, &accelerationBuildGeometryInfo, accelerationBuildStructureRangeInfos.data());
+		fpBuildAccelerationStructuresKHR(device.getDevice(), VK_NULL_HANDLE, frameCount, buildInfos.data(), accelerationBuildStructureRangeInfos.data());
 	}
 	else {
 		VkCommandBuffer cmdbuf = commandBuffer.beginSingleTimeCommands(device.getDevice());
@@ -434,16 +433,23 @@ void Engine::Graphics::Raytracing::createTopLevelAccelerationStructure(Engine::G
 			0, nullptr
 		);
 
-		fpCmdBuildAccelerationStructuresKHR(cmdbuf, 1, &accelerationBuildGeometryInfo, accelerationBuildStructureRangeInfos.data());
+		fpCmdBuildAccelerationStructuresKHR(cmdbuf, frameCount, buildInfos.data(), accelerationBuildStructureRangeInfos.data());
 		commandBuffer.endSingleTimeCommands(cmdbuf, device.getGraphicsQueue(), device.getDevice());
 	}
-
-	vkDestroyBuffer(device.getDevice(), scratchBuffer.handle, nullptr);
-	vkFreeMemory(device.getDevice(), scratchBuffer.memory, nullptr);
 }
 
-void Engine::Graphics::Raytracing::updateTopLevelAccelerationStructure(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::CommandBuffer commandBuffer, bool rebuild)
+void Engine::Graphics::Raytracing::updateTopLevelAccelerationStructure(Engine::Graphics::Device device, VkCommandBuffer commandBuffer, uint32_t frameIndex)
 {
+	RaytracingFrame& frame = frames[frameIndex];
+
+	// the caller has waited on this frame's fence, so its instance buffer, TLAS and
+	// descriptor set are idle
+	if (!frame.TLAS.resource || (frame.instanceVersion == instanceVersion && frame.modelVersion == modelVersion))
+		return;
+
+	// a refit needs the same instances the TLAS was built from; after a removal it is rebuilt
+	const bool rebuild = frame.modelVersion != modelVersion;
+
 	std::vector<VkAccelerationStructureInstanceKHR> blasInstances(BLAS.size());
 
 	for (uint32_t i = 0; i < BLAS.size(); ++i) {
@@ -460,37 +466,12 @@ void Engine::Graphics::Raytracing::updateTopLevelAccelerationStructure(Engine::G
 		blasInstances[i].accelerationStructureReference = deviceAddress;
 	}
 
-	void* data;
-	vkMapMemory(device.getDevice(), instanceBuffer->memory, 0, VK_WHOLE_SIZE, 0, &data);
-	memcpy(data, blasInstances.data(), blasInstances.size() * sizeof(VkAccelerationStructureInstanceKHR));
-	vkUnmapMemory(device.getDevice(), instanceBuffer->memory);
-
-	VkDescriptorBufferInfo bufferInfo{};
-	bufferInfo.buffer = instanceBuffer->buffer;
-	bufferInfo.offset = 0;
-	bufferInfo.range = VK_WHOLE_SIZE;
-
-	VkWriteDescriptorSet descriptorWrite{};
-	descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	descriptorWrite.dstSet = descriptorSet;
-	descriptorWrite.dstBinding = 8;
-	descriptorWrite.dstArrayElement = 0;
-	descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	descriptorWrite.descriptorCount = 1;
-	descriptorWrite.pBufferInfo = &bufferInfo;
-
-	vkUpdateDescriptorSets(device.getDevice(), 1, &descriptorWrite, 0, nullptr);
-
-	VkMappedMemoryRange memoryRange{};
-	memoryRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-	memoryRange.memory = instanceBuffer->memory;
-	memoryRange.size = VK_WHOLE_SIZE;
-	vkFlushMappedMemoryRanges(device.getDevice(), 1, &memoryRange);
+	memcpy(frame.instanceBuffer->mapped, blasInstances.data(), blasInstances.size() * sizeof(VkAccelerationStructureInstanceKHR));
 
-	vkUnmapMemory(device.getDevice(), instanceBuffer->memory);
+	vmaFlushAllocation(resources->getAllocator(), frame.instanceBuffer->allocation, 0, VK_WHOLE_SIZE);
 
 	VkDeviceOrHostAddressConstKHR instanceDataDeviceAddress{};
-	instanceDataDeviceAddress.deviceAddress = getBufferDeviceAddress(device.getDevice(), instanceBuffer->buffer);
+	instanceDataDeviceAddress.deviceAddress = getBufferDeviceAddress(device.getDevice(), frame.instanceBuffer->buffer);
 
 	VkAccelerationStructureGeometryKHR geometry{};
 	geometry.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR;
@@ -504,40 +485,26 @@ void Engine::Graphics::Raytracing::updateTopLevelAccelerationStructure(Engine::G
 	buildInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
 	buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
 	buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR | VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
-	buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
-	buildInfo.srcAccelerationStructure = TLAS.resource->handle;
-	buildInfo.dstAccelerationStructure = TLAS.resource->handle;
+	buildInfo.mode = rebuild ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+	buildInfo.srcAccelerationStructure = rebuild ? VK_NULL_HANDLE : frame.TLAS.resource->handle;
+	buildInfo.dstAccelerationStructure = frame.TLAS.resource->handle;
 	buildInfo.geometryCount = 1;
 	buildInfo.pGeometries = &geometry;
-
-	VkAccelerationStructureBuildSizesInfoKHR buildSizesInfo{};
-	buildSizesInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR;
-	uint32_t primitiveCount = static_cast<uint32_t>(blasInstances.size());
-
-	fpGetAccelerationStructureBuildSizesKHR(
-		device.getDevice(),
-		VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
-		&buildInfo,
-		&primitiveCount,
-		&buildSizesInfo
-	);
-
-	ScratchBuffer scratchBuffer(device, rebuild ? buildSizesInfo.buildScratchSize : buildSizesInfo.updateScratchSize);
-	buildInfo.scratchData.deviceAddress = scratchBuffer.deviceAddress;
+	buildInfo.scratchData.deviceAddress = frame.scratchBuffer->deviceAddress;
 
 	VkAccelerationStructureBuildRangeInfoKHR rangeInfo{};
 	rangeInfo.primitiveCount = static_cast<uint32_t>(blasInstances.size());
 
 	std::vector<VkAccelerationStructureBuildRangeInfoKHR*> rangeInfos = { &rangeInfo };
 
-	VkCommandBuffer cmdbuf = commandBuffer.beginSingleTimeCommands(device.getDevice());
+	// recorded into the frame's own command buffer, ahead of the trace that reads it
 	VkMemoryBarrier hostWriteBarrier{};
 	hostWriteBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
 	hostWriteBarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
 	hostWriteBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
 
 	vkCmdPipelineBarrier(
-		cmdbuf,
+		commandBuffer,
 		VK_PIPELINE_STAGE_HOST_BIT,
 		VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
 		0,
@@ -546,7 +513,7 @@ void Engine::Graphics::Raytracing::updateTopLevelAccelerationStructure(Engine::G
 		0, nullptr
 	);
 	
-	fpCmdBuildAccelerationStructuresKHR(cmdbuf, 1, &buildInfo, rangeInfos.data());
+	fpCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &buildInfo, rangeInfos.data());
 	
 	VkMemoryBarrier asBarrier{};
 	asBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
@@ -555,7 +522,7 @@ void Engine::Graphics::Raytracing::updateTopLevelAccelerationStructure(Engine::G
 		VK_ACCESS_SHADER_READ_BIT;
 
 	vkCmdPipelineBarrier(
-		cmdbuf,
+		commandBuffer,
 		VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
 		VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
 		0,
@@ -564,25 +531,27 @@ void Engine::Graphics::Raytracing::updateTopLevelAccelerationStructure(Engine::G
 		0, nullptr
 	);
 
-	commandBuffer.endSingleTimeCommands(cmdbuf, device.getGraphicsQueue(), device.getDevice());
+	if (rebuild) {
+		writeModelDescriptors(device.getDevice(), frame);
+	}
 
-	VkWriteDescriptorSetAccelerationStructureKHR asWrite{};
-	asWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
-	asWrite.accelerationStructureCount = 1;
-	asWrite.pAccelerationStructures = &TLAS.resource->handle;
+	frame.instanceVersion = instanceVersion;
+	frame.modelVersion = modelVersion;
+}
 
-	VkWriteDescriptorSet tlasDescriptorWrite{};
-	tlasDescriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	tlasDescriptorWrite.pNext = &asWrite;
-	tlasDescriptorWrite.dstSet = descriptorSet;
-	tlasDescriptorWrite.dstBinding = 0;
-	tlasDescriptorWrite.descriptorCount = 1;
-	tlasDescriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+void Engine::Graphics::Raytracing::removeModel(const std::shared_ptr<RTScene>& model)
+{
+	auto it = std::find(models.begin(), models.end(), model);
+	if (it == models.end())
+		return;
 
-	vkUpdateDescriptorSets(device.getDevice(), 1, &tlasDescriptorWrite, 0, nullptr);
+	// the BLAS is only freed once every frame that may still trace against it has retired
+	const size_t index = static_cast<size_t>(it - models.begin());
+	resources->destroy(BLAS[index].resource);
 
-	vkDestroyBuffer(device.getDevice(), scratchBuffer.handle, nullptr);
-	vkFreeMemory(device.getDevice(), scratchBuffer.memory, nullptr);
+	BLAS.erase(BLAS.begin() + index);
+	models.erase(it);
+	modelVersion++;
 }
 
 void Engine::Graphics::Raytracing::buildAccelerationStructure(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandbuffer, Engine::Graphics::FrameBuffer framebuffer)
@@ -623,46 +592,45 @@ void Engine::Graphics::Raytracing::createShaderBindingTables(Engine::Graphics::D
 void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::Device& device, std::optional<Engine::Graphics::Texture> skyboxTexture)
 {
 	uint32_t modelBufferSize = std::max(static_cast<uint32_t>(models.size()), 1u);
+	constexpr uint32_t frameCount = Engine::Settings::MAX_FRAMES_IN_FLIGHT;
 
+	// one set per frame in flight, so a frame can repoint its TLAS and model arrays while
+	// earlier frames still read theirs
 	std::vector<VkDescriptorPoolSize> poolSizes = {
-		{ VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1 },
-		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2 },
-		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1 },
-		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 * modelBufferSize},
-		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 7 * modelBufferSize + 1},
+		{ VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, frameCount },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2 * frameCount },
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, frameCount },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 * modelBufferSize * frameCount },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (5 * modelBufferSize + 1) * frameCount },
 	};
 
 	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
 	descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
 	descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
 	descriptorPoolCreateInfo.pPoolSizes = poolSizes.data();
-	descriptorPoolCreateInfo.maxSets = 1;
+	descriptorPoolCreateInfo.maxSets = frameCount;
 
 	vkCreateDescriptorPool(device.getDevice(), &descriptorPoolCreateInfo, nullptr, &descriptorPool);
 
+	std::array<VkDescriptorSetLayout, frameCount> setLayouts;
+	setLayouts.fill(descriptorSetLayout);
+
+	std::array<VkDescriptorSet, frameCount> descriptorSets{};
+
 	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo{};
 	descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	descriptorSetAllocateInfo.descriptorPool = descriptorPool;
-	descriptorSetAllocateInfo.pSetLayouts = &descriptorSetLayout;
-	descriptorSetAllocateInfo.descriptorSetCount = 1;
+	descriptorSetAllocateInfo.pSetLayouts = setLayouts.data();
+	descriptorSetAllocateInfo.descriptorSetCount = frameCount;
 
-	vkAllocateDescriptorSets(device.getDevice(), &descriptorSetAllocateInfo, &descriptorSet);
+	vkAllocateDescriptorSets(device.getDevice(), &descriptorSetAllocateInfo, descriptorSets.data());
 
-	std::vector<VkWriteDescriptorSet> writeDescriptorSets;
+	for (uint32_t i = 0; i < frameCount; i++) {
+		frames[i].descriptorSet = descriptorSets[i];
+	}
 
-	VkWriteDescriptorSetAccelerationStructureKHR descriptorAccelerationStructureInfo{};
-	descriptorAccelerationStructureInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
-	descriptorAccelerationStructureInfo.accelerationStructureCount = 1;
-	descriptorAccelerationStructureInfo.pAccelerationStructures = &TLAS.resource->handle;
-
-	VkWriteDescriptorSet accelerationStructureWrite{};
-	accelerationStructureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	accelerationStructureWrite.pNext = &descriptorAccelerationStructureInfo;
-	accelerationStructureWrite.dstSet = descriptorSet;
-	accelerationStructureWrite.dstBinding = 0;
-	accelerationStructureWrite.descriptorCount = 1;
-	accelerationStructureWrite.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
-	writeDescriptorSets.push_back(accelerationStructureWrite);
+	// what every frame's set shares; the per-model bindings are written by writeModelDescriptors
+	std::vector<VkWriteDescriptorSet> writeDescriptorSets;
 
 	VkDescriptorImageInfo storageImageInfo{};
 	storageImageInfo.imageView = storageImage.view;
@@ -674,7 +642,6 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 
 	VkWriteDescriptorSet storageImageWrite{};
 	storageImageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	storageImageWrite.dstSet = descriptorSet;
 	storageImageWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 	storageImageWrite.dstBinding = 1;
 	storageImageWrite.pImageInfo = &storageImageInfo;
@@ -683,7 +650,6 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 
 	VkWriteDescriptorSet accumImageWrite{};
 	accumImageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	accumImageWrite.dstSet = descriptorSet;
 	accumImageWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 	accumImageWrite.dstBinding = 2;
 	accumImageWrite.pImageInfo = &accumImageInfo;
@@ -697,13 +663,89 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 
 	VkWriteDescriptorSet uboWrite{};
 	uboWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	uboWrite.dstSet = descriptorSet;
-	uboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	uboWrite.dstBinding = 3;
 	uboWrite.pBufferInfo = &uboInfo;
 	uboWrite.descriptorCount = 1;
 	writeDescriptorSets.push_back(uboWrite);
 
+	// outlives the if, since the writes are only applied per frame below
+	VkDescriptorImageInfo skyboxInfo{};
+	if (skyboxTexture.has_value()) {
+		skyboxInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		skyboxInfo.imageView = skyboxTexture.value().textureResource->view;
+		skyboxInfo.sampler = skyboxTexture.value().textureResource->sampler;
+
+		VkWriteDescriptorSet skyboxWrite{};
+		skyboxWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		skyboxWrite.dstBinding = 6;
+		skyboxWrite.dstArrayElement = 0;
+		skyboxWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		skyboxWrite.descriptorCount = 1;
+		skyboxWrite.pImageInfo = &skyboxInfo;
+		writeDescriptorSets.push_back(skyboxWrite);
+	}
+
+	for (RaytracingFrame& frame : frames) {
+		frame.textureFlagBuffer = resources->create<BufferResource>(
+			device.getDevice(),
+			device.getPhysicalDevice(),
+			sizeof(uint32_t) * modelBufferSize,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		);
+
+		std::vector<VkWriteDescriptorSet> frameWrites = writeDescriptorSets;
+		for (auto& write : frameWrites) {
+			write.dstSet = frame.descriptorSet;
+		}
+
+		vkUpdateDescriptorSets(
+			device.getDevice(),
+			static_cast<uint32_t>(frameWrites.size()),
+			frameWrites.data(),
+			0,
+			nullptr
+		);
+
+		writeModelDescriptors(device.getDevice(), frame);
+	}
+}
+
+void Engine::Graphics::Raytracing::writeModelDescriptors(VkDevice device, RaytracingFrame& frame)
+{
+	std::vector<VkWriteDescriptorSet> writeDescriptorSets;
+
+	VkWriteDescriptorSetAccelerationStructureKHR descriptorAccelerationStructureInfo{};
+	VkDescriptorBufferInfo instanceTransformInfo{};
+
+	// an empty scene has no TLAS to point at
+	if (frame.TLAS.resource) {
+		descriptorAccelerationStructureInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+		descriptorAccelerationStructureInfo.accelerationStructureCount = 1;
+		descriptorAccelerationStructureInfo.pAccelerationStructures = &frame.TLAS.resource->handle;
+
+		VkWriteDescriptorSet accelerationStructureWrite{};
+		accelerationStructureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		accelerationStructureWrite.pNext = &descriptorAccelerationStructureInfo;
+		accelerationStructureWrite.dstBinding = 0;
+		accelerationStructureWrite.descriptorCount = 1;
+		accelerationStructureWrite.descriptorType = VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+		writeDescriptorSets.push_back(accelerationStructureWrite);
+
+		instanceTransformInfo.buffer = frame.instanceBuffer->buffer;
+		instanceTransformInfo.offset = 0;
+		instanceTransformInfo.range = VK_WHOLE_SIZE;
+
+		VkWriteDescriptorSet instanceTransformWrite{};
+		instanceTransformWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		instanceTransformWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		instanceTransformWrite.dstBinding = 8;
+		instanceTransformWrite.descriptorCount = 1;
+		instanceTransformWrite.pBufferInfo = &instanceTransformInfo;
+		writeDescriptorSets.push_back(instanceTransformWrite);
+	}
+
 	std::vector<VkDescriptorBufferInfo> vBufferInfos;
 	for (auto& model : models) {
 		if (model->obj.vertex) {
@@ -714,7 +756,6 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 	if (!vBufferInfos.empty()) {
 		VkWriteDescriptorSet vBufferWrite{};
 		vBufferWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		vBufferWrite.dstSet = descriptorSet;
 		vBufferWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 		vBufferWrite.dstBinding = 4;
 		vBufferWrite.descriptorCount = static_cast<uint32_t>(vBufferInfos.size());
@@ -732,7 +773,6 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 	if (!iBufferInfos.empty()) {
 		VkWriteDescriptorSet iBufferWrite{};
 		iBufferWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		iBufferWrite.dstSet = descriptorSet;
 		iBufferWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 		iBufferWrite.dstBinding = 5;
 		iBufferWrite.descriptorCount = static_cast<uint32_t>(iBufferInfos.size());
@@ -740,44 +780,11 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 		writeDescriptorSets.push_back(iBufferWrite);
 	}
 
-	if (skyboxTexture.has_value()) {
-		VkDescriptorImageInfo skyboxInfo{};
-		skyboxInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		skyboxInfo.imageView = skyboxTexture.value().textureResource->view;
-		skyboxInfo.sampler = skyboxTexture.value().textureResource->sampler;
-
-		VkWriteDescriptorSet skyboxWrite{};
-		skyboxWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		skyboxWrite.dstSet = descriptorSet;
-		skyboxWrite.dstBinding = 6;
-		skyboxWrite.dstArrayElement = 0;
-		skyboxWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		skyboxWrite.descriptorCount = 1;
-		skyboxWrite.pImageInfo = &skyboxInfo;
-		writeDescriptorSets.push_back(skyboxWrite);
-	}
-
-	VkDescriptorBufferInfo instanceTransformInfo{};
-	instanceTransformInfo.buffer = instanceBuffer->buffer;
-	instanceTransformInfo.offset = 0;
-	instanceTransformInfo.range = sizeof(glm::mat4) * models.size();
-
-	VkWriteDescriptorSet instanceTransformWrite{};
-	instanceTransformWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	instanceTransformWrite.dstSet = descriptorSet;
-	instanceTransformWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-	instanceTransformWrite.dstBinding = 8;
-	instanceTransformWrite.descriptorCount = 1;
-	instanceTransformWrite.pBufferInfo = &instanceTransformInfo;
-	writeDescriptorSets.push_back(instanceTransformWrite);
-
 	std::vector<VkDescriptorImageInfo> albedoInfo;
 	std::vector<VkDescriptorImageInfo> normalInfo;
-	std::vector<VkDescriptorImageInfo> roughnessInfo;
-	std::vector<VkDescriptorImageInfo> metalnessInfo;
+	std::vector<VkDescriptorImageInfo> ormInfo;
 	std::vector<VkDescriptorImageInfo> specularInfo;
 	std::vector<VkDescriptorImageInfo> heightInfo;
-	std::vector<VkDescriptorImageInfo> ambientOcclusionInfo;
 	std::vector<uint32_t> textureFlags;
 
 	for (auto& scene : models) {
@@ -799,22 +806,13 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 			normalInfo.push_back(modelTextureInfo);
 		}
 
-		if (scene->obj.roughness.has_value()) {
-			VkDescriptorImageInfo modelTextureInfo{};
-			modelTextureInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			modelTextureInfo.imageView = scene->obj.roughness.value()->view;
-			modelTextureInfo.sampler = scene->obj.roughness.value()->sampler;
-
-			roughnessInfo.push_back(modelTextureInfo);
-		}
-
-		if (scene->obj.metalness.has_value()) {
+		if (scene->obj.occlusionRoughnessMetalness.has_value()) {
 			VkDescriptorImageInfo modelTextureInfo{};
 			modelTextureInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			modelTextureInfo.imageView = scene->obj.metalness.value()->view;
-			modelTextureInfo.sampler = scene->obj.metalness.value()->sampler;
+			modelTextureInfo.imageView = scene->obj.occlusionRoughnessMetalness.value()->view;
+			modelTextureInfo.sampler = scene->obj.occlusionRoughnessMetalness.value()->sampler;
 
-			metalnessInfo.push_back(modelTextureInfo);
+			ormInfo.push_back(modelTextureInfo);
 		}
 
 		if (scene->obj.specular.has_value()) {
@@ -835,23 +833,12 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 			heightInfo.push_back(modelTextureInfo);
 		}
 
-		if (scene->obj.ambientOcclusion.has_value()) {
-			VkDescriptorImageInfo modelTextureInfo{};
-			modelTextureInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			modelTextureInfo.imageView = scene->obj.ambientOcclusion.value()->view;
-			modelTextureInfo.sampler = scene->obj.ambientOcclusion.value()->sampler;
-
-			ambientOcclusionInfo.push_back(modelTextureInfo);
-		}
-
-		if(scene->obj.flags)
-			textureFlags.push_back(scene->obj.flags);
+		textureFlags.push_back(scene->obj.flags);
 	}
 
 	if (!albedoInfo.empty()) {
 		VkWriteDescriptorSet textureWrite{};
 		textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		textureWrite.dstSet = descriptorSet;
 		textureWrite.dstBinding = 9;
 		textureWrite.dstArrayElement = 0;
 		textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -863,7 +850,6 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 	if (!normalInfo.empty()) {
 		VkWriteDescriptorSet textureWrite{};
 		textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		textureWrite.dstSet = descriptorSet;
 		textureWrite.dstBinding = 10;
 		textureWrite.dstArrayElement = 0;
 		textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -872,34 +858,20 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 		writeDescriptorSets.push_back(textureWrite);
 	}
 
-	if (!roughnessInfo.empty()) {
+	if (!ormInfo.empty()) {
 		VkWriteDescriptorSet textureWrite{};
 		textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		textureWrite.dstSet = descriptorSet;
 		textureWrite.dstBinding = 11;
 		textureWrite.dstArrayElement = 0;
 		textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		textureWrite.descriptorCount = static_cast<uint32_t>(roughnessInfo.size());
-		textureWrite.pImageInfo = roughnessInfo.data();
-		writeDescriptorSets.push_back(textureWrite);
-	}
-
-	if (!metalnessInfo.empty()) {
-		VkWriteDescriptorSet textureWrite{};
-		textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		textureWrite.dstSet = descriptorSet;
-		textureWrite.dstBinding = 12;
-		textureWrite.dstArrayElement = 0;
-		textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		textureWrite.descriptorCount = static_cast<uint32_t>(metalnessInfo.size());
-		textureWrite.pImageInfo = metalnessInfo.data();
+		textureWrite.descriptorCount = static_cast<uint32_t>(ormInfo.size());
+		textureWrite.pImageInfo = ormInfo.data();
 		writeDescriptorSets.push_back(textureWrite);
 	}
 
 	if (!specularInfo.empty()) {
 		VkWriteDescriptorSet textureWrite{};
 		textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		textureWrite.dstSet = descriptorSet;
 		textureWrite.dstBinding = 13;
 		textureWrite.dstArrayElement = 0;
 		textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -911,7 +883,6 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 	if (!heightInfo.empty()) {
 		VkWriteDescriptorSet textureWrite{};
 		textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		textureWrite.dstSet = descriptorSet;
 		textureWrite.dstBinding = 14;
 		textureWrite.dstArrayElement = 0;
 		textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -920,43 +891,27 @@ void Engine::Graphics::Raytracing::createDescriptorSets(const Engine::Graphics::
 		writeDescriptorSets.push_back(textureWrite);
 	}
 
-	if (!ambientOcclusionInfo.empty()) {
-		VkWriteDescriptorSet textureWrite{};
-		textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		textureWrite.dstSet = descriptorSet;
-		textureWrite.dstBinding = 15;
-		textureWrite.dstArrayElement = 0;
-		textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		textureWrite.descriptorCount = static_cast<uint32_t>(ambientOcclusionInfo.size());
-		textureWrite.pImageInfo = ambientOcclusionInfo.data();
-		writeDescriptorSets.push_back(textureWrite);
-	}
-
-	textureFlagBuffer = resources->create<BufferResource>(
-		device.getDevice(),
-		device.getPhysicalDevice(),
-		sizeof(uint32_t) * textureFlags.size(),
-		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		textureFlags.data()
-	);
+	memcpy(frame.textureFlagBuffer->mapped, textureFlags.data(), sizeof(uint32_t) * textureFlags.size());
 
 	VkDescriptorBufferInfo textureFlagBufferInfo{};
-	textureFlagBufferInfo.buffer = textureFlagBuffer->buffer;
+	textureFlagBufferInfo.buffer = frame.textureFlagBuffer->buffer;
 	textureFlagBufferInfo.offset = 0;
 	textureFlagBufferInfo.range = VK_WHOLE_SIZE;
 
 	VkWriteDescriptorSet textureFlagBufferWrite{};
 	textureFlagBufferWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	textureFlagBufferWrite.dstSet = descriptorSet;
 	textureFlagBufferWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 	textureFlagBufferWrite.dstBinding = 16;
 	textureFlagBufferWrite.descriptorCount = 1;
 	textureFlagBufferWrite.pBufferInfo = &textureFlagBufferInfo;
 	writeDescriptorSets.push_back(textureFlagBufferWrite);
 
+	for (auto& write : writeDescriptorSets) {
+		write.dstSet = frame.descriptorSet;
+	}
+
 	vkUpdateDescriptorSets(
-		device.getDevice(),
+		device,
 		static_cast<uint32_t>(writeDescriptorSets.size()),
 		writeDescriptorSets.data(),
 		0,
@@ -978,7 +933,6 @@ void Engine::Graphics::Raytracing::updateDescriptorSets(Engine::Graphics::Device
 
 	VkWriteDescriptorSet storageImageWrite{};
 	storageImageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	storageImageWrite.dstSet = descriptorSet;
 	storageImageWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 	storageImageWrite.dstBinding = 1;
 	storageImageWrite.pImageInfo = &storageImageInfo;
@@ -987,7 +941,6 @@ void Engine::Graphics::Raytracing::updateDescriptorSets(Engine::Graphics::Device
 
 	VkWriteDescriptorSet accumImageWrite{};
 	accumImageWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	accumImageWrite.dstSet = descriptorSet;
 	accumImageWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 	accumImageWrite.dstBinding = 2;
 	accumImageWrite.pImageInfo = &accumImageInfo;
@@ -999,45 +952,24 @@ void Engine::Graphics::Raytracing::updateDescriptorSets(Engine::Graphics::Device
 		textureFlags.push_back(scene->obj.flags);
 	}
 
-	if (!textureFlagBuffer) {
-		if (textureFlagBuffer) {
-			resources->destroy(textureFlagBuffer);
+	for (RaytracingFrame& frame : frames) {
+		std::vector<VkWriteDescriptorSet> frameWrites = writeDescriptorSets;
+		for (auto& write : frameWrites) {
+			write.dstSet = frame.descriptorSet;
 		}
-		textureFlagBuffer = resources->create<BufferResource>(
-			device.getDevice(),
-			device.getPhysicalDevice(),
-			sizeof(uint32_t) * textureFlags.size(),
-			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			textureFlags.data()
-		);
 
-		VkDescriptorBufferInfo textureFlagBufferInfo{};
-		textureFlagBufferInfo.buffer = textureFlagBuffer->buffer;
-		textureFlagBufferInfo.offset = 0;
-		textureFlagBufferInfo.range = VK_WHOLE_SIZE;
-
-		VkWriteDescriptorSet textureFlagBufferWrite{};
-		textureFlagBufferWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		textureFlagBufferWrite.dstSet = descriptorSet;
-		textureFlagBufferWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-		textureFlagBufferWrite.dstBinding = 16;
-		textureFlagBufferWrite.descriptorCount = 1;
-		textureFlagBufferWrite.pBufferInfo = &textureFlagBufferInfo;
-		writeDescriptorSets.push_back(textureFlagBufferWrite);
-	}
-	else {
-		memcpy(textureFlagBuffer->mapped, textureFlags.data(), sizeof(uint32_t) * textureFlags.size());
-	}
-
-	vkUpdateDescriptorSets(
-		device.getDevice(), 
-		static_cast<uint32_t>(writeDescriptorSets.size()), 
-		writeDescriptorSets.data(), 
-		0, 
-		nullptr
-	);
+		if (frame.textureFlagBuffer) {
+			memcpy(frame.textureFlagBuffer->mapped, textureFlags.data(), sizeof(uint32_t) * textureFlags.size());
+		}
 
+		vkUpdateDescriptorSets(
+			device.getDevice(), 
+			static_cast<uint32_t>(frameWrites.size()), 
+			frameWrites.data(), 
+			0, 
+			nullptr
+		);
+	}
 }
 
 void Engine::Graphics::Raytracing::createRayTracingPipeline(Engine::Graphics::Device device, std::string raygenShaderPath, std::string missShaderPath, std::string chitShaderPath, std::string ahitShaderPath, std::string intShaderPath)
@@ -1066,7 +998,7 @@ void Engine::Graphics::Raytracing::createRayTracingPipeline(Engine::Graphics::De
 		{0, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 1, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, nullptr},
 		{1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, nullptr},
 		{2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_RAYGEN_BIT_KHR, nullptr},
-		{3, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR, nullptr},
+		{3, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR, nullptr},
 		{4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR, nullptr},
 		{5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR, nullptr},
 		{6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR, nullptr },
@@ -1075,10 +1007,8 @@ void Engine::Graphics::Raytracing::createRayTracingPipeline(Engine::Graphics::De
 		{9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, nullptr},
 		{10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, nullptr},
 		{11, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, nullptr},
-		{12, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, nullptr},
 		{13, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, nullptr},
 		{14, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, nullptr},
-		{15, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, nullptr},
 		{16, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, modelBufferSize, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_ANY_HIT_BIT_KHR, nullptr},
 	};
 
@@ -1176,7 +1106,7 @@ void Engine::Graphics::Raytracing::createRayTracingPipeline(Engine::Graphics::De
 	rayTracingPipelineCreateInfo.maxPipelineRayRecursionDepth = 31;
 	rayTracingPipelineCreateInfo.layout = pipelineLayout;
 
-	fpCreateRayTracingPipelinesKHR(device.getDevice(), VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &rayTracingPipelineCreateInfo, nullptr, &pipeline);
+	fpCreateRayTracingPipelinesKHR(device.getDevice(), VK_NULL_HANDLE, pipelineCache ? pipelineCache->get() : VK_NULL_HANDLE, 1, &rayTracingPipelineCreateInfo, nullptr, &pipeline);
 
 	if (raygenShaderModule != VK_NULL_HANDLE)
 		vkDestroyShaderModule(device.getDevice(), raygenShaderModule, nullptr);
@@ -1197,7 +1127,7 @@ void Engine::Graphics::Raytracing::createImage(Engine::Graphics::Device device,
 	accumulationImage.create(device, device.getGraphicsQueue(), commandPool, VK_FORMAT_R32G32B32A32_SFLOAT, { extent.width, extent.height, 1 });
 }
 
-void Engine::Graphics::Raytracing::traceRays(VkDevice device, VkCommandBuffer commandBuffer, SwapchainResource* resource, uint32_t currentIndex)
+void Engine::Graphics::Raytracing::traceRays(VkDevice device, VkCommandBuffer commandBuffer, SwapchainResource* resource, uint32_t currentIndex, uint32_t frameIndex)
 {
 	const uint32_t handleSize = rayTracingPipelineProperties.shaderGroupHandleSize;
 	const uint32_t handleSizeAligned = (handleSize + rayTracingPipelineProperties.shaderGroupHandleAlignment - 1) &
@@ -1221,8 +1151,9 @@ void Engine::Graphics::Raytracing::traceRays(VkDevice device, VkCommandBuffer co
 	VkStridedDeviceAddressRegionKHR callableSBTRegion{};
 
 	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline);
+	uint32_t uniformOffset = static_cast<uint32_t>(uniformStride * frameIndex);
 	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipelineLayout,
-		0, 1, &descriptorSet, 0, nullptr);
+		0, 1, &frames[frameIndex].descriptorSet, 1, &uniformOffset);
 
 	fpCmdTraceRaysKHR(
 		commandBuffer,
@@ -1384,14 +1315,21 @@ void Engine::Graphics::Raytracing::traceRays(VkDevice device, VkCommandBuffer co
 
 void Engine::Graphics::Raytracing::createUniformBuffer(Engine::Graphics::Device device)
 {
-	VkDeviceSize bufferSize = sizeof(RaytracingUniformBufferObject);
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.getPhysicalDevice(), &properties);
+
+	VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+	uniformStride = (sizeof(RaytracingUniformBufferObject) + alignment - 1) & ~(alignment - 1);
+
+	// one slot per frame in flight, selected with a dynamic offset when binding
+	VkDeviceSize bufferSize = uniformStride * Engine::Settings::MAX_FRAMES_IN_FLIGHT;
 
 	uniformBuffer = resources->create<BufferResource>(device.getDevice(), device.getPhysicalDevice(), bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 }
 
-void Engine::Graphics::Raytracing::updateUBO(Engine::Graphics::Device device)
+void Engine::Graphics::Raytracing::updateUBO(Engine::Graphics::Device device, uint32_t frameIndex)
 {
-	memcpy(uniformBuffer->mapped, &uboData, sizeof(uboData));
+	memcpy(static_cast<char*>(uniformBuffer->mapped) + uniformStride * frameIndex, &uboData, sizeof(uboData));
 }
 
 void Engine::Graphics::Raytracing::recreateScene(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::CommandBuffer commandBuffer, Engine::Graphics::Swapchain swapchain, Engine::Core::RT::SceneManager rtscenemanager, std::optional<Engine::Graphics::Texture> skyboxTexture)
@@ -1447,7 +1385,17 @@ void Engine::Graphics::Raytracing::cleanup(VkDevice device, bool softClean)
 	resources->destroy(closestHitResource);
 	resources->destroy(anyHitResource);
 	
-	resources->destroy(TLAS.resource);
+	for (RaytracingFrame& frame : frames) {
+		resources->destroy(frame.TLAS.resource);
+		resources->destroy(frame.instanceBuffer);
+		resources->destroy(frame.textureFlagBuffer);
+
+		if (frame.scratchBuffer) {
+			resources->defer([scratchBuffer = *frame.scratchBuffer](VkDevice) mutable { scratchBuffer.destroy(); });
+		}
+
+		frame = RaytracingFrame{};
+	}
 
 	for (auto& blas : BLAS) {
 		resources->destroy(blas.resource);
@@ -159,7 +159,7 @@ void Engine::Graphics::RenderPass::setupLayoutBindings(VkDevice device)
 	//bindings.push_back(uboLayoutBinding);
 	pbrBindings.push_back(uboLayoutBinding);
 
-	for (uint32_t i = 1; i <= 5; i++) {
+	for (uint32_t i = 1; i <= PBR_TEXTURE_BINDINGS; i++) {
 		VkDescriptorSetLayoutBinding pbrLayoutBindings{};
 		pbrLayoutBindings.binding = i;
 		pbrLayoutBindings.descriptorCount = 1;
@@ -177,5 +177,30 @@ void Engine::Graphics::RenderPass::setupLayoutBindings(VkDevice device)
 
 	if (vkCreateDescriptorSetLayout(device, &pbrLayoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
 		throw std::runtime_error("failed to create descriptor set layout");
+
+	// set 1: light list and cluster bins, written by the culling pass and read by forward shaders
+	std::array<VkDescriptorSetLayoutBinding, 4> lightBindings{};
+
+	for (uint32_t i = 0; i < 3; i++) {
+		lightBindings[i].binding = i;
+		lightBindings[i].descriptorCount = 1;
+		lightBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		lightBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		lightBindings[i].pImmutableSamplers = nullptr;
+	}
+
+	lightBindings[3].binding = 3;
+	lightBindings[3].descriptorCount = 1;
+	lightBindings[3].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	lightBindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	lightBindings[3].pImmutableSamplers = nullptr;
+
+	VkDescriptorSetLayoutCreateInfo lightLayoutInfo{};
+	lightLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	lightLayoutInfo.bindingCount = static_cast<uint32_t>(lightBindings.size());
+	lightLayoutInfo.pBindings = lightBindings.data();
+
+	if (vkCreateDescriptorSetLayout(device, &lightLayoutInfo, nullptr, &lightDescriptorSetLayout) != VK_SUCCESS)
+		throw std::runtime_error("failed to create light descriptor set layout");
 }
 
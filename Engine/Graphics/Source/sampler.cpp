@@ -28,16 +28,23 @@ VkSampleCountFlagBits Engine::Graphics::Sampler::getMaxUsableSampleCount(VkPhysi
 }
 
 void Engine::Graphics::Sampler::generateMipmaps(Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::Device device, ImageResource* image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels, uint32_t layerCount)
+{
+    VkCommandBuffer commandBuffer = commandBuf.beginSingleTimeCommands(device.getDevice());
+
+    recordMipmaps(commandBuffer, device.getPhysicalDevice(), image, imageFormat, texWidth, texHeight, mipLevels, layerCount);
+
+    commandBuf.endSingleTimeCommands(commandBuffer, device.getGraphicsQueue(), device.getDevice());
+}
+
+void Engine::Graphics::Sampler::recordMipmaps(VkCommandBuffer commandBuffer, VkPhysicalDevice physicalDevice, ImageResource* image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels, uint32_t layerCount)
 {
     VkFormatProperties formatProperties;
-    vkGetPhysicalDeviceFormatProperties(device.getPhysicalDevice(), imageFormat, &formatProperties);
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, imageFormat, &formatProperties);
 
     if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
         throw std::runtime_error("texture image format does not support linear blitting");
     }
 
-    VkCommandBuffer commandBuffer = commandBuf.beginSingleTimeCommands(device.getDevice());
-
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.image = image->image;
@@ -51,11 +58,11 @@ void Engine::Graphics::Sampler::generateMipmaps(Engine::Graphics::CommandBuffer
     barrier.subresourceRange.baseMipLevel = 0;
     barrier.oldLayout = image->layout;
     barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.srcAccessMask = 0;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 
     vkCmdPipelineBarrier(commandBuffer,
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
         0, nullptr,
         0, nullptr,
         1, &barrier
@@ -135,6 +142,4 @@ void Engine::Graphics::Sampler::generateMipmaps(Engine::Graphics::CommandBuffer
     );
 
     image->updateLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-    commandBuf.endSingleTimeCommands(commandBuffer, device.getGraphicsQueue(), device.getDevice());
 }
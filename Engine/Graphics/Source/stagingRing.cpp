@@ -0,0 +1,170 @@
+#include "stagingRing.h"
+#include "device.h"
+
+std::unique_ptr<Engine::Graphics::StagingRing> stagingRing;
+
+Engine::Graphics::StagingRing::~StagingRing()
+{
+}
+
+void Engine::Graphics::StagingRing::create(const Engine::Graphics::Device& device, VkDeviceSize capacity)
+{
+	this->device = device.getDevice();
+	this->capacity = capacity;
+
+	// image decoders write into the ring and read back what they wrote (PNG row filters, the
+	// vertical flip), which is very slow on write-combined memory; prefer a cached heap
+	try {
+		resource = resources->create<BufferResource>(device.getDevice(), device.getPhysicalDevice(), capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+	}
+	catch (const std::runtime_error&) {
+		resource = resources->create<BufferResource>(device.getDevice(), device.getPhysicalDevice(), capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	}
+
+	if (!resource->mapped)
+		throw std::runtime_error("failed to map staging ring");
+
+	Engine::Utility::setDebugName(device.getDevice(), reinterpret_cast<uint64_t>(resource->buffer), VK_OBJECT_TYPE_BUFFER, "Staging Ring");
+}
+
+void Engine::Graphics::StagingRing::destroy()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (auto& region : regions) {
+		if (!region.retired && region.fence != VK_NULL_HANDLE)
+			vkWaitForFences(device, 1, &region.fence, VK_TRUE, UINT64_MAX);
+	}
+	regions.clear();
+
+	if (resource) {
+		resources->destroy(resource);
+		resource = nullptr;
+	}
+}
+
+std::optional<Engine::Graphics::StagingAllocation> Engine::Graphics::StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+	if (size == 0 || size > capacity)
+		return std::nullopt;
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	reclaim();
+
+	std::optional<VkDeviceSize> offset = findSpace(size, alignment);
+
+	// the mutex is dropped while waiting so other threads keep reserving and retiring; the
+	// oldest fence is polled as well, since it can signal without anyone calling retire
+	while (!offset) {
+		if (regions.empty() || regions.front().fence == VK_NULL_HANDLE)
+			return std::nullopt;
+
+		reclaimed.wait_for(lock, std::chrono::milliseconds(1));
+
+		reclaim();
+		offset = findSpace(size, alignment);
+	}
+
+	Region region{};
+	region.id = nextId++;
+	region.begin = *offset;
+	region.end = *offset + size;
+	regions.push_back(region);
+
+	StagingAllocation allocation{};
+	allocation.buffer = resource->buffer;
+	allocation.offset = *offset;
+	allocation.size = size;
+	allocation.mapped = static_cast<char*>(resource->mapped) + *offset;
+	allocation.id = region.id;
+
+	return allocation;
+}
+
+void Engine::Graphics::StagingRing::submit(const std::vector<uint64_t>& ids, VkFence fence)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (uint64_t id : ids) {
+		if (Region* region = find(id))
+			region->fence = fence;
+	}
+}
+
+void Engine::Graphics::StagingRing::release(uint64_t id)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (Region* region = find(id)) {
+		region->retired = true;
+		region->fence = VK_NULL_HANDLE;
+	}
+
+	reclaim();
+	reclaimed.notify_all();
+}
+
+void Engine::Graphics::StagingRing::retire(VkFence fence)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (auto& region : regions) {
+		if (region.fence == fence) {
+			region.retired = true;
+			region.fence = VK_NULL_HANDLE;
+		}
+	}
+
+	reclaim();
+	reclaimed.notify_all();
+}
+
+Engine::Graphics::StagingRing::Region* Engine::Graphics::StagingRing::find(uint64_t id)
+{
+	if (regions.empty() || id < regions.front().id)
+		return nullptr;
+
+	size_t index = static_cast<size_t>(id - regions.front().id);
+	if (index >= regions.size())
+		return nullptr;
+
+	return &regions[index];
+}
+
+void Engine::Graphics::StagingRing::reclaim()
+{
+	while (!regions.empty()) {
+		Region& front = regions.front();
+
+		if (!front.retired) {
+			if (front.fence == VK_NULL_HANDLE || vkGetFenceStatus(device, front.fence) != VK_SUCCESS)
+				break;
+		}
+
+		regions.pop_front();
+	}
+}
+
+std::optional<VkDeviceSize> Engine::Graphics::StagingRing::findSpace(VkDeviceSize size, VkDeviceSize alignment) const
+{
+	if (regions.empty())
+		return 0;
+
+	VkDeviceSize front = regions.front().begin;
+	VkDeviceSize back = regions.back().end;
+	VkDeviceSize start = (back + alignment - 1) & ~(alignment - 1);
+
+	if (back > front) {
+		if (start + size <= capacity)
+			return start;
+		if (size <= front)
+			return 0;
+		return std::nullopt;
+	}
+
+	if (start + size <= front)
+		return start;
+
+	return std::nullopt;
+}
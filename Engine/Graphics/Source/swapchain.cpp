@@ -96,10 +96,10 @@ VkExtent2D Engine::Graphics::Swapchain::chooseSwapExtent(const VkSurfaceCapabili
 
 void Engine::Graphics::Swapchain::cleanupSwapChain(Engine::Graphics::Device& device, Engine::Graphics::FrameBuffer& fb)
 {
-	resources->destroy(fb.depthResource);
-	resources->destroy(fb.colorResource);
+	resources->destroyImmediate(fb.depthResource);
+	resources->destroyImmediate(fb.colorResource);
 
-	resources->destroy(resource);
+	resources->destroyImmediate(resource);
 }
 
 VkImageView Engine::Graphics::Swapchain::createImageView(VkDevice device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, bool isCube) {
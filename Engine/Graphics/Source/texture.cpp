@@ -5,260 +5,143 @@
 #include "device.h"
 #include "swapchain.h"
 #include "sampler.h"
+#include "uploadBatch.h"
+#include "mipGenerator.h"
+#include "meshCache.h"
+#include "textureLoader.h"
+#include "textureCache.h"
+
+namespace {
+    // regions at or past levelCount are dropped
+    void uploadDecoded(Engine::Graphics::UploadBatch& batch, ImageResource* image, Engine::Graphics::DecodedImage& decoded, uint32_t baseLayer, uint32_t levelCount = UINT32_MAX)
+    {
+        const char* data = static_cast<const char*>(decoded.data());
+
+        std::vector<Engine::Graphics::ImageRegion> regions;
+        std::copy_if(decoded.regions.begin(), decoded.regions.end(), std::back_inserter(regions), [levelCount](const auto& region) { return region.level < levelCount; });
+
+        if (decoded.isStaged()) {
+            batch.uploadStagedImage(image, decoded.staging, regions, baseLayer);
+        }
+        else {
+            for (const auto& region : regions)
+                batch.uploadImage(image, data + region.offset, decoded.key.format, region, baseLayer);
+        }
 
-void Engine::Graphics::Texture::createTextureImage(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::Sampler sampler, bool flipTexture, bool isPBR, bool isCube, bool useSampler)
-{
-	if (flipTexture) {
-		stbi_set_flip_vertically_on_load(true);
-	}
-    else {
-        stbi_set_flip_vertically_on_load(false);
+        decoded.staging = {};
+        decoded.pixels.reset();
     }
-	int texWidth, texHeight, texChannels;
-    auto start = std::chrono::high_resolution_clock::now();
-	stbi_uc* pixels = stbi_load(texturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> duration = end - start;
-    std::cout << "'stbi_load' took " << duration << " to load " << texturePath << std::endl;
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
-
-	mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
-
-	if (!pixels)
-		throw std::runtime_error("failed to load texture image");
+}
 
-    BufferResource* stagingBuffer = framebuffer.createBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+void Engine::Graphics::Texture::createTextureImage(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::Sampler sampler, bool flipTexture, bool isPBR, bool isCube, bool useSampler)
+{
+    Engine::Graphics::UploadBatch batch(device, commandBuf);
+    createTextureImage(texturePath, device, batch, framebuffer, flipTexture, isPBR, isCube, useSampler);
+    batch.flush();
+}
 
-	memcpy(stagingBuffer->mapped, pixels, static_cast<size_t>(imageSize));
+void Engine::Graphics::Texture::createTextureImage(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool flipTexture, bool isPBR, bool isCube, bool useSampler)
+{
+    textureResource = createImageResource(texturePath, device, batch, framebuffer, flipTexture, isPBR, isCube, useSampler);
+}
 
-	stbi_image_free(pixels);
+ImageResource* Engine::Graphics::Texture::createImageResource(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::Sampler sampler, bool flipTexture, bool isPBR, bool isCube, bool useSampler)
+{
+    Engine::Graphics::UploadBatch batch(device, commandBuf);
+    ImageResource* image = createImageResource(texturePath, device, batch, framebuffer, flipTexture, isPBR, isCube, useSampler);
+    batch.flush();
 
-	textureResource = framebuffer.createImage(device.getDevice(), device.getPhysicalDevice(), texWidth, texHeight, mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, 0, VK_IMAGE_ASPECT_COLOR_BIT, isCube, useSampler);
-	commandBuf.transitionImageLayout(device, textureResource, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, 1);
-	commandBuf.copyBufferToImage(device, stagingBuffer->buffer, textureResource->image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1);
+    return image;
+}
 
-	sampler.generateMipmaps(commandBuf, device, textureResource, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels, 1);
+ImageResource* Engine::Graphics::Texture::createImageResource(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool flipTexture, bool isPBR, bool isCube, bool useSampler)
+{
+    // cubemaps are not cached, so they are decoded even when a 2D copy is resident
+    Engine::Graphics::TextureLoadJob job(batch);
+    job.add(texturePath, flipTexture, VK_FORMAT_R8G8B8A8_SRGB, !isCube);
 
-    if (isPBR) {
-        textureResources.push_back(textureResource);
-        vecMipLevels.push_back(mipLevels);
-    }
+    return createImageResource(job.get(0), device, batch, framebuffer, isPBR, isCube, useSampler);
+}
 
-    resources->destroy(stagingBuffer);
+void Engine::Graphics::Texture::createTextureImage(Engine::Graphics::DecodedImage& image, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool isPBR, bool isCube, bool useSampler)
+{
+    textureResource = createImageResource(image, device, batch, framebuffer, isPBR, isCube, useSampler);
 }
 
-ImageResource* Engine::Graphics::Texture::createImageResource(const std::string texturePath, Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::Sampler sampler, bool flipTexture, bool isPBR, bool isCube, bool useSampler)
+ImageResource* Engine::Graphics::Texture::createImageResource(Engine::Graphics::DecodedImage& decoded, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool isPBR, bool isCube, bool useSampler)
 {
-    ImageResource* image;
+    auto start = std::chrono::steady_clock::now();
+    bool cacheable = textureCache && !isCube;
+
+    ImageResource* image = cacheable ? textureCache->acquire(decoded.key, mipLevels) : nullptr;
+    if (image) {
+        if (decoded.isStaged()) {
+            stagingRing->release(decoded.staging.id);
+            decoded.staging = {};
+        }
 
-    if (flipTexture) {
-        stbi_set_flip_vertically_on_load(true);
+        g_console.add("[Texture] %s: shared, %u users\n", decoded.path.c_str(), textureCache->useCount(image));
     }
     else {
-        stbi_set_flip_vertically_on_load(false);
-    }
-    int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load(texturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
+        if (decoded.resident)
+            throw std::runtime_error("texture " + decoded.path + " left the cache before it was uploaded");
+        if (decoded.layers != 1)
+            throw std::runtime_error("texture " + decoded.path + " has " + std::to_string(decoded.layers) + " layers; only cubemaps take more than one");
 
-    mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+        int texWidth = decoded.width;
+        int texHeight = decoded.height;
+        VkFormat format = decoded.key.format;
 
-    if (!pixels)
-        throw std::runtime_error("failed to load texture image");
+        // block-compressed images and KTX2 files bring their own mips; blits cannot write BC formats
+        mipLevels = decoded.hasMipChain() ? decoded.levels : Engine::Graphics::mipLevelCount(texWidth, texHeight);
 
-    BufferResource* stagingBuffer = framebuffer.createBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        VkImageCreateFlags flags = 0;
+        if (mipGenerator && !decoded.hasMipChain())
+            mipGenerator->prepareImage(format, usage, flags);
 
-    memcpy(stagingBuffer->mapped, pixels, static_cast<size_t>(imageSize));
+        // a cached image can be handed to any later caller, so it always gets a sampler
+        image = framebuffer.createImage(device.getDevice(), device.getPhysicalDevice(), texWidth, texHeight, mipLevels, VK_SAMPLE_COUNT_1_BIT, format, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, flags, VK_IMAGE_ASPECT_COLOR_BIT, isCube, useSampler || cacheable);
+        batch.transitionImageLayout(image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, 1);
+        uploadDecoded(batch, image, decoded, 0);
 
-    stbi_image_free(pixels);
+        if (decoded.hasMipChain())
+            batch.transitionImageLayout(image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels, 1);
+        else
+            batch.generateMipmaps(image, format, texWidth, texHeight, mipLevels, 1);
 
-    image = framebuffer.createImage(device.getDevice(), device.getPhysicalDevice(), texWidth, texHeight, mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 1, 0, VK_IMAGE_ASPECT_COLOR_BIT, isCube, useSampler);
-    commandBuf.transitionImageLayout(device, image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, 1);
-    commandBuf.copyBufferToImage(device, stagingBuffer->buffer, image->image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1);
+        if (cacheable)
+            textureCache->insert(decoded.key, image, mipLevels);
 
-    sampler.generateMipmaps(commandBuf, device, image, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels, 1);
+        double uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        g_console.add("[Texture] %s: %dx%d%s%s, decode %.1f ms, upload %.1f ms\n", decoded.path.c_str(), texWidth, texHeight, Engine::Graphics::isBlockCompressed(format) ? " BC" : "", decoded.cooked ? " cooked" : "", decoded.decodeMs, uploadMs);
+    }
 
     if (isPBR) {
         textureResources.push_back(image);
         vecMipLevels.push_back(mipLevels);
     }
 
-    resources->destroy(stagingBuffer);
-
     return image;
 }
 
 void Engine::Graphics::Texture::loadModel(const std::string modelPath)
 {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
-    std::string baseDir = std::filesystem::path(modelPath).parent_path().string();
-
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, modelPath.c_str())) {
-        throw std::runtime_error(warn + err);
-    }
-
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-
-    for (const auto& shape : shapes) {
-        int face = 0;
-        for (const auto& index : shape.mesh.indices) {
-            Vertex vertex{};
-
-            vertex.pos = {
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2]
-            };
-
-            vertex.texCoord = {
-                attrib.texcoords[2 * index.texcoord_index + 0],
-                1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
-            };
-
-            if (index.normal_index > 0) {
-                vertex.normal = {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2]
-                };
-            }
-            else {
-                vertex.normal = { 0.0, 1.0, 0.0 };
-            }
-
-            if (uniqueVertices.count(vertex) == 0) {
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
-            }
-
-            indices.push_back(uniqueVertices[vertex]);
-        }
-    }
+    Engine::Graphics::MeshCache::loadObj(modelPath, std::nullopt, vertices, indices);
 }
 
 void Engine::Graphics::Texture::loadModel(const std::string modelPath, const std::string materialPath)
 {
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
     std::string baseDir = std::filesystem::path(materialPath).parent_path().string();
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, modelPath.c_str(), baseDir.c_str())) {
-        throw std::runtime_error(warn + err);
-    }
-
-    for (const auto& mat : materials) {
-        Materials material;
-
-        material.name = mat.name;
-        material.diffusePath = mat.diffuse_texname;
-        material.normalPath = mat.normal_texname;
-        material.roughnessPath = mat.roughness_texname;
-        material.metalnessPath = mat.metallic_texname;
-        material.aoPath = mat.ambient_texname;
-        material.specularPath = mat.specular_texname;
-
-        mats.push_back(material);
-    }
-
-
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-
-    for (const auto& shape : shapes) {
-        int face = 0;
-        for (const auto& index : shape.mesh.indices) {
-            Vertex vertex{};
-
-            vertex.pos = {
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2]
-            };
-
-            vertex.texCoord = {
-                attrib.texcoords[2 * index.texcoord_index + 0],
-                1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
-            };
-
-            if (index.normal_index > 0) {
-                vertex.normal = {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2]
-                };
-            }
-            else {
-                vertex.normal = { 0.0, 1.0, 0.0 };
-            }
-
-            if (uniqueVertices.count(vertex) == 0) {
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
-            }
-
-            indices.push_back(uniqueVertices[vertex]);
-        }
-    }
+    Engine::Graphics::MeshCache::loadObj(modelPath, baseDir, vertices, indices, &mats);
 }
 
 MeshObject Engine::Graphics::Texture::loadModelRT(const std::string modelPath, Engine::Graphics::Device device, Engine::Graphics::FrameBuffer fb)
 {
     MeshObject t;
 
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
-    std::string baseDir = std::filesystem::path(modelPath).parent_path().string();
-
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, modelPath.c_str())) {
-        throw std::runtime_error(warn + err);
-    }
-
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-
-    for (const auto& shape : shapes) {
-        int face = 0;
-        for (const auto& index : shape.mesh.indices) {
-            Vertex vertex{};
-
-            vertex.pos = {
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2]
-            };
-
-            vertex.texCoord = {
-                attrib.texcoords[2 * index.texcoord_index + 0],
-                1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
-            };
-
-            if (index.normal_index > 0) {
-                vertex.normal = {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2]
-                };
-            }
-            else {
-                vertex.normal = { 0.0, 1.0, 0.0 };
-            }
-
-            if (uniqueVertices.count(vertex) == 0) {
-                uniqueVertices[vertex] = static_cast<uint32_t>(t.v.size());
-                t.v.push_back(vertex);
-            }
-
-            t.i.push_back(uniqueVertices[vertex]);
-        }
-    }
+    Engine::Graphics::MeshCache::loadObj(modelPath, std::nullopt, t.v, t.i);
 
 
     VkDeviceSize vertexBufferSize = sizeof(t.v[0]) * t.v.size();
@@ -285,69 +168,9 @@ MeshObject Engine::Graphics::Texture::loadModelRT(const std::string modelPath, c
 {
     MeshObject t;
 
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
     std::string baseDir = std::filesystem::path(materialPath).parent_path().string();
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, modelPath.c_str(), baseDir.c_str())) {
-        throw std::runtime_error(warn + err);
-    }
-
-    for (const auto& mat : materials) {
-        Materials material;
-
-        material.name = mat.name;
-        material.diffusePath = mat.diffuse_texname;
-        material.normalPath = mat.normal_texname;
-        material.roughnessPath = mat.roughness_texname;
-        material.metalnessPath = mat.metallic_texname;
-        material.aoPath = mat.ambient_texname;
-        material.specularPath = mat.specular_texname;
-
-        t.m.push_back(material);
-    }
-
-
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-
-    for (const auto& shape : shapes) {
-        int face = 0;
-        for (const auto& index : shape.mesh.indices) {
-            Vertex vertex{};
-
-            vertex.pos = {
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2]
-            };
-
-            vertex.texCoord = {
-                attrib.texcoords[2 * index.texcoord_index + 0],
-                1.0f - attrib.texcoords[2 * index.texcoord_index + 1],
-            };
-
-            if (index.normal_index > 0) {
-                vertex.normal = {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2]
-                };
-            }
-            else {
-                vertex.normal = { 0.0, 1.0, 0.0 };
-            }
-
-            if (uniqueVertices.count(vertex) == 0) {
-                uniqueVertices[vertex] = static_cast<uint32_t>(t.v.size());
-                t.v.push_back(vertex);
-            }
-
-            t.i.push_back(uniqueVertices[vertex]);
-        }
-    }
+    Engine::Graphics::MeshCache::loadObj(modelPath, baseDir, t.v, t.i, &t.m);
 
     VkDeviceSize vertexBufferSize = sizeof(t.v[0]) * t.v.size();
     t.vertex = fb.createBuffer(device, vertexBufferSize,
@@ -375,42 +198,33 @@ MeshObject Engine::Graphics::Texture::loadModelRT(const std::string modelPath, c
 
 void Engine::Graphics::Texture::createVertexBuffer(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer fb)
 {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-    BufferResource* stagingBuffer = fb.createBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    Engine::Graphics::UploadBatch batch(device, commandBuf);
+    createVertexBuffer(device, batch, fb);
+    batch.flush();
+}
 
-    memcpy(stagingBuffer->mapped, vertices.data(), (size_t)bufferSize);
+void Engine::Graphics::Texture::createVertexBuffer(Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer fb)
+{
+    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
 
     vertexResource = fb.createBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    commandBuf.copyBuffer(device, stagingBuffer->buffer, vertexResource->buffer, bufferSize);
-
-    resources->destroy(stagingBuffer);
+    batch.uploadBuffer(vertexResource->buffer, 0, vertices.data(), bufferSize);
 }
 
 void Engine::Graphics::Texture::createIndexBuffer(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer fb)
 {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-    BufferResource* stagingBuffer = fb.createBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    memcpy(stagingBuffer->mapped, indices.data(), (size_t)bufferSize);
-
-    indexResource = fb.createBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-    commandBuf.copyBuffer(device, stagingBuffer->buffer, indexResource->buffer, bufferSize);
-
-    resources->destroy(stagingBuffer);
+    Engine::Graphics::UploadBatch batch(device, commandBuf);
+    createIndexBuffer(device, batch, fb);
+    batch.flush();
 }
 
-void Engine::Graphics::Texture::createUniformBuffers(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer fb)
+void Engine::Graphics::Texture::createIndexBuffer(Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer fb)
 {
-    VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
 
-    uniformResources.resize(Engine::Settings::MAX_FRAMES_IN_FLIGHT);
+    indexResource = fb.createBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-    for (size_t i = 0; i < Engine::Settings::MAX_FRAMES_IN_FLIGHT; i++) {
-        uniformResources[i] = fb.createBuffer(device, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    }
+    batch.uploadBuffer(indexResource->buffer, 0, indices.data(), bufferSize);
 }
 
 void Engine::Graphics::Texture::createSyncObjects(VkDevice device)
@@ -435,63 +249,87 @@ void Engine::Graphics::Texture::createSyncObjects(VkDevice device)
     }
 }
 
-void Engine::Graphics::Texture::updateUniformBuffer(uint32_t currentImage, Engine::Core::Camera& camera, VkExtent2D swapChainExtent, glm::mat4 model, glm::vec3 color, std::vector<LightBuffer> lights)
+void Engine::Graphics::Texture::createCubemap(const std::vector<std::string>& faces, Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::Sampler sampler, bool flipTexture)
 {
-    camera.AspectRatio = swapChainExtent.width / (float)swapChainExtent.height;
-    UniformBufferObject ubo{};
-    ubo.model = model;
-    ubo.view = camera.GetViewMatrix();
-    ubo.proj = camera.GetProjectionMatrix();
-    ubo.color = color;
-    ubo.numLights = std::min(static_cast<int>(lights.size()), 99);
-
-    for (int i = 0; i < ubo.numLights; i++) {
-        ubo.lights[i] = lights[i];
-    }
-         
-    memcpy(uniformResources[currentImage]->mapped, &ubo, sizeof(ubo));
+    Engine::Graphics::UploadBatch batch(device, commandBuf);
+    createCubemap(faces, device, batch, framebuffer, flipTexture);
+    batch.flush();
 }
 
-void Engine::Graphics::Texture::createCubemap(const std::vector<std::string>& faces, Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer framebuffer, Engine::Graphics::Sampler sampler, bool flipTexture)
+void Engine::Graphics::Texture::createCubemap(const std::vector<std::string>& faces, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer, bool flipTexture)
 {
-    if (flipTexture) {
-        stbi_set_flip_vertically_on_load(true);
-    }
-    else {
-        stbi_set_flip_vertically_on_load(false);
-    }
+    Engine::Graphics::TextureLoadJob job(batch);
+    for (const auto& face : faces)
+        job.add(face, flipTexture, VK_FORMAT_R8G8B8A8_SRGB, false);
 
-    int texWidth, texHeight, texChannels;
-    VkDeviceSize layerSize;
+    createCubemap(job, device, batch, framebuffer);
+}
 
-    std::vector<stbi_uc*> pixels(6);
-    for (size_t i = 0; i < 6; i++) {
-        pixels[i] = stbi_load(faces[i].c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        if (!pixels[i]) {
-            throw std::runtime_error("failed to load image: " + faces[i]);
+void Engine::Graphics::Texture::createCubemap(Engine::Graphics::TextureLoadJob& faces, Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer framebuffer)
+{
+    // either six face images or one KTX2 file holding all six
+    const bool packedFaces = faces.size() == 1 && faces.get(0).layers == 6;
+    if (!packedFaces && (faces.size() != 6 || faces.get(0).layers != 1))
+        throw std::runtime_error("cubemap needs exactly 6 faces");
+
+    const Engine::Graphics::DecodedImage& first = faces.get(0);
+    int texWidth = first.width;
+    int texHeight = first.height;
+    VkFormat format = first.key.format;
+
+    // faces cooked on an earlier run bring their mips; while only some of them are cooked,
+    // every face uploads level 0 and the chain is generated as before
+    bool storedMips = first.hasMipChain();
+
+    for (size_t i = 1; i < faces.size(); i++) {
+        const Engine::Graphics::DecodedImage& face = faces.get(i);
+        if (face.width != texWidth || face.height != texHeight)
+            throw std::runtime_error("cubemap face size mismatch: " + face.path);
+        if (face.key.format != format || face.layers != 1)
+            throw std::runtime_error("cubemap face format mismatch: " + face.path);
+
+        if (face.levels != first.levels || face.hasMipChain() != first.hasMipChain()) {
+            if (Engine::Graphics::isBlockCompressed(format))
+                throw std::runtime_error("cubemap face format mismatch: " + face.path);
+            storedMips = false;
         }
     }
 
-    layerSize = texWidth * texHeight * 4;
-    VkDeviceSize imageSize = layerSize * 6;
-
-    mipLevels = 1;
-    //mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+    auto start = std::chrono::steady_clock::now();
 
-    BufferResource* stagingBuffer = framebuffer.createBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    VkImageCreateFlags flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 
-    for (size_t i = 0; i < 6; i++) {
-        memcpy(static_cast<char*>(stagingBuffer->mapped) + (layerSize * i), pixels[i], static_cast<size_t>(layerSize));
-        stbi_image_free(pixels[i]);
+    // all six faces are filtered in one dispatch when the compute generator takes the format
+    if (storedMips) {
+        mipLevels = first.levels;
+    }
+    else if (mipGenerator && mipGenerator->supports(format)) {
+        mipLevels = Engine::Graphics::mipLevelCount(texWidth, texHeight);
+        mipGenerator->prepareImage(format, usage, flags);
+    }
+    else {
+        mipLevels = 1;
     }
 
-    textureResource = framebuffer.createImage(device.getDevice(), device.getPhysicalDevice(), texWidth, texHeight, mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 6, VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT, VK_IMAGE_ASPECT_COLOR_BIT, true, true);
+    textureResource = framebuffer.createImage(device.getDevice(), device.getPhysicalDevice(), texWidth, texHeight, mipLevels, VK_SAMPLE_COUNT_1_BIT, format, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 6, flags, VK_IMAGE_ASPECT_COLOR_BIT, true, true);
     
-    commandBuf.transitionImageLayout(device, textureResource, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, 6);
-    commandBuf.copyBufferToImage(device, stagingBuffer->buffer, textureResource->image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 6);
-    sampler.generateMipmaps(commandBuf, device, textureResource, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels, 6);
-    
-    resources->destroy(stagingBuffer);
+    batch.transitionImageLayout(textureResource, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, 6);
+
+    double decodeMs = 0.0;
+    for (uint32_t i = 0; i < faces.size(); i++) {
+        Engine::Graphics::DecodedImage& face = faces.get(i);
+        uploadDecoded(batch, textureResource, face, i, storedMips ? UINT32_MAX : 1);
+        decodeMs = std::max(decodeMs, face.decodeMs);
+    }
+
+    if (storedMips)
+        batch.transitionImageLayout(textureResource, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels, 6);
+    else
+        batch.generateMipmaps(textureResource, format, texWidth, texHeight, mipLevels, 6);
+
+    double uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    g_console.add("[Texture] cubemap %s: 6x %dx%d%s, slowest face decode %.1f ms, upload %.1f ms\n", first.path.c_str(), texWidth, texHeight, Engine::Graphics::isBlockCompressed(format) ? " BC" : "", decodeMs, uploadMs);
 }
 
 void Engine::Graphics::Texture::createCube()
@@ -777,16 +615,13 @@ void Engine::Graphics::Texture::createSkybox()
 }
 
 void Engine::Graphics::Texture::createCubeVertexBuffer(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer fb) {
-    VkDeviceSize bufferSize = sizeof(cubeVertices[0]) * cubeVertices.size();
-
-    BufferResource* stagingBuffer = fb.createBuffer(
-        device,
-        bufferSize,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    );
+    Engine::Graphics::UploadBatch batch(device, commandBuf);
+    createCubeVertexBuffer(device, batch, fb);
+    batch.flush();
+}
 
-    memcpy(stagingBuffer->mapped, cubeVertices.data(), (size_t)bufferSize);
+void Engine::Graphics::Texture::createCubeVertexBuffer(Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer fb) {
+    VkDeviceSize bufferSize = sizeof(cubeVertices[0]) * cubeVertices.size();
 
     vertexResource = fb.createBuffer(
         device,
@@ -795,59 +630,32 @@ void Engine::Graphics::Texture::createCubeVertexBuffer(Engine::Graphics::Device
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
     );
 
-    commandBuf.copyBuffer(device, stagingBuffer->buffer, vertexResource->buffer, bufferSize);
-
-    resources->destroy(stagingBuffer);
+    batch.uploadBuffer(vertexResource->buffer, 0, cubeVertices.data(), bufferSize);
 }
 
 void Engine::Graphics::Texture::createCubeIndexBuffer(Engine::Graphics::Device device, Engine::Graphics::CommandBuffer commandBuf, Engine::Graphics::FrameBuffer fb)
 {
-    VkDeviceSize bufferSize = sizeof(cubeIndices[0]) * cubeIndices.size();
-    
-    BufferResource* stagingBuffer = fb.createBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    memcpy(stagingBuffer->mapped, cubeIndices.data(), (size_t)bufferSize);
-
-    indexResource = fb.createBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-    commandBuf.copyBuffer(device, stagingBuffer->buffer, indexResource->buffer, bufferSize);
-
-    resources->destroy(stagingBuffer);
+    Engine::Graphics::UploadBatch batch(device, commandBuf);
+    createCubeIndexBuffer(device, batch, fb);
+    batch.flush();
 }
 
-void Engine::Graphics::Texture::createSkyboxUniformBuffers(Engine::Graphics::Device device, Engine::Graphics::FrameBuffer framebuffer)
+void Engine::Graphics::Texture::createCubeIndexBuffer(Engine::Graphics::Device device, Engine::Graphics::UploadBatch& batch, Engine::Graphics::FrameBuffer fb)
 {
-    VkDeviceSize bufferSize = sizeof(SkyboxUBO);
-
-    skyboxUniformResources.resize(Engine::Settings::MAX_FRAMES_IN_FLIGHT);
-
-    for (size_t i = 0; i < Engine::Settings::MAX_FRAMES_IN_FLIGHT; i++) {
-        skyboxUniformResources[i] = framebuffer.createBuffer(device, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        if (!skyboxUniformResources[i]->mapped) {
-            vkMapMemory(device.getDevice(), skyboxUniformResources[i]->memory, 0, bufferSize, 0, &skyboxUniformResources[i]->mapped);
-        }
-    }
-}
+    VkDeviceSize bufferSize = sizeof(cubeIndices[0]) * cubeIndices.size();
 
-void Engine::Graphics::Texture::updateSkyboxUniformBuffer(uint32_t currentImage, Engine::Core::Camera& camera, VkExtent2D swapChainExtent) {
-    camera.AspectRatio = swapChainExtent.width / (float)swapChainExtent.height;
-    SkyboxUBO skyboxUBO{};
-    skyboxUBO.view = glm::mat4(glm::mat3(camera.GetViewMatrix()));
-    skyboxUBO.proj = camera.GetProjectionMatrix();
+    indexResource = fb.createBuffer(device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-    memcpy(skyboxUniformResources[currentImage]->mapped, &skyboxUBO, sizeof(skyboxUBO));
+    batch.uploadBuffer(indexResource->buffer, 0, cubeIndices.data(), bufferSize);
 }
 
 void Engine::Graphics::Texture::cleanup(VkDevice device) {
-    resources->destroy(textureResource);
-
-    for (size_t i = 0; i < skyboxUniformResources.size(); i++) {
-        resources->destroy(skyboxUniformResources[i]);
-    }
+    // with PBR maps textureResource aliases the last map; release each reference once
+    if (textureResources.empty())
+        Engine::Graphics::releaseTexture(textureResource);
 
     for (size_t i = 0; i < textureResources.size(); i++) {
-        resources->destroy(textureResources[i]);
+        Engine::Graphics::releaseTexture(textureResources[i]);
     }
 
     for (auto sem : imageAvailableSemaphores)
@@ -857,13 +665,6 @@ void Engine::Graphics::Texture::cleanup(VkDevice device) {
     for (auto fence : inFlightFences)
         if (fence) vkDestroyFence(device, fence, nullptr);
 
-    for (size_t i = 0; i < uniformResources.size(); ++i) {
-        resources->destroy(uniformResources[i]);
-    }
-    for (size_t i = 0; i < skyboxUniformResources.size(); ++i) {
-        resources->destroy(skyboxUniformResources[i]);
-    }
-
     resources->destroy(vertexResource);
     resources->destroy(indexResource);
 }
\ No newline at end of file
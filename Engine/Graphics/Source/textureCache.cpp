@@ -0,0 +1,90 @@
+#include "textureCache.h"
+
+std::unique_ptr<Engine::Graphics::TextureCache> textureCache;
+
+size_t Engine::Graphics::TextureKeyHash::operator()(const TextureKey& key) const
+{
+	size_t seed = std::hash<std::string>()(key.path);
+
+	auto combine = [&seed](size_t value) {
+		seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	};
+
+	combine(static_cast<size_t>(key.flip));
+	combine(static_cast<size_t>(key.format));
+
+	return seed;
+}
+
+Engine::Graphics::TextureKey Engine::Graphics::TextureCache::makeKey(const std::string& path, bool flip, VkFormat format)
+{
+	// the same file reached through different relative paths must map to one entry
+	std::error_code ec;
+	std::filesystem::path normalized = std::filesystem::weakly_canonical(std::filesystem::absolute(path, ec), ec);
+	if (ec)
+		normalized = std::filesystem::path(path).lexically_normal();
+
+	return { normalized.generic_string(), flip, format };
+}
+
+ImageResource* Engine::Graphics::TextureCache::acquire(const TextureKey& key, uint32_t& mipLevels)
+{
+	auto it = entries.find(key);
+	if (it == entries.end())
+		return nullptr;
+
+	it->second.refCount++;
+	mipLevels = it->second.mipLevels;
+
+	return it->second.image;
+}
+
+void Engine::Graphics::TextureCache::insert(const TextureKey& key, ImageResource* image, uint32_t mipLevels)
+{
+	if (entries.contains(key))
+		throw std::runtime_error("texture " + key.path + " is already cached");
+
+	entries[key] = { image, mipLevels, 1 };
+	owners[image] = key;
+}
+
+void Engine::Graphics::TextureCache::release(ImageResource* image)
+{
+	if (!image)
+		return;
+
+	auto owner = owners.find(image);
+	if (owner == owners.end()) {
+		resources->destroy(image);
+		return;
+	}
+
+	auto it = entries.find(owner->second);
+	if (--it->second.refCount > 0)
+		return;
+
+	entries.erase(it);
+	owners.erase(owner);
+	resources->destroy(image);
+}
+
+void Engine::Graphics::TextureCache::clear()
+{
+	// ResourceManager owns the images; dropping the entries is enough at shutdown
+	entries.clear();
+	owners.clear();
+}
+
+uint32_t Engine::Graphics::TextureCache::useCount(ImageResource* image) const
+{
+	auto owner = owners.find(image);
+	return owner == owners.end() ? 0 : entries.at(owner->second).refCount;
+}
+
+void Engine::Graphics::releaseTexture(ImageResource* image)
+{
+	if (textureCache)
+		textureCache->release(image);
+	else if (image)
+		resources->destroy(image);
+}
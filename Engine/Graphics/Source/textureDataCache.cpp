@@ -0,0 +1,305 @@
+#include "textureDataCache.h"
+#include "meshCache.h"
+#include "mipChain.h"
+#include "threadPool.h"
+
+namespace {
+	size_t alignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+Engine::Graphics::TextureDataCache::Cooking& Engine::Graphics::TextureDataCache::cooking()
+{
+	static Cooking state;
+	return state;
+}
+
+bool Engine::Graphics::TextureDataCache::find(const TextureKey& key, const std::vector<std::string>& sources, Engine::Utility::MappedFile& file, KtxImage& layout)
+{
+	if (sources.empty() || sources.size() > MAX_SOURCES)
+		return false;
+
+	const std::string path = cachePath(key, sources.front());
+	// a loose copy is the freshest cook, the pack's is only used when there is none
+	if (!(file.openFile(path) || file.open(path)) || file.size() < sizeof(FileHeader)) {
+		file.close();
+		return false;
+	}
+
+	FileHeader header{};
+	memcpy(&header, file.data(), sizeof(header));
+
+	const VkFormat format = static_cast<VkFormat>(header.format);
+	const uint64_t fileSize = file.size();
+
+	const bool valid = header.magic == MAGIC && header.version == VERSION && format == key.format && header.sourceCount == sources.size() &&
+		header.width > 0 && header.height > 0 && header.levels > 0 && header.levels <= mipLevelCount(header.width, header.height) &&
+		header.layers > 0 && header.regionCount == header.levels * header.layers &&
+		header.regionOffset <= fileSize && header.regionCount * sizeof(RegionEntry) <= fileSize - header.regionOffset &&
+		header.dataOffset <= fileSize && header.dataSize <= fileSize - header.dataOffset;
+
+	if (!valid) {
+		file.close();
+		return false;
+	}
+
+	// same rules as the mesh cache: missing sources are fine, a changed size is stale and a
+	// changed timestamp alone is settled by hashing the sources again
+	bool stale = false;
+	bool touched = false;
+	for (size_t i = 0; i < sources.size() && !stale; i++) {
+		SourceStamp stamp{};
+		if (!sourceStamp(sources[i], stamp))
+			continue;
+
+		stale = stamp.size != header.sources[i].size;
+		touched |= stamp.time != header.sources[i].time;
+	}
+
+	if (!stale && touched)
+		stale = hashSources(sources) != header.sourceHash;
+
+	if (stale) {
+		g_console.add("[Texture Cache] %s is stale, re-cooking\n", path.c_str());
+		file.close();
+		return false;
+	}
+
+	layout = {};
+	layout.format = format;
+	layout.width = header.width;
+	layout.height = header.height;
+	layout.levels = header.levels;
+	layout.layers = header.layers;
+	layout.regions.reserve(header.regionCount);
+
+	for (uint32_t i = 0; i < header.regionCount; i++) {
+		RegionEntry entry{};
+		memcpy(&entry, file.data() + header.regionOffset + i * sizeof(RegionEntry), sizeof(entry));
+
+		const uint32_t width = std::max(header.width >> entry.level, 1u);
+		const uint32_t height = std::max(header.height >> entry.level, 1u);
+
+		if (entry.level >= header.levels || entry.layer >= header.layers || entry.width != width || entry.height != height ||
+			entry.size != imageLevelSize(format, width, height) || entry.offset > header.dataSize || entry.size > header.dataSize - entry.offset) {
+			file.close();
+			return false;
+		}
+
+		ImageRegion region{};
+		region.offset = header.dataOffset + entry.offset;
+		region.size = entry.size;
+		region.width = width;
+		region.height = height;
+		region.level = entry.level;
+		region.layer = entry.layer;
+		layout.regions.push_back(region);
+	}
+
+	return true;
+}
+
+void Engine::Graphics::TextureDataCache::cook(const TextureKey& key, const std::vector<std::string>& sources, uint32_t width, uint32_t height, const void* data, const std::vector<ImageRegion>& regions)
+{
+	if (sources.empty() || sources.size() > MAX_SOURCES || regions.empty())
+		return;
+
+	const std::string path = cachePath(key, sources.front());
+	Cooking& state = cooking();
+
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (std::find(state.paths.begin(), state.paths.end(), path) != state.paths.end())
+			return;
+
+		state.paths.push_back(path);
+	}
+
+	// the caller's pixels usually sit in staging memory that is recycled after the upload
+	const ImageRegion& last = regions.back();
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	std::vector<uint8_t> pixels(bytes, bytes + static_cast<size_t>(last.offset + last.size));
+
+	auto task = [path, key, sources, width, height, regions, pixels = std::move(pixels)]() {
+		try {
+			write(path, key, sources, width, height, pixels.data(), regions);
+		}
+		catch (const std::exception& e) {
+			g_logBuffer.push("[Texture Cache] failed to cook " + sources.front() + ": " + e.what() + "\n");
+		}
+
+		Cooking& state = cooking();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		state.paths.erase(std::find(state.paths.begin(), state.paths.end(), path));
+	};
+
+	if (!threadPool) {
+		task();
+		return;
+	}
+
+	std::future<void> future = threadPool->submit(std::move(task));
+
+	std::lock_guard<std::mutex> lock(state.mutex);
+	std::erase_if(state.pending, [](const std::future<void>& cook) {
+		return cook.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	});
+	state.pending.push_back(std::move(future));
+}
+
+bool Engine::Graphics::TextureDataCache::store(const TextureKey& key, const std::vector<std::string>& sources, uint32_t width, uint32_t height, const void* data, const std::vector<ImageRegion>& regions)
+{
+	if (sources.empty() || sources.size() > MAX_SOURCES || regions.empty())
+		return false;
+
+	return write(cachePath(key, sources.front()), key, sources, width, height, static_cast<const uint8_t*>(data), regions);
+}
+
+void Engine::Graphics::TextureDataCache::finish()
+{
+	Cooking& state = cooking();
+	std::vector<std::future<void>> pending;
+
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		pending.swap(state.pending);
+	}
+
+	for (auto& future : pending)
+		future.wait();
+}
+
+std::string Engine::Graphics::TextureDataCache::cachePath(const TextureKey& key, const std::string& source)
+{
+	std::string id = key.path + (key.flip ? "|flip|" : "|-|") + std::to_string(key.format);
+
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(Engine::Utility::hashBytes(id.data(), id.size())));
+
+	std::filesystem::path path(DEFAULT_DIRECTORY);
+	path /= std::filesystem::path(source).stem().string() + "-" + name + ".ftex";
+	return path.string();
+}
+
+bool Engine::Graphics::TextureDataCache::sourceStamp(const std::string& path, SourceStamp& stamp)
+{
+	std::error_code ec;
+
+	auto size = std::filesystem::file_size(path, ec);
+	if (ec)
+		return false;
+
+	auto time = std::filesystem::last_write_time(path, ec);
+	if (ec)
+		return false;
+
+	stamp.size = static_cast<uint64_t>(size);
+	stamp.time = static_cast<int64_t>(time.time_since_epoch().count());
+	return true;
+}
+
+uint64_t Engine::Graphics::TextureDataCache::hashSources(const std::vector<std::string>& sources)
+{
+	// loose files only, so the hash describes the same bytes sourceStamp looked at
+	std::vector<uint64_t> hashes;
+	for (const auto& source : sources) {
+		Engine::Utility::MappedFile file;
+		hashes.push_back(file.openFile(source) ? MeshCache::hashFile(file.data(), file.size()) : 0);
+	}
+
+	return Engine::Utility::hashBytes(hashes.data(), hashes.size() * sizeof(uint64_t), sources.size());
+}
+
+bool Engine::Graphics::TextureDataCache::write(const std::string& path, const TextureKey& key, const std::vector<std::string>& sources, uint32_t width, uint32_t height, const uint8_t* data, const std::vector<ImageRegion>& regions)
+{
+	FileHeader header{};
+	for (size_t i = 0; i < sources.size(); i++) {
+		if (!sourceStamp(sources[i], header.sources[i]))
+			return false;
+	}
+
+	// plain images arrive as level 0 alone; block-compressed ones already carry their chain
+	std::vector<ImageRegion> chain = regions;
+	std::vector<uint8_t> built;
+
+	if (regions.size() == 1 && !isBlockCompressed(key.format) && mipLevelCount(width, height) > 1) {
+		built.resize(static_cast<size_t>(imageDataSize(key.format, width, height, mipLevelCount(width, height))));
+		chain = MipChain::build(key.format, data + regions[0].offset, width, height, built.data());
+		data = built.data();
+	}
+
+	std::vector<RegionEntry> entries(chain.size());
+	uint64_t dataSize = 0;
+	uint32_t levels = 0;
+	uint32_t layers = 0;
+
+	for (size_t i = 0; i < chain.size(); i++) {
+		dataSize = alignImageRegion(dataSize);
+		entries[i] = { dataSize, chain[i].size, chain[i].width, chain[i].height, chain[i].level, chain[i].layer };
+		dataSize += chain[i].size;
+
+		levels = std::max(levels, chain[i].level + 1);
+		layers = std::max(layers, chain[i].layer + 1);
+	}
+
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.format = static_cast<uint32_t>(key.format);
+	header.width = width;
+	header.height = height;
+	header.levels = levels;
+	header.layers = layers;
+	header.regionCount = static_cast<uint32_t>(entries.size());
+	header.sourceCount = static_cast<uint32_t>(sources.size());
+	header.sourceHash = hashSources(sources);
+	header.regionOffset = sizeof(FileHeader);
+	header.dataOffset = alignUp(sizeof(FileHeader) + entries.size() * sizeof(RegionEntry), BLOB_ALIGNMENT);
+	header.dataSize = dataSize;
+
+	std::filesystem::path target(path);
+	std::filesystem::path temp = target;
+	temp += ".tmp";
+
+	std::error_code ec;
+	std::filesystem::create_directories(target.parent_path(), ec);
+
+	{
+		std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			g_logBuffer.push("[Texture Cache] failed to open " + temp.string() + " for writing\n");
+			return false;
+		}
+
+		const char padding[BLOB_ALIGNMENT] = {};
+		auto pad = [&](uint64_t offset) {
+			file.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(file.tellp())));
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(RegionEntry)));
+
+		for (size_t i = 0; i < chain.size(); i++) {
+			pad(header.dataOffset + entries[i].offset);
+			file.write(reinterpret_cast<const char*>(data + chain[i].offset), static_cast<std::streamsize>(chain[i].size));
+		}
+
+		if (!file.good()) {
+			file.close();
+			std::filesystem::remove(temp, ec);
+			g_logBuffer.push("[Texture Cache] failed to write " + temp.string() + "\n");
+			return false;
+		}
+	}
+
+	std::filesystem::rename(temp, target, ec);
+	if (ec) {
+		std::filesystem::remove(temp, ec);
+		g_logBuffer.push("[Texture Cache] failed to replace " + path + "\n");
+		return false;
+	}
+
+	g_logBuffer.push("[Texture Cache] cooked " + sources.front() + " into " + path + "\n");
+	return true;
+}
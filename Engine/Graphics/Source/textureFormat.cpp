@@ -0,0 +1,159 @@
+#include "textureFormat.h"
+#include <atomic>
+
+namespace {
+	std::atomic<bool> bcSupported{ false };
+}
+
+uint32_t Engine::Graphics::formatTexelSize(VkFormat format)
+{
+	switch (format) {
+		case VK_FORMAT_R8_UNORM:
+		case VK_FORMAT_R8_SRGB:
+			return 1;
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R8G8_SRGB:
+			return 2;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return 4;
+		default:
+			throw std::runtime_error("unsupported texture format " + std::to_string(format));
+	}
+}
+
+bool Engine::Graphics::isBlockCompressed(VkFormat format)
+{
+	switch (format) {
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return true;
+		default:
+			return false;
+	}
+}
+
+uint32_t Engine::Graphics::formatBlockBytes(VkFormat format)
+{
+	switch (format) {
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			return 8;
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return 16;
+		default:
+			return formatTexelSize(format);
+	}
+}
+
+uint32_t Engine::Graphics::formatBlockExtent(VkFormat format)
+{
+	return isBlockCompressed(format) ? 4 : 1;
+}
+
+VkDeviceSize Engine::Graphics::imageLevelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+	const uint32_t extent = formatBlockExtent(format);
+	const VkDeviceSize blocksX = (width + extent - 1) / extent;
+	const VkDeviceSize blocksY = (height + extent - 1) / extent;
+
+	return blocksX * blocksY * formatBlockBytes(format);
+}
+
+VkDeviceSize Engine::Graphics::imageDataSize(VkFormat format, uint32_t width, uint32_t height, uint32_t levels)
+{
+	VkDeviceSize size = 0;
+	for (uint32_t level = 0; level < levels; level++)
+		size = alignImageRegion(size) + imageLevelSize(format, std::max(width >> level, 1u), std::max(height >> level, 1u));
+
+	return size;
+}
+
+uint32_t Engine::Graphics::mipLevelCount(uint32_t width, uint32_t height)
+{
+	return static_cast<uint32_t>(std::floor(std::log2(std::max({ width, height, 1u })))) + 1;
+}
+
+std::vector<Engine::Graphics::ImageRegion> Engine::Graphics::mipRegions(VkFormat format, uint32_t width, uint32_t height, uint32_t levels, uint32_t layer)
+{
+	std::vector<ImageRegion> regions;
+	regions.reserve(levels);
+
+	VkDeviceSize offset = 0;
+	for (uint32_t level = 0; level < levels; level++) {
+		ImageRegion region{};
+		region.offset = alignImageRegion(offset);
+		region.width = std::max(width >> level, 1u);
+		region.height = std::max(height >> level, 1u);
+		region.size = imageLevelSize(format, region.width, region.height);
+		region.level = level;
+		region.layer = layer;
+
+		offset = region.offset + region.size;
+		regions.push_back(region);
+	}
+
+	return regions;
+}
+
+VkFormat Engine::Graphics::decodeFormat(VkFormat format)
+{
+	switch (format) {
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return VK_FORMAT_R8G8B8A8_SRGB;
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+			return VK_FORMAT_R8G8_UNORM;
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			return VK_FORMAT_R8_UNORM;
+		default:
+			return format;
+	}
+}
+
+VkFormat Engine::Graphics::selectTextureFormat(VkFormat format)
+{
+	if (!Engine::Settings::compressTextures || !blockCompressionSupported())
+		return format;
+
+	const bool bc1 = Engine::Settings::colourCompression == Engine::Settings::ColourCompression::BC1;
+
+	switch (format) {
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return bc1 ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC7_SRGB_BLOCK;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+			return bc1 ? VK_FORMAT_BC1_RGB_UNORM_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+		case VK_FORMAT_R8G8_UNORM:
+			return VK_FORMAT_BC5_UNORM_BLOCK;
+		case VK_FORMAT_R8_UNORM:
+			return VK_FORMAT_BC4_UNORM_BLOCK;
+		default:
+			return format;
+	}
+}
+
+void Engine::Graphics::setBlockCompressionSupport(bool supported)
+{
+	bcSupported = supported;
+}
+
+bool Engine::Graphics::blockCompressionSupported()
+{
+	return bcSupported;
+}
@@ -0,0 +1,530 @@
+#include "textureLoader.h"
+#include "uploadBatch.h"
+#include "decodeTarget.h"
+#include "threadPool.h"
+#include "blockCompression.h"
+#include "textureDataCache.h"
+
+namespace {
+	using PixelBuffer = std::unique_ptr<stbi_uc, void(*)(void*)>;
+
+	// keeps the leading channels; grey sources fill every channel instead
+	void copyChannels(const stbi_uc* src, int srcChannels, stbi_uc* dst, int dstChannels, size_t texels)
+	{
+		if (srcChannels == dstChannels) {
+			memcpy(dst, src, texels * static_cast<size_t>(dstChannels));
+			return;
+		}
+
+		const int step = srcChannels >= 3 ? 1 : 0;
+		for (size_t i = 0; i < texels; i++) {
+			for (int c = 0; c < dstChannels; c++)
+				dst[i * dstChannels + c] = src[i * srcChannels + c * step];
+		}
+	}
+
+	bool fitsDecoder(const Engine::Utility::MappedFile& file)
+	{
+		return file.isOpen() && file.size() <= static_cast<size_t>(std::numeric_limits<int>::max());
+	}
+
+	std::string failureReason()
+	{
+		const char* reason = stbi_failure_reason();
+		return reason ? reason : "unknown error";
+	}
+}
+
+Engine::Graphics::TextureLoadJob::TextureLoadJob(const Engine::Graphics::UploadBatch& batch)
+	: stagingAlignment(batch.getCopyAlignment()), stageDecodes(stagingRing != nullptr)
+{
+}
+
+Engine::Graphics::TextureLoadJob::~TextureLoadJob()
+{
+	// jobs write into images; never let them outlive it
+	for (auto& future : pending) {
+		if (future.valid())
+			future.wait();
+	}
+
+	for (auto& image : images) {
+		if (image->isStaged())
+			stagingRing->release(image->staging.id);
+	}
+}
+
+size_t Engine::Graphics::TextureLoadJob::add(const std::string& path, bool flip, VkFormat format, bool shared)
+{
+	if (KtxFile::isKtx2(path))
+		return addKtx(path, shared);
+
+	auto image = std::make_unique<DecodedImage>();
+	image->path = path;
+	image->key = TextureCache::makeKey(path, flip, selectTextureFormat(format));
+
+	if (shared && markResident(*image))
+		return enqueue(std::move(image), nullptr);
+
+	if (auto index = addCooked(image, { path }))
+		return *index;
+
+	auto file = std::make_shared<Engine::Utility::MappedFile>();
+	int width, height;
+	if (file->open(path) && stageDecodes && readHeader(*file, width, height))
+		reserveStaging(*image, width, height);
+
+	return enqueue(std::move(image), [file, flip, path](DecodedImage& target) {
+		decode(target, *file, flip);
+		cookDecoded(target, { path });
+	});
+}
+
+size_t Engine::Graphics::TextureLoadJob::addSolid(const std::array<uint8_t, 4>& texel, VkFormat format)
+{
+	const uint32_t texelSize = formatTexelSize(format);
+	if (isBlockCompressed(format) || texelSize > texel.size())
+		throw std::runtime_error("solid textures need an uncompressed format of at most four bytes");
+
+	auto image = std::make_unique<DecodedImage>();
+	image->path = "solid";
+	for (uint8_t value : texel)
+		image->path += "|" + std::to_string(value);
+	image->key = { image->path, false, format };
+
+	if (markResident(*image))
+		return enqueue(std::move(image), nullptr);
+
+	// there is nothing to decode, so the texel is written here and never staged
+	stbi_uc* dst = output(*image, texelSize);
+	if (!dst)
+		throw std::runtime_error("out of memory");
+
+	memcpy(dst, texel.data(), texelSize);
+	image->width = 1;
+	image->height = 1;
+	image->channels = static_cast<int>(texelSize);
+	image->regions = mipRegions(format, 1, 1, 1);
+
+	return enqueue(std::move(image), nullptr);
+}
+
+Engine::Graphics::TextureKey Engine::Graphics::TextureLoadJob::packedKey(const std::array<std::string, 3>& paths, const std::array<uint8_t, 3>& defaults, bool flip)
+{
+	std::string key = "packed";
+	bool any = false;
+
+	for (size_t c = 0; c < paths.size(); c++) {
+		if (paths[c].empty()) {
+			key += "|" + std::to_string(defaults[c]);
+			continue;
+		}
+
+		key += "|" + TextureCache::makeKey(paths[c], flip, VK_FORMAT_R8_UNORM).path;
+		any = true;
+	}
+
+	if (!any)
+		throw std::runtime_error("packed texture needs at least one source");
+
+	return { key, flip, selectTextureFormat(VK_FORMAT_R8G8B8A8_UNORM) };
+}
+
+size_t Engine::Graphics::TextureLoadJob::addPacked(const std::array<std::string, 3>& paths, const std::array<uint8_t, 3>& defaults, bool flip)
+{
+	auto image = std::make_unique<DecodedImage>();
+	for (const auto& path : paths) {
+		if (!path.empty())
+			image->path += (image->path.empty() ? "" : " + ") + path;
+	}
+
+	image->key = packedKey(paths, defaults, flip);
+
+	if (markResident(*image))
+		return enqueue(std::move(image), nullptr);
+
+	std::vector<std::string> sources;
+	std::copy_if(paths.begin(), paths.end(), std::back_inserter(sources), [](const std::string& path) { return !path.empty(); });
+
+	if (auto index = addCooked(image, sources))
+		return *index;
+
+	// staging is sized from the largest header; any unreadable source leaves it on the heap
+	FileList files(paths.size());
+	int width = 0, height = 0;
+	bool sized = true;
+
+	for (size_t c = 0; c < paths.size(); c++) {
+		if (paths[c].empty())
+			continue;
+
+		files[c] = std::make_shared<Engine::Utility::MappedFile>();
+
+		int sourceWidth, sourceHeight;
+		if (files[c]->open(paths[c]) && readHeader(*files[c], sourceWidth, sourceHeight)) {
+			width = std::max(width, sourceWidth);
+			height = std::max(height, sourceHeight);
+		}
+		else {
+			sized = false;
+		}
+	}
+
+	if (sized && stageDecodes)
+		reserveStaging(*image, width, height);
+
+	return enqueue(std::move(image), [paths, files, defaults, flip, sources](DecodedImage& target) {
+		decodePacked(target, paths, files, defaults, flip);
+		cookDecoded(target, sources);
+	});
+}
+
+Engine::Graphics::DecodedImage& Engine::Graphics::TextureLoadJob::get(size_t index)
+{
+	if (pending[index].valid())
+		pending[index].get();
+
+	DecodedImage& image = *images[index];
+	if (!image.error.empty()) {
+		if (image.isStaged()) {
+			stagingRing->release(image.staging.id);
+			image.staging = {};
+		}
+
+		throw std::runtime_error("failed to load texture image " + image.path + ": " + image.error);
+	}
+
+	return image;
+}
+
+size_t Engine::Graphics::TextureLoadJob::enqueue(std::unique_ptr<DecodedImage> image, std::function<void(DecodedImage&)> work)
+{
+	DecodedImage* target = image.get();
+	images.push_back(std::move(image));
+
+	if (!work) {
+		pending.emplace_back();
+	}
+	else if (threadPool) {
+		pending.push_back(threadPool->submit([target, work = std::move(work)]() { work(*target); }));
+	}
+	else {
+		work(*target);
+		pending.emplace_back();
+	}
+
+	return images.size() - 1;
+}
+
+size_t Engine::Graphics::TextureLoadJob::addKtx(const std::string& path, bool shared)
+{
+	auto image = std::make_unique<DecodedImage>();
+	image->path = path;
+
+	auto file = std::make_shared<Engine::Utility::MappedFile>();
+	KtxImage layout;
+
+	if (!file->open(path))
+		image->error = "could not open file";
+	else if (KtxFile::read(file->data(), file->size(), layout, image->error) && isBlockCompressed(layout.format) && !blockCompressionSupported())
+		image->error = "the device cannot sample block-compressed textures";
+
+	// the file decides the format; flipping would need the blocks re-encoded
+	image->key = TextureCache::makeKey(path, false, layout.format);
+
+	if (!image->error.empty() || (shared && markResident(*image)))
+		return enqueue(std::move(image), nullptr);
+
+	return enqueueLayout(std::move(image), file, layout);
+}
+
+std::optional<size_t> Engine::Graphics::TextureLoadJob::addCooked(std::unique_ptr<DecodedImage>& image, const std::vector<std::string>& sources)
+{
+	if (!Engine::Settings::cookTextures)
+		return std::nullopt;
+
+	auto file = std::make_shared<Engine::Utility::MappedFile>();
+	KtxImage layout;
+
+	if (!TextureDataCache::find(image->key, sources, *file, layout))
+		return std::nullopt;
+
+	image->cooked = true;
+	return enqueueLayout(std::move(image), file, layout);
+}
+
+size_t Engine::Graphics::TextureLoadJob::enqueueLayout(std::unique_ptr<DecodedImage> image, std::shared_ptr<Engine::Utility::MappedFile> file, const KtxImage& layout)
+{
+	if (stageDecodes && reserveStaging(*image, layout.dataSize())) {
+		image->width = static_cast<int>(layout.width);
+		image->height = static_cast<int>(layout.height);
+	}
+
+	return enqueue(std::move(image), [file, layout](DecodedImage& target) { copyLayout(target, *file, layout); });
+}
+
+bool Engine::Graphics::TextureLoadJob::markResident(DecodedImage& image) const
+{
+	image.resident = textureCache && (textureCache->contains(image.key) || std::any_of(images.begin(), images.end(), [&](const auto& other) {
+		return other->key == image.key;
+	}));
+
+	return image.resident;
+}
+
+void Engine::Graphics::TextureLoadJob::reserveStaging(DecodedImage& image, int width, int height)
+{
+	// block formats are encoded with their whole mip chain
+	const VkFormat format = image.key.format;
+	const uint32_t levels = isBlockCompressed(format) ? mipLevelCount(width, height) : 1;
+
+	if (reserveStaging(image, imageDataSize(format, static_cast<uint32_t>(width), static_cast<uint32_t>(height), levels))) {
+		image.width = width;
+		image.height = height;
+	}
+}
+
+bool Engine::Graphics::TextureLoadJob::reserveStaging(DecodedImage& image, VkDeviceSize size)
+{
+	std::optional<StagingAllocation> staging;
+
+	if (size <= stagingRing->getMaxChunkSize())
+		staging = stagingRing->allocate(size, stagingAlignment);
+
+	// once one image misses, later ones stay on the heap too so every staged image comes
+	// before any heap image in upload order and the batch can always stage those
+	if (!staging) {
+		stageDecodes = false;
+		return false;
+	}
+
+	image.staging = *staging;
+	return true;
+}
+
+bool Engine::Graphics::TextureLoadJob::readHeader(const Engine::Utility::MappedFile& file, int& width, int& height)
+{
+	int channels;
+	return fitsDecoder(file) && stbi_info_from_memory(reinterpret_cast<const stbi_uc*>(file.data()), static_cast<int>(file.size()), &width, &height, &channels);
+}
+
+stbi_uc* Engine::Graphics::TextureLoadJob::output(DecodedImage& image, size_t size)
+{
+	if (image.isStaged())
+		return static_cast<stbi_uc*>(image.staging.mapped);
+
+	image.pixels.reset(static_cast<stbi_uc*>(Engine::Utility::decodeMalloc(size)));
+	return image.pixels.get();
+}
+
+void Engine::Graphics::TextureLoadJob::encode(DecodedImage& image, const stbi_uc* pixels, int width, int height)
+{
+	const uint32_t w = static_cast<uint32_t>(width);
+	const uint32_t h = static_cast<uint32_t>(height);
+
+	stbi_uc* dst = output(image, static_cast<size_t>(imageDataSize(image.key.format, w, h, mipLevelCount(w, h))));
+	if (!dst) {
+		image.error = "out of memory";
+		return;
+	}
+
+	image.regions = BlockCompression::encodeMipChain(image.key.format, pixels, w, h, dst);
+	image.levels = static_cast<uint32_t>(image.regions.size());
+}
+
+void Engine::Graphics::TextureLoadJob::decode(DecodedImage& image, const Engine::Utility::MappedFile& file, bool flip)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	if (!fitsDecoder(file)) {
+		image.error = "could not open file";
+		return;
+	}
+
+	// the global flip flag would race between workers; the per-thread one does not
+	stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
+
+	// RGBA decodes straight into staging; narrower formats decode at the file's own channel
+	// count and keep what they need. Block formats decode to the heap and are encoded from there.
+	const VkFormat format = image.key.format;
+	const bool compressed = isBlockCompressed(format);
+	const int texelSize = static_cast<int>(formatTexelSize(decodeFormat(format)));
+	const bool rgba = texelSize == 4;
+	const bool direct = rgba && !compressed;
+
+	if (direct && image.isStaged())
+		Engine::Utility::armDecodeTarget(image.staging.mapped, static_cast<size_t>(image.staging.size));
+
+	int width, height;
+	stbi_uc* decoded = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.data()), static_cast<int>(file.size()), &width, &height, &image.channels, rgba ? STBI_rgb_alpha : 0);
+
+	Engine::Utility::disarmDecodeTarget();
+
+	if (!decoded) {
+		image.error = failureReason();
+		return;
+	}
+
+	const bool inPlace = decoded == image.staging.mapped;
+	PixelBuffer pixels(inPlace ? nullptr : decoded, stbi_image_free);
+	const int srcChannels = rgba ? 4 : image.channels;
+	const size_t texels = static_cast<size_t>(width) * height;
+
+	if (image.isStaged() && (width != image.width || height != image.height)) {
+		image.error = "decoded size does not match the header";
+	}
+	else if (compressed) {
+		std::vector<stbi_uc> narrowed;
+		if (srcChannels != texelSize) {
+			narrowed.resize(texels * texelSize);
+			copyChannels(pixels.get(), srcChannels, narrowed.data(), texelSize, texels);
+		}
+
+		encode(image, narrowed.empty() ? pixels.get() : narrowed.data(), width, height);
+	}
+	else if (direct && !image.isStaged()) {
+		image.pixels = std::move(pixels);
+	}
+	else if (!inPlace) {
+		stbi_uc* dst = output(image, texels * texelSize);
+		if (dst)
+			copyChannels(pixels.get(), srcChannels, dst, texelSize, texels);
+		else
+			image.error = "out of memory";
+	}
+
+	image.width = width;
+	image.height = height;
+	if (!compressed)
+		image.regions = mipRegions(format, static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1);
+	image.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Engine::Graphics::TextureLoadJob::copyLayout(DecodedImage& image, const Engine::Utility::MappedFile& file, const KtxImage& layout)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	stbi_uc* dst = output(image, static_cast<size_t>(layout.dataSize()));
+	if (!dst) {
+		image.error = "out of memory";
+		return;
+	}
+
+	// regions are repacked back to back, so they can be staged as one block
+	const stbi_uc* src = reinterpret_cast<const stbi_uc*>(file.data());
+	VkDeviceSize offset = 0;
+
+	image.regions = layout.regions;
+	for (auto& region : image.regions) {
+		offset = alignImageRegion(offset);
+		memcpy(dst + offset, src + region.offset, static_cast<size_t>(region.size));
+		region.offset = offset;
+		offset += region.size;
+	}
+
+	image.width = static_cast<int>(layout.width);
+	image.height = static_cast<int>(layout.height);
+	image.levels = layout.levels;
+	image.layers = layout.layers;
+	image.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Engine::Graphics::TextureLoadJob::cookDecoded(const DecodedImage& image, const std::vector<std::string>& sources)
+{
+	if (!Engine::Settings::cookTextures || !image.error.empty())
+		return;
+
+	TextureDataCache::cook(image.key, sources, static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height), image.data(), image.regions);
+}
+
+void Engine::Graphics::TextureLoadJob::decodePacked(DecodedImage& image, const std::array<std::string, 3>& paths, const FileList& files, const std::array<uint8_t, 3>& defaults, bool flip)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	struct Source {
+		PixelBuffer pixels{ nullptr, stbi_image_free };
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+	};
+
+	std::array<Source, 3> sources;
+	int width = 0, height = 0;
+
+	stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
+
+	for (size_t c = 0; c < sources.size(); c++) {
+		if (!files[c])
+			continue;
+
+		if (!fitsDecoder(*files[c])) {
+			image.error = "could not open " + paths[c];
+			return;
+		}
+
+		Source& source = sources[c];
+		source.pixels.reset(stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(files[c]->data()), static_cast<int>(files[c]->size()), &source.width, &source.height, &source.channels, 0));
+
+		if (!source.pixels) {
+			image.error = paths[c] + ": " + failureReason();
+			return;
+		}
+
+		width = std::max(width, source.width);
+		height = std::max(height, source.height);
+	}
+
+	if (image.isStaged() && (width != image.width || height != image.height)) {
+		image.error = "decoded size does not match the header";
+		return;
+	}
+
+	// block formats pack into a scratch level first and encode from it
+	const bool compressed = isBlockCompressed(image.key.format);
+	std::vector<stbi_uc> packed;
+	stbi_uc* dst;
+
+	if (compressed) {
+		packed.resize(static_cast<size_t>(width) * height * 4);
+		dst = packed.data();
+	}
+	else {
+		dst = output(image, static_cast<size_t>(width) * height * 4);
+		if (!dst) {
+			image.error = "out of memory";
+			return;
+		}
+	}
+
+	// smaller sources are scaled up nearest-neighbour; mips smooth them out further down
+	for (int y = 0; y < height; y++) {
+		stbi_uc* row = dst + static_cast<size_t>(y) * width * 4;
+
+		for (size_t c = 0; c < sources.size(); c++) {
+			const Source& source = sources[c];
+
+			if (!source.pixels) {
+				for (int x = 0; x < width; x++)
+					row[x * 4 + c] = defaults[c];
+				continue;
+			}
+
+			const stbi_uc* src = source.pixels.get() + static_cast<size_t>(y * source.height / height) * source.width * source.channels;
+			for (int x = 0; x < width; x++)
+				row[x * 4 + c] = src[(x * source.width / width) * source.channels];
+		}
+
+		for (int x = 0; x < width; x++)
+			row[x * 4 + 3] = 255;
+	}
+
+	if (compressed)
+		encode(image, dst, width, height);
+	else
+		image.regions = mipRegions(image.key.format, static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1);
+
+	image.width = width;
+	image.height = height;
+	image.channels = 4;
+	image.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,291 @@
+#include "uploadBatch.h"
+#include "commandBuffer.h"
+#include "sampler.h"
+#include "device.h"
+
+Engine::Graphics::UploadBatch::UploadBatch(const Engine::Graphics::Device& device, const Engine::Graphics::CommandBuffer& commandBuf)
+{
+	begin(device, commandBuf);
+}
+
+Engine::Graphics::UploadBatch::~UploadBatch()
+{
+	if (recording)
+		submit();
+
+	if (submitted)
+		wait();
+}
+
+void Engine::Graphics::UploadBatch::begin(const Engine::Graphics::Device& device, const Engine::Graphics::CommandBuffer& commandBuf)
+{
+	if (recording || submitted)
+		throw std::runtime_error("upload batch is already in use");
+
+	this->device = device.getDevice();
+	this->physicalDevice = device.getPhysicalDevice();
+	this->queue = device.getGraphicsQueue();
+	this->commandPool = commandBuf.getCommandPool();
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	copyAlignment = std::max<VkDeviceSize>(properties.limits.optimalBufferCopyOffsetAlignment, 16);
+
+	start();
+}
+
+void Engine::Graphics::UploadBatch::start()
+{
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandPool = commandPool;
+	allocInfo.commandBufferCount = 1;
+
+	if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+		throw std::runtime_error("failed to allocate upload command buffer");
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+		throw std::runtime_error("failed to create upload fence");
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	recording = true;
+}
+
+void Engine::Graphics::UploadBatch::submit()
+{
+	if (!recording)
+		return;
+
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+		1, &barrier,
+		0, nullptr,
+		0, nullptr
+	);
+
+	vkEndCommandBuffer(commandBuffer);
+	recording = false;
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS)
+		throw std::runtime_error("failed to submit upload batch");
+
+	stagingRing->submit(stagingRegions, fence);
+	submitted = true;
+}
+
+void Engine::Graphics::UploadBatch::wait()
+{
+	if (!submitted)
+		return;
+
+	vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX);
+	release();
+}
+
+bool Engine::Graphics::UploadBatch::isComplete()
+{
+	if (recording)
+		return false;
+
+	if (submitted) {
+		if (vkGetFenceStatus(device, fence) != VK_SUCCESS)
+			return false;
+
+		release();
+	}
+
+	return true;
+}
+
+void Engine::Graphics::UploadBatch::flush()
+{
+	submit();
+	wait();
+}
+
+void Engine::Graphics::UploadBatch::release()
+{
+	stagingRing->retire(fence);
+	stagingRegions.clear();
+
+	for (BufferResource* buffer : stagingBuffers)
+		resources->destroyImmediate(buffer);
+	stagingBuffers.clear();
+
+	for (auto& dispatch : mipDispatches)
+		mipGenerator->release(dispatch);
+	mipDispatches.clear();
+
+	vkFreeCommandBuffers(device, commandPool, 1, &commandBuffer);
+	commandBuffer = VK_NULL_HANDLE;
+
+	vkDestroyFence(device, fence, nullptr);
+	fence = VK_NULL_HANDLE;
+
+	submitted = false;
+}
+
+Engine::Graphics::StagingAllocation Engine::Graphics::UploadBatch::stage(VkDeviceSize size)
+{
+	std::optional<StagingAllocation> allocation = stagingRing->allocate(size, copyAlignment);
+
+	if (!allocation && !stagingRegions.empty()) {
+		flush();
+		start();
+		allocation = stagingRing->allocate(size, copyAlignment);
+	}
+
+	// other batches' regions can fill the ring while this one holds none
+	if (!allocation)
+		return stageBuffer(size);
+
+	stagingRegions.push_back(allocation->id);
+	return *allocation;
+}
+
+Engine::Graphics::StagingAllocation Engine::Graphics::UploadBatch::stageBuffer(VkDeviceSize size)
+{
+	BufferResource* buffer = resources->create<BufferResource>(device, physicalDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	stagingBuffers.push_back(buffer);
+
+	if (!buffer->mapped)
+		throw std::runtime_error("failed to map staging buffer");
+
+	StagingAllocation allocation{};
+	allocation.buffer = buffer->buffer;
+	allocation.size = size;
+	allocation.mapped = buffer->mapped;
+	return allocation;
+}
+
+void Engine::Graphics::UploadBatch::uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size)
+{
+	const char* src = static_cast<const char*>(data);
+	VkDeviceSize maxChunk = stagingRing->getMaxChunkSize();
+
+	for (VkDeviceSize offset = 0; offset < size; offset += maxChunk) {
+		VkDeviceSize chunk = std::min(maxChunk, size - offset);
+		StagingAllocation staging = stage(chunk);
+
+		memcpy(staging.mapped, src + offset, static_cast<size_t>(chunk));
+
+		VkBufferCopy copyRegion{};
+		copyRegion.srcOffset = staging.offset;
+		copyRegion.dstOffset = dstOffset + offset;
+		copyRegion.size = chunk;
+		vkCmdCopyBuffer(commandBuffer, staging.buffer, dstBuffer, 1, &copyRegion);
+	}
+}
+
+void Engine::Graphics::UploadBatch::uploadImage(ImageResource* image, const void* pixels, VkFormat format, const ImageRegion& region, uint32_t baseLayer)
+{
+	// block formats are copied in whole rows of blocks
+	const char* src = static_cast<const char*>(pixels);
+	const uint32_t blockExtent = formatBlockExtent(format);
+	const uint32_t blockRows = (region.height + blockExtent - 1) / blockExtent;
+	VkDeviceSize rowPitch = imageLevelSize(format, region.width, 1);
+	VkDeviceSize maxChunk = stagingRing->getMaxChunkSize();
+
+	if (rowPitch > maxChunk)
+		throw std::runtime_error("image row does not fit in staging ring");
+
+	uint32_t rowsPerChunk = static_cast<uint32_t>(std::min<VkDeviceSize>(maxChunk / rowPitch, blockRows));
+
+	for (uint32_t row = 0; row < blockRows; row += rowsPerChunk) {
+		uint32_t rows = std::min(rowsPerChunk, blockRows - row);
+		VkDeviceSize chunk = rowPitch * rows;
+		StagingAllocation staging = stage(chunk);
+
+		memcpy(staging.mapped, src + rowPitch * row, static_cast<size_t>(chunk));
+
+		uint32_t y = row * blockExtent;
+
+		VkBufferImageCopy copy{};
+		copy.bufferOffset = staging.offset;
+		copy.bufferRowLength = 0;
+		copy.bufferImageHeight = 0;
+		copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		copy.imageSubresource.mipLevel = region.level;
+		copy.imageSubresource.baseArrayLayer = baseLayer + region.layer;
+		copy.imageSubresource.layerCount = 1;
+		copy.imageOffset = { 0, static_cast<int32_t>(y), 0 };
+		copy.imageExtent = { region.width, std::min(rows * blockExtent, region.height - y), 1 };
+
+		vkCmdCopyBufferToImage(commandBuffer, staging.buffer, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+	}
+}
+
+void Engine::Graphics::UploadBatch::uploadStagedImage(ImageResource* image, const StagingAllocation& staging, const ImageRegion& region, uint32_t baseLayer)
+{
+	uploadStagedImage(image, staging, std::vector<ImageRegion>{ region }, baseLayer);
+}
+
+void Engine::Graphics::UploadBatch::uploadStagedImage(ImageResource* image, const StagingAllocation& staging, const std::vector<ImageRegion>& regions, uint32_t baseLayer)
+{
+	if (std::find(stagingRegions.begin(), stagingRegions.end(), staging.id) == stagingRegions.end())
+		stagingRegions.push_back(staging.id);
+
+	std::vector<VkBufferImageCopy> copies(regions.size());
+	for (size_t i = 0; i < regions.size(); i++) {
+		const ImageRegion& region = regions[i];
+		VkBufferImageCopy& copy = copies[i];
+
+		copy.bufferOffset = staging.offset + region.offset;
+		copy.bufferRowLength = 0;
+		copy.bufferImageHeight = 0;
+		copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		copy.imageSubresource.mipLevel = region.level;
+		copy.imageSubresource.baseArrayLayer = baseLayer + region.layer;
+		copy.imageSubresource.layerCount = 1;
+		copy.imageOffset = { 0, 0, 0 };
+		copy.imageExtent = { region.width, region.height, 1 };
+	}
+
+	if (!copies.empty())
+		vkCmdCopyBufferToImage(commandBuffer, staging.buffer, image->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copies.size()), copies.data());
+}
+
+void Engine::Graphics::UploadBatch::transitionImageLayout(ImageResource* image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount)
+{
+	Engine::Graphics::CommandBuffer::recordTransitionImageLayout(commandBuffer, image, format, oldLayout, newLayout, mipLevels, layerCount);
+}
+
+void Engine::Graphics::UploadBatch::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount)
+{
+	Engine::Graphics::CommandBuffer::recordCopyBufferToImage(commandBuffer, buffer, image, width, height, layerCount);
+}
+
+void Engine::Graphics::UploadBatch::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+{
+	Engine::Graphics::CommandBuffer::recordCopyBuffer(commandBuffer, srcBuffer, dstBuffer, size);
+}
+
+void Engine::Graphics::UploadBatch::generateMipmaps(ImageResource* image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels, uint32_t layerCount)
+{
+	if (mipGenerator && mipLevels > 1 && mipGenerator->canRecord(image, imageFormat, layerCount)) {
+		mipDispatches.emplace_back();
+		mipGenerator->record(commandBuffer, image, imageFormat, texWidth, texHeight, mipLevels, layerCount, mipDispatches.back());
+		return;
+	}
+
+	Engine::Graphics::Sampler::recordMipmaps(commandBuffer, physicalDevice, image, imageFormat, texWidth, texHeight, mipLevels, layerCount);
+}
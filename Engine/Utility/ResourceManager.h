@@ -2,12 +2,31 @@
 #define RESOURCEMANAGER
 
 #include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
 #include "vulkanPointers.hpp"
 #include <unordered_map>
 #include <cstdint>
+#include <array>
+#include <mutex>
+#include <deque>
+#include <functional>
+#include <atomic>
+
+struct ResourceHandle {
+	uint32_t slot = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool valid() const { return slot != UINT32_MAX; }
+	bool operator==(const ResourceHandle&) const = default;
+};
 
 class Resource {
 public:
+	ResourceHandle handle{};
+	VmaAllocator allocator = VK_NULL_HANDLE;
+	VmaAllocation allocation = VK_NULL_HANDLE;
+	VmaPool pool = VK_NULL_HANDLE;
+
 	virtual void destroy(VkDevice device) = 0;
 	virtual ~Resource() = default;
 	virtual std::string log() = 0;
@@ -29,67 +48,45 @@ public:
 		VkResult result = vkCreateBuffer(device, &bufferInfo, nullptr, &buffer);
 		if (result != VK_SUCCESS) return result;
 
-		VkMemoryRequirements memReq;
-		vkGetBufferMemoryRequirements(device, buffer, &memReq);
-
-		VkMemoryAllocateFlagsInfo memFlagsInfo{};
-		memFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-
-		if ((usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) != 0) {
-			memFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
-		}
+		VmaAllocationCreateInfo allocCreateInfo{};
+		allocCreateInfo.requiredFlags = properties;
+		allocCreateInfo.pool = pool;
 
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memReq.size;
-		allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, properties, physicalDevice);
-		
-		if (memFlagsInfo.flags != 0) {
-			allocInfo.pNext = &memFlagsInfo;
-		}
-		else {
-			allocInfo.pNext = nullptr;
+		if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+			allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
 		}
 
-		result = vkAllocateMemory(device, &allocInfo, nullptr, &memory);
+		VmaAllocationInfo allocInfo{};
+		result = vmaAllocateMemoryForBuffer(allocator, buffer, &allocCreateInfo, &allocation, &allocInfo);
 		if (result != VK_SUCCESS) return result;
 
-		result = vkBindBufferMemory(device, buffer, memory, 0);
+		result = vmaBindBufferMemory(allocator, allocation, buffer);
 		if (result != VK_SUCCESS) return result;
 
-		if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
-			result = vkMapMemory(device, memory, 0, size, 0, &mapped);
-			if (result != VK_SUCCESS) return result;
-			/*
-			if (data != nullptr) {
-				memcpy(mapped, data, size);
-
-				if ((properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0) {
-					VkMappedMemoryRange range{};
-					range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-					range.memory = memory;
-					range.offset = 0;
-					range.size = size;
-					vkFlushMappedMemoryRanges(device, 1, &range);
-				}
-			}*/
+		memory = allocInfo.deviceMemory;
+		mapped = allocInfo.pMappedData;
+
+		if (mapped && data != nullptr) {
+			memcpy(mapped, data, size);
+
+			if ((properties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0) {
+				vmaFlushAllocation(allocator, allocation, 0, size);
+			}
 		}
 
 		return VK_SUCCESS;
 	}
 
 	void destroy(VkDevice device) override {
-		if (mapped) {
-			vkUnmapMemory(device, memory);
-			mapped = nullptr;
-		}
 		if (buffer) {
 			vkDestroyBuffer(device, buffer, nullptr);
 			buffer = VK_NULL_HANDLE;
 		}
-		if (memory) {
-			vkFreeMemory(device, memory, nullptr);
+		if (allocation) {
+			vmaFreeMemory(allocator, allocation);
+			allocation = VK_NULL_HANDLE;
 			memory = VK_NULL_HANDLE;
+			mapped = nullptr;
 		}
 	}
 
@@ -103,20 +100,6 @@ public:
 
 		return ss.str();
 	}
-
-private:
-	static uint32_t findMemoryType(uint32_t type, VkMemoryPropertyFlags prop, VkPhysicalDevice physicalDevice) {
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-		for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-			if ((type & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & prop) == prop) {
-				return i;
-			}
-		}
-
-		throw std::runtime_error("failed to find suitable memory type");
-	}
 };
 
 class AccelerationStructureResource : public Resource {
@@ -135,24 +118,19 @@ public:
 		VkResult result = vkCreateBuffer(device, &bufferInfo, nullptr, &buffer);
 		if (result != VK_SUCCESS) return result;
 
-		VkMemoryRequirements memoryRequirements{};
-		vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
-
-		VkMemoryAllocateFlagsInfo memoryAllocateFlagsInfo{};
-		memoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-		memoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT_KHR;
+		VmaAllocationCreateInfo allocCreateInfo{};
+		allocCreateInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		allocCreateInfo.pool = pool;
 
-		VkMemoryAllocateInfo memoryAllocateInfo{};
-		memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		memoryAllocateInfo.pNext = &memoryAllocateFlagsInfo;
-		memoryAllocateInfo.allocationSize = memoryRequirements.size;
-		memoryAllocateInfo.memoryTypeIndex = findMemoryType(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, physicalDevice);
-		result = vkAllocateMemory(device, &memoryAllocateInfo, nullptr, &memory);
+		VmaAllocationInfo allocInfo{};
+		result = vmaAllocateMemoryForBuffer(allocator, buffer, &allocCreateInfo, &allocation, &allocInfo);
 		if (result != VK_SUCCESS) return result;
 
-		result = vkBindBufferMemory(device, buffer, memory, 0);
+		result = vmaBindBufferMemory(allocator, allocation, buffer);
 		if (result != VK_SUCCESS) return result;
 
+		memory = allocInfo.deviceMemory;
+
 		VkAccelerationStructureCreateInfoKHR accelerationStructureCreateInfo{};
 		accelerationStructureCreateInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR;
 		accelerationStructureCreateInfo.buffer = buffer;
@@ -178,8 +156,9 @@ public:
 			vkDestroyBuffer(device, buffer, nullptr);
 			buffer = VK_NULL_HANDLE;
 		}
-		if (memory != VK_NULL_HANDLE) {
-			vkFreeMemory(device, memory, nullptr);
+		if (allocation != VK_NULL_HANDLE) {
+			vmaFreeMemory(allocator, allocation);
+			allocation = VK_NULL_HANDLE;
 			memory = VK_NULL_HANDLE;
 			address = 0;
 		}
@@ -196,29 +175,19 @@ public:
 
 		return ss.str();
 	}
-
-private:
-	static uint32_t findMemoryType(uint32_t type, VkMemoryPropertyFlags prop, VkPhysicalDevice physicalDevice) {
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-		for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-			if ((type & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & prop) == prop) {
-				return i;
-			}
-		}
-
-		throw std::runtime_error("failed to find suitable memory type");
-	}
 };
 
 class ImageResource : public Resource {
 public:
+	static constexpr VkDeviceSize DEDICATED_ALLOCATION_THRESHOLD = 32ull * 1024 * 1024;
+
 	VkImage image = VK_NULL_HANDLE;
 	VkImageView view = VK_NULL_HANDLE;
 	VkSampler sampler = VK_NULL_HANDLE;
 	VkDeviceMemory memory = VK_NULL_HANDLE;
 	VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	VkImageUsageFlags usage = 0;
+	VkImageCreateFlags flags = 0;
 
 	VkResult initialize(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits samples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, uint32_t arrayLayers, VkImageCreateFlags flags, VkImageAspectFlags aspectFlags, bool isCube, bool useSampler) {
 		VkImageCreateInfo imageInfo{};
@@ -240,18 +209,30 @@ public:
 		VkResult result = vkCreateImage(device, &imageInfo, nullptr, &image);
 		if (result != VK_SUCCESS) return result;
 
+		this->usage = usage;
+		this->flags = flags;
+
 		VkMemoryRequirements memReq;
 		vkGetImageMemoryRequirements(device, image, &memReq);
 
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memReq.size;
-		allocInfo.memoryTypeIndex = findMemoryType(memReq.memoryTypeBits, properties, physicalDevice);
+		VmaAllocationCreateInfo allocCreateInfo{};
+		allocCreateInfo.requiredFlags = properties;
+		allocCreateInfo.pool = pool;
 
-		result = vkAllocateMemory(device, &allocInfo, nullptr, &memory);
+		// render targets are recreated on resize and large textures would pin whole blocks
+		constexpr VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		if ((usage & attachmentUsage) != 0 || memReq.size >= DEDICATED_ALLOCATION_THRESHOLD) {
+			allocCreateInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+		}
+
+		VmaAllocationInfo allocInfo{};
+		result = vmaAllocateMemoryForImage(allocator, image, &allocCreateInfo, &allocation, &allocInfo);
+		if (result != VK_SUCCESS) return result;
+
+		result = vmaBindImageMemory(allocator, allocation, image);
 		if (result != VK_SUCCESS) return result;
 
-		vkBindImageMemory(device, image, memory, 0);
+		memory = allocInfo.deviceMemory;
 
 		if (aspectFlags != VK_IMAGE_ASPECT_NONE) {
 			VkImageViewCreateInfo viewInfo{};
@@ -263,6 +244,14 @@ public:
 			viewInfo.subresourceRange.levelCount = mipLevels;
 			viewInfo.subresourceRange.baseArrayLayer = 0;
 
+			// extended-usage images only support storage through views of a compatible format
+			VkImageViewUsageCreateInfo viewUsage{};
+			if (flags & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT) {
+				viewUsage.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+				viewUsage.usage = usage & ~VK_IMAGE_USAGE_STORAGE_BIT;
+				viewInfo.pNext = &viewUsage;
+			}
+
 			if (isCube) {
 				viewInfo.subresourceRange.layerCount = 6;
 				viewInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
@@ -328,8 +317,9 @@ public:
 			vkDestroyImage(device, image, nullptr);
 			image = VK_NULL_HANDLE;
 		}
-		if (memory) {
-			vkFreeMemory(device, memory, nullptr);
+		if (allocation) {
+			vmaFreeMemory(allocator, allocation);
+			allocation = VK_NULL_HANDLE;
 			memory = VK_NULL_HANDLE;
 		}
 	}
@@ -350,20 +340,6 @@ public:
 
 		return ss.str();
 	}
-
-private:
-	static uint32_t findMemoryType(uint32_t type, VkMemoryPropertyFlags prop, VkPhysicalDevice physicalDevice) {
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-		for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-			if ((type & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & prop) == prop) {
-				return i;
-			}
-		}
-
-		throw std::runtime_error("failed to find suitable memory type");
-	}
 };
 
 class SwapchainResource : public Resource {
@@ -449,70 +425,329 @@ public:
 class ResourceManager
 {
 public:
-	explicit ResourceManager(VkDevice device) : m_device(device) {};
+	ResourceManager(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device) : m_device(device) {
+		VmaAllocatorCreateInfo allocatorInfo{};
+		allocatorInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+		allocatorInfo.vulkanApiVersion = VK_API_VERSION_1_3;
+		allocatorInfo.instance = instance;
+		allocatorInfo.physicalDevice = physicalDevice;
+		allocatorInfo.device = device;
+
+		if (vmaCreateAllocator(&allocatorInfo, &m_allocator) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create memory allocator");
+		}
+
+		createAccelerationStructurePool(physicalDevice);
+	}
 
 	template<typename ResourceType, typename... Args>
 	ResourceType* create(Args&&... args) {
-		ResourceType* res = createResource<ResourceType>();
+		auto res = std::make_unique<ResourceType>();
+		prepare(res.get());
+
 		if (res->initialize(std::forward<Args>(args)...) != VK_SUCCESS) {
+			res->destroy(m_device);
 			throw std::runtime_error("failed to initialize resource");
 		}
 
-		return res;
+		return insert(std::move(res));
 	}
 
 	template<typename ResourceType, typename... Args>
 	ResourceType* createResource(Args&&... args) {
 		auto res = std::make_unique<ResourceType>(std::forward<Args>(args)...);
-		ResourceType* ptr = res.get();
-		m_resources.push_back(std::move(res));
-		return ptr;
+		prepare(res.get());
+
+		return insert(std::move(res));
 	}
 
+	template<typename ResourceType>
+	ResourceType* get(ResourceHandle handle) {
+		if (!handle.valid()) return nullptr;
+
+		Shard& shard = m_shards[handle.slot & SHARD_MASK];
+		uint32_t index = handle.slot >> SHARD_BITS;
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (index >= shard.slots.size() || shard.slots[index].generation != handle.generation) {
+			return nullptr;
+		}
+
+		return static_cast<ResourceType*>(shard.slots[index].resource.get());
+	}
+
+	// the resource is unregistered right away but its Vulkan objects are only freed by
+	// collect() once every frame submitted before this call has finished on the GPU
 	void destroy(Resource* resource) {
-		const auto it = std::ranges::find_if(m_resources, [resource](const std::unique_ptr<Resource>& res) {
-			return res.get() == resource;
-			});
+		if (std::unique_ptr<Resource> owned = unregister(resource)) {
+			retire(std::move(owned), nullptr);
+		}
+	}
 
-		if (it != m_resources.end()) {
-			(*it)->destroy(m_device);
-			m_resources.erase(it);
+	void destroy(ResourceHandle handle) {
+		if (std::unique_ptr<Resource> owned = unregister(handle)) {
+			retire(std::move(owned), nullptr);
 		}
 	}
 
-	void cleanup() {
-		if (!m_resources.empty()) {
-			for (const auto& resource : m_resources) {
-				resource->destroy(m_device);
+	// only for callers that have already waited for the device to go idle
+	void destroyImmediate(Resource* resource) {
+		if (std::unique_ptr<Resource> owned = unregister(resource)) {
+			owned->destroy(m_device);
+		}
+	}
+
+	void defer(std::function<void(VkDevice)> callback) {
+		retire(nullptr, std::move(callback));
+	}
+
+	uint64_t getFrame() const { return m_frame.load(); }
+
+	// returns the number of the frame that was just submitted
+	uint64_t submitFrame() { return m_frame.fetch_add(1); }
+
+	void collect(uint64_t completedFrame) {
+		std::vector<Retired> ready;
+		{
+			std::lock_guard<std::mutex> lock(m_retiredMutex);
+			while (!m_retired.empty() && m_retired.front().frame <= completedFrame) {
+				ready.push_back(std::move(m_retired.front()));
+				m_retired.pop_front();
 			}
-			m_resources.clear();
+		}
+
+		for (auto& retired : ready) {
+			destroyRetired(retired);
 		}
 	}
 
-    [[nodiscard]] std::string log() const {
-		std::ostringstream ss;
+	void flush() {
+		std::deque<Retired> pending;
+		{
+			std::lock_guard<std::mutex> lock(m_retiredMutex);
+			pending.swap(m_retired);
+		}
 
-		ss << "-------------Resource Log-------------\n";
-		ss << "Total Resources: " << m_resources.size() << "\n";
+		for (auto& retired : pending) {
+			destroyRetired(retired);
+		}
+	}
 
-		for (size_t i = 0; i < m_resources.size(); ++i) {
-			ss << "Resource [" << i << "]: ";
+	void cleanup() {
+		flush();
+
+		for (auto& shard : m_shards) {
+			std::lock_guard<std::mutex> lock(shard.mutex);
 
-			try {
-				ss << m_resources[i]->log();
+			for (uint32_t i = 0; i < shard.slots.size(); i++) {
+				if (shard.slots[i].resource) {
+					release(shard, i)->destroy(m_device);
+				}
 			}
-			catch (...) {
-				auto& res = *m_resources[i];
-				ss << "Unknown Resource Type: " << typeid(res).name() << "\n";
+			shard.lookup.clear();
+		}
+	}
+
+	void destroyAllocator() {
+		if (m_accelerationStructurePool != VK_NULL_HANDLE) {
+			vmaDestroyPool(m_allocator, m_accelerationStructurePool);
+			m_accelerationStructurePool = VK_NULL_HANDLE;
+		}
+		if (m_allocator != VK_NULL_HANDLE) {
+			vmaDestroyAllocator(m_allocator);
+			m_allocator = VK_NULL_HANDLE;
+		}
+	}
+
+	VmaAllocator getAllocator() const { return m_allocator; }
+	VmaPool getAccelerationStructurePool() const { return m_accelerationStructurePool; }
+
+	[[nodiscard]] std::string log() {
+		std::ostringstream entries;
+		size_t count = 0;
+
+		for (auto& shard : m_shards) {
+			std::lock_guard<std::mutex> lock(shard.mutex);
+
+			for (const auto& slot : shard.slots) {
+				if (!slot.resource) continue;
+
+				entries << "Resource [" << count++ << "]: ";
+
+				try {
+					entries << slot.resource->log();
+				}
+				catch (...) {
+					auto& res = *slot.resource;
+					entries << "Unknown Resource Type: " << typeid(res).name() << "\n";
+				}
 			}
 		}
 
+		std::ostringstream ss;
+		ss << "-------------Resource Log-------------\n";
+		ss << "Total Resources: " << count << "\n";
+		ss << entries.str();
+
 		return ss.str();
-    }
+	}
 
 private:
-	std::vector<std::unique_ptr<Resource>> m_resources;
+	static constexpr uint32_t SHARD_BITS = 4;
+	static constexpr uint32_t SHARD_COUNT = 1u << SHARD_BITS;
+	static constexpr uint32_t SHARD_MASK = SHARD_COUNT - 1;
+
+	struct Slot {
+		std::unique_ptr<Resource> resource;
+		uint32_t generation = 1;
+	};
+
+	struct Retired {
+		uint64_t frame;
+		std::unique_ptr<Resource> resource;
+		std::function<void(VkDevice)> callback;
+	};
+
+	// resources are sharded by address so loader threads rarely contend, and the
+	// per-shard lookup keeps destroy(Resource*) O(1) and a no-op for unknown pointers
+	struct Shard {
+		std::mutex mutex;
+		std::vector<Slot> slots;
+		std::vector<uint32_t> freeList;
+		std::unordered_map<Resource*, uint32_t> lookup;
+	};
+
+	static uint32_t shardFor(const Resource* resource) {
+		uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(resource));
+		return static_cast<uint32_t>((key * 0x9E3779B97F4A7C15ull) >> (64 - SHARD_BITS));
+	}
+
+	template<typename ResourceType>
+	void prepare(ResourceType* resource) {
+		resource->allocator = m_allocator;
+
+		if constexpr (std::is_same_v<ResourceType, AccelerationStructureResource>) {
+			resource->pool = m_accelerationStructurePool;
+		}
+	}
+
+	template<typename ResourceType>
+	ResourceType* insert(std::unique_ptr<ResourceType> resource) {
+		ResourceType* ptr = resource.get();
+		uint32_t shardIndex = shardFor(ptr);
+		Shard& shard = m_shards[shardIndex];
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		uint32_t index;
+		if (!shard.freeList.empty()) {
+			index = shard.freeList.back();
+			shard.freeList.pop_back();
+		}
+		else {
+			index = static_cast<uint32_t>(shard.slots.size());
+			shard.slots.emplace_back();
+		}
+
+		Slot& slot = shard.slots[index];
+		slot.resource = std::move(resource);
+		ptr->handle = { (index << SHARD_BITS) | shardIndex, slot.generation };
+		shard.lookup.emplace(ptr, index);
+
+		return ptr;
+	}
+
+	std::unique_ptr<Resource> unregister(Resource* resource) {
+		if (resource == nullptr) return nullptr;
+
+		Shard& shard = m_shards[shardFor(resource)];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		const auto it = shard.lookup.find(resource);
+		if (it == shard.lookup.end()) return nullptr;
+
+		std::unique_ptr<Resource> owned = release(shard, it->second);
+		shard.lookup.erase(it);
+
+		return owned;
+	}
+
+	std::unique_ptr<Resource> unregister(ResourceHandle handle) {
+		if (!handle.valid()) return nullptr;
+
+		Shard& shard = m_shards[handle.slot & SHARD_MASK];
+		uint32_t index = handle.slot >> SHARD_BITS;
+
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (index >= shard.slots.size() || shard.slots[index].generation != handle.generation || !shard.slots[index].resource) {
+			return nullptr;
+		}
+
+		std::unique_ptr<Resource> owned = release(shard, index);
+		shard.lookup.erase(owned.get());
+
+		return owned;
+	}
+
+	void retire(std::unique_ptr<Resource> resource, std::function<void(VkDevice)> callback) {
+		std::lock_guard<std::mutex> lock(m_retiredMutex);
+		m_retired.push_back({ m_frame.load(), std::move(resource), std::move(callback) });
+	}
+
+	void destroyRetired(Retired& retired) {
+		if (retired.resource) retired.resource->destroy(m_device);
+		if (retired.callback) retired.callback(m_device);
+	}
+
+	static std::unique_ptr<Resource> release(Shard& shard, uint32_t index) {
+		Slot& slot = shard.slots[index];
+		std::unique_ptr<Resource> resource = std::move(slot.resource);
+
+		slot.generation++;
+		shard.freeList.push_back(index);
+
+		return resource;
+	}
+
+	void createAccelerationStructurePool(VkPhysicalDevice physicalDevice) {
+		VkPhysicalDeviceAccelerationStructurePropertiesKHR accelProps{};
+		accelProps.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
+
+		VkPhysicalDeviceProperties2 properties2{};
+		properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties2.pNext = &accelProps;
+		vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+		VkBufferCreateInfo sampleBufferInfo{};
+		sampleBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		sampleBufferInfo.size = 1024;
+		sampleBufferInfo.usage = VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+		VmaAllocationCreateInfo sampleAllocInfo{};
+		sampleAllocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+		uint32_t memoryTypeIndex = 0;
+		if (vmaFindMemoryTypeIndexForBufferInfo(m_allocator, &sampleBufferInfo, &sampleAllocInfo, &memoryTypeIndex) != VK_SUCCESS) {
+			throw std::runtime_error("failed to find memory type for acceleration structures");
+		}
+
+		// acceleration structures need 256 byte offsets, scratch buffers the device's scratch alignment
+		VmaPoolCreateInfo poolInfo{};
+		poolInfo.memoryTypeIndex = memoryTypeIndex;
+		poolInfo.minAllocationAlignment = std::max<VkDeviceSize>(256, accelProps.minAccelerationStructureScratchOffsetAlignment);
+
+		if (vmaCreatePool(m_allocator, &poolInfo, &m_accelerationStructurePool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create acceleration structure memory pool");
+		}
+	}
+
+	std::array<Shard, SHARD_COUNT> m_shards;
+	std::deque<Retired> m_retired;
+	std::mutex m_retiredMutex;
+	std::atomic<uint64_t> m_frame{ 1 };
 	VkDevice m_device;
+	VmaAllocator m_allocator = VK_NULL_HANDLE;
+	VmaPool m_accelerationStructurePool = VK_NULL_HANDLE;
 };
 
 #endif
@@ -0,0 +1,291 @@
+#include "assetPack.h"
+#include "lz4Block.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+std::unique_ptr<Engine::Utility::AssetPack> assetPack;
+
+namespace {
+	uint64_t alignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+bool Engine::Utility::AssetPack::open(const std::string& path)
+{
+	close();
+
+	// the pack itself always comes from the filesystem
+	if (!file.openFile(path) || file.size() < sizeof(FileHeader))
+		return false;
+
+	FileHeader header{};
+	memcpy(&header, file.data(), sizeof(header));
+
+	const uint64_t fileSize = file.size();
+	const bool valid = header.magic == MAGIC && header.version == VERSION &&
+		header.tocOffset <= fileSize && header.entryCount <= (fileSize - header.tocOffset) / sizeof(Entry) &&
+		header.namesOffset <= fileSize && header.namesSize <= fileSize - header.namesOffset;
+
+	if (!valid) {
+		close();
+		return false;
+	}
+
+	entries.resize(static_cast<size_t>(header.entryCount));
+	memcpy(entries.data(), file.data() + header.tocOffset, entries.size() * sizeof(Entry));
+
+	// everything is checked once here so lookups and reads can trust the table
+	for (size_t i = 0; i < entries.size(); i++) {
+		Entry& entry = entries[i];
+
+		const bool compressionKnown = entry.compression == static_cast<uint32_t>(Compression::None) || entry.compression == static_cast<uint32_t>(Compression::LZ4);
+		const bool inBounds = entry.nameOffset <= header.namesSize && entry.nameLength <= header.namesSize - entry.nameOffset &&
+			entry.offset <= fileSize && entry.storedSize <= fileSize - entry.offset &&
+			(entry.compression != static_cast<uint32_t>(Compression::None) || entry.storedSize == entry.size) &&
+			entry.size / 256 <= entry.storedSize; // beyond what LZ4 can expand to, so the decode buffer stays sane
+
+		if (!compressionKnown || !inBounds) {
+			close();
+			return false;
+		}
+
+		entry.nameOffset += header.namesOffset;
+
+		if (i > 0 && !(name(entries[i - 1]) < name(entry))) {
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void Engine::Utility::AssetPack::close()
+{
+	entries.clear();
+	file.close();
+}
+
+const Engine::Utility::AssetPack::Entry* Engine::Utility::AssetPack::find(const std::string& path) const
+{
+	if (entries.empty())
+		return nullptr;
+
+	const std::string key = normalize(path);
+	auto it = std::lower_bound(entries.begin(), entries.end(), std::string_view(key), [this](const Entry& entry, std::string_view key) {
+		return name(entry) < key;
+	});
+
+	return it != entries.end() && name(*it) == key ? &*it : nullptr;
+}
+
+std::string_view Engine::Utility::AssetPack::stored(const Entry& entry) const
+{
+	return { file.data() + entry.offset, static_cast<size_t>(entry.storedSize) };
+}
+
+bool Engine::Utility::AssetPack::extract(const Entry& entry, char* destination) const
+{
+	std::string_view bytes = stored(entry);
+
+	switch (static_cast<Compression>(entry.compression)) {
+		case Compression::None:
+			memcpy(destination, bytes.data(), bytes.size());
+			return true;
+		case Compression::LZ4:
+			return Lz4::decompress(bytes.data(), bytes.size(), destination, static_cast<size_t>(entry.size));
+		default:
+			return false;
+	}
+}
+
+std::vector<std::string> Engine::Utility::AssetPack::list(const std::string& directory, const std::vector<std::string>& extensions) const
+{
+	std::vector<std::string> paths;
+	if (entries.empty())
+		return paths;
+
+	std::string prefix = normalize(directory);
+	if (prefix == ".")
+		prefix.clear();
+	if (!prefix.empty())
+		prefix += "/";
+
+	std::string base = directory;
+	if (!base.empty() && base.back() != '/' && base.back() != '\\')
+		base += "/";
+
+	// entries under a directory are one contiguous run of the sorted table
+	auto it = std::lower_bound(entries.begin(), entries.end(), std::string_view(prefix), [this](const Entry& entry, std::string_view key) {
+		return name(entry) < key;
+	});
+
+	for (; it != entries.end(); ++it) {
+		std::string_view entryName = name(*it);
+		if (entryName.substr(0, prefix.size()) != prefix)
+			break;
+
+		std::string extension = std::filesystem::path(entryName).extension().string();
+		if (std::find(extensions.begin(), extensions.end(), extension) != extensions.end())
+			paths.push_back(base + std::string(entryName.substr(prefix.size())));
+	}
+
+	return paths;
+}
+
+Engine::Utility::AssetPack::WriteStats Engine::Utility::AssetPack::write(const std::string& path, std::vector<Source> sources, bool compress)
+{
+	for (auto& source : sources)
+		source.name = normalize(source.name);
+
+	std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.name < b.name; });
+	sources.erase(std::unique(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.name == b.name; }), sources.end());
+
+	// files the engine would not open anyway (MappedFile refuses empty ones) are left out
+	std::erase_if(sources, [](const Source& source) {
+		std::error_code ec;
+		return std::filesystem::file_size(source.path, ec) == 0 || ec;
+	});
+
+	WriteStats stats;
+	stats.entries = sources.size();
+
+	std::vector<Entry> toc(sources.size());
+	std::string names;
+	for (size_t i = 0; i < sources.size(); i++) {
+		toc[i].nameOffset = names.size();
+		toc[i].nameLength = static_cast<uint32_t>(sources[i].name.size());
+		names += sources[i].name;
+	}
+
+	FileHeader header{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.entryCount = toc.size();
+	header.tocOffset = sizeof(FileHeader);
+	header.namesOffset = header.tocOffset + toc.size() * sizeof(Entry);
+	header.namesSize = names.size();
+
+	std::filesystem::path target(path);
+	std::filesystem::path temp = target;
+	temp += ".tmp";
+
+	std::error_code ec;
+	if (target.has_parent_path())
+		std::filesystem::create_directories(target.parent_path(), ec);
+
+	std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+		throw std::runtime_error("failed to open " + temp.string() + " for writing");
+
+	// the table is rewritten once every blob has its offset
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(Entry)));
+	out.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+	struct Pending {
+		MappedFile source;
+		std::vector<char> compressed;
+	};
+
+	const char padding[BLOB_ALIGNMENT] = {};
+	uint64_t offset = header.namesOffset + header.namesSize;
+
+	// a batch of files is read and compressed in parallel, then written in order
+	const size_t batchSize = threadPool ? (threadPool->size() + 1) * 4 : 1;
+	for (size_t first = 0; first < sources.size(); first += batchSize) {
+		const size_t count = std::min(batchSize, sources.size() - first);
+		std::vector<Pending> batch(count);
+
+		auto prepare = [&](size_t i) {
+			Pending& pending = batch[i];
+			if (!pending.source.openFile(sources[first + i].path))
+				throw std::runtime_error("failed to read " + sources[first + i].path);
+
+			if (!compress)
+				return;
+
+			pending.compressed.resize(Lz4::compressBound(pending.source.size()));
+			size_t size = Lz4::compress(pending.source.data(), pending.source.size(), pending.compressed.data(), pending.compressed.size());
+
+			if (size == 0 || size > pending.source.size() - pending.source.size() / 8)
+				size = 0;
+			pending.compressed.resize(size);
+		};
+
+		if (threadPool)
+			threadPool->parallelFor(count, prepare);
+		else
+			for (size_t i = 0; i < count; i++)
+				prepare(i);
+
+		for (size_t i = 0; i < count; i++) {
+			const Pending& pending = batch[i];
+			Entry& entry = toc[first + i];
+
+			const uint64_t aligned = alignUp(offset, BLOB_ALIGNMENT);
+			out.write(padding, static_cast<std::streamsize>(aligned - offset));
+			offset = aligned;
+
+			const bool packed = !pending.compressed.empty();
+			entry.compression = static_cast<uint32_t>(packed ? Compression::LZ4 : Compression::None);
+			entry.offset = offset;
+			entry.size = pending.source.size();
+			entry.storedSize = packed ? pending.compressed.size() : pending.source.size();
+
+			out.write(packed ? pending.compressed.data() : pending.source.data(), static_cast<std::streamsize>(entry.storedSize));
+			offset += entry.storedSize;
+
+			stats.compressed += packed ? 1 : 0;
+			stats.inputBytes += entry.size;
+		}
+	}
+
+	out.seekp(static_cast<std::streamoff>(header.tocOffset));
+	out.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(Entry)));
+
+	if (!out.good()) {
+		out.close();
+		std::filesystem::remove(temp, ec);
+		throw std::runtime_error("failed to write " + temp.string());
+	}
+	out.close();
+
+	std::filesystem::rename(temp, target, ec);
+	if (ec) {
+		std::filesystem::remove(temp, ec);
+		throw std::runtime_error("failed to replace " + path);
+	}
+
+	stats.outputBytes = offset;
+	return stats;
+}
+
+std::string Engine::Utility::AssetPack::normalize(const std::string& path)
+{
+	std::filesystem::path normal = std::filesystem::path(path).lexically_normal();
+
+	if (normal.is_absolute()) {
+		std::error_code ec;
+		std::filesystem::path relative = normal.lexically_relative(std::filesystem::current_path(ec));
+		if (!ec && !relative.empty())
+			normal = relative;
+	}
+
+	std::string name = normal.generic_string();
+	while (name.size() > 1 && name.back() == '/')
+		name.pop_back();
+
+	return name;
+}
+
+std::string_view Engine::Utility::AssetPack::name(const Entry& entry) const
+{
+	return { file.data() + entry.nameOffset, entry.nameLength };
+}
@@ -0,0 +1,98 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include "mappedFile.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Engine::Utility {
+	// Read-only .fpak archive of asset files, memory-mapped whole. A table of contents sorted
+	// by path is followed by the path strings and the file contents, each blob aligned to 64
+	// bytes and either stored as is or LZ4 compressed. Paths are relative to the app's
+	// working directory, the same way assets are named everywhere else, so a lookup is a
+	// binary search with no filesystem access.
+	//
+	// While a pack is open, MappedFile::open looks in it before the filesystem and
+	// getAllPathsFromPath adds the packed files that are not on disk. Stored entries are
+	// handed out as views into the pack's mapping and must not outlive it.
+	class AssetPack
+	{
+	public:
+		static constexpr const char* DEFAULT_PATH = "assets.fpak";
+
+		enum class Compression : uint32_t {
+			None = 0,
+			LZ4 = 1,
+		};
+
+		struct Entry {
+			uint64_t nameOffset;
+			uint32_t nameLength;
+			uint32_t compression;
+			uint64_t offset;
+			uint64_t storedSize;
+			uint64_t size;
+		};
+
+		// a file to pack, named as the engine will ask for it
+		struct Source {
+			std::string name;
+			std::string path;
+		};
+
+		struct WriteStats {
+			size_t entries = 0;
+			size_t compressed = 0;
+			uint64_t inputBytes = 0;
+			uint64_t outputBytes = 0;
+		};
+
+		bool open(const std::string& path);
+		void close();
+		bool isOpen() const { return file.isOpen(); }
+		size_t size() const { return entries.size(); }
+
+		// the entry path resolves to, or nullptr if the pack does not hold it
+		const Entry* find(const std::string& path) const;
+		// entry bytes as stored in the pack
+		std::string_view stored(const Entry& entry) const;
+		// decodes entry into destination, which must hold entry.size bytes
+		bool extract(const Entry& entry, char* destination) const;
+
+		// packed files under directory (recursively) with one of the extensions, named with
+		// directory as given, like getAllPathsFromPath names them
+		std::vector<std::string> list(const std::string& directory, const std::vector<std::string>& extensions) const;
+
+		// writes sources into a new pack at path. Entries are compressed on the thread pool
+		// and kept compressed only when that saves at least an eighth of their size.
+		static WriteStats write(const std::string& path, std::vector<Source> sources, bool compress);
+
+		// the name a path is looked up under: lexically normal, '/'-separated and relative
+		// to the working directory
+		static std::string normalize(const std::string& path);
+
+	private:
+		static constexpr uint32_t MAGIC = 0x4b415046; // "FPAK"
+		static constexpr uint32_t VERSION = 1;
+		static constexpr size_t BLOB_ALIGNMENT = 64;
+
+		struct FileHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint64_t entryCount;
+			uint64_t tocOffset;
+			uint64_t namesOffset;
+			uint64_t namesSize;
+		};
+
+		MappedFile file;
+		std::vector<Entry> entries;
+
+		std::string_view name(const Entry& entry) const;
+	};
+}
+
+extern std::unique_ptr<Engine::Utility::AssetPack> assetPack;
+
+#endif
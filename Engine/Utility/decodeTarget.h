@@ -0,0 +1,20 @@
+#ifndef DECODETARGET_H
+#define DECODETARGET_H
+
+#include <cstddef>
+
+namespace Engine::Utility {
+	// stb_image allocates through these hooks (see stbUsage.cpp). While a target is armed on the
+	// calling thread, the first allocation of exactly its size is placed in it, so the decoder
+	// writes its output straight into caller memory such as a staging buffer. The pointer stb
+	// returns still has to be compared with the target: formats that decode through an
+	// intermediate buffer of the same size may hand back a separate heap block instead.
+	void armDecodeTarget(void* memory, size_t size);
+	void disarmDecodeTarget();
+
+	void* decodeMalloc(size_t size);
+	void* decodeRealloc(void* memory, size_t size);
+	void decodeFree(void* memory);
+}
+
+#endif
@@ -0,0 +1,497 @@
+#ifndef FLATHASHMAP_H
+#define FLATHASHMAP_H
+
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FORTIFY_FLATMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Engine::Utility {
+	// final avalanche from MurmurHash3; turns weak hashes (identity hashes of ints and enums)
+	// into something usable for both the H1 probe position and the H2 control tag
+	inline uint64_t mixHash(uint64_t h) {
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	// 64-bit hash of a byte range, eight bytes per step; used to fingerprint asset files
+	inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		uint64_t h = seed ^ (static_cast<uint64_t>(size) * 0x9e3779b97f4a7c15ull);
+
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8) {
+			uint64_t word;
+			std::memcpy(&word, bytes + i, sizeof(word));
+			h ^= word * 0x87c37b91114253d5ull;
+			h = ((h << 31) | (h >> 33)) * 0x4cf5ad432745937full;
+		}
+
+		uint64_t tail = 0;
+		if (i < size)
+			std::memcpy(&tail, bytes + i, size - i);
+		h ^= tail * 0x87c37b91114253d5ull;
+
+		return mixHash(h);
+	}
+
+	namespace Detail {
+		inline uint32_t countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return static_cast<uint32_t>(index);
+#else
+			return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+		}
+
+		// One probe group of 16 control bytes. Bit i of a returned mask refers to slot i of the group.
+		struct Group {
+			static constexpr size_t WIDTH = 16;
+
+#ifdef FORTIFY_FLATMAP_SSE2
+			__m128i ctrl;
+
+			explicit Group(const int8_t* pos) : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+			uint32_t match(int8_t tag) const {
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl)));
+			}
+
+			// empty and deleted bytes are the only negative control values
+			uint32_t matchEmptyOrDeleted() const {
+				return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+			}
+
+			uint32_t matchEmpty(int8_t empty) const {
+				return match(empty);
+			}
+#else
+			int8_t ctrl[WIDTH];
+
+			explicit Group(const int8_t* pos) { std::memcpy(ctrl, pos, WIDTH); }
+
+			uint32_t match(int8_t tag) const {
+				uint32_t mask = 0;
+				for (size_t i = 0; i < WIDTH; i++)
+					mask |= static_cast<uint32_t>(ctrl[i] == tag) << i;
+				return mask;
+			}
+
+			uint32_t matchEmptyOrDeleted() const {
+				uint32_t mask = 0;
+				for (size_t i = 0; i < WIDTH; i++)
+					mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+				return mask;
+			}
+
+			uint32_t matchEmpty(int8_t empty) const {
+				return match(empty);
+			}
+#endif
+		};
+	}
+
+	// Open-addressing hash map in the SwissTable layout: a flat slot array plus one control byte
+	// per slot holding 7 bits of the hash, probed 16 slots at a time. No per-insert allocation,
+	// and lookups touch one cache line of control bytes before any key is compared.
+	// Iteration order is unspecified and changes on rehash. References are invalidated by
+	// inserts that grow the table.
+	template<typename Key, typename Value, typename Hash = std::hash<Key>, typename Equal = std::equal_to<Key>>
+	class FlatHashMap
+	{
+	public:
+		using key_type = Key;
+		using mapped_type = Value;
+		using value_type = std::pair<const Key, Value>;
+		using size_type = size_t;
+
+	private:
+		static constexpr int8_t EMPTY = -128;
+		static constexpr int8_t DELETED = -2;
+		static constexpr size_t GROUP_WIDTH = Detail::Group::WIDTH;
+
+		int8_t* ctrl = nullptr;
+		value_type* slots = nullptr;
+		size_t capacity = 0;
+		size_t count = 0;
+		size_t growthLeft = 0;
+		[[no_unique_address]] Hash hasher;
+		[[no_unique_address]] Equal equal;
+
+		template<bool Const>
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = FlatHashMap::value_type;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+			using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+		private:
+			friend class FlatHashMap;
+			template<bool> friend class Iterator;
+
+			using Ctrl = std::conditional_t<Const, const int8_t*, int8_t*>;
+
+			Ctrl ctrl = nullptr;
+			pointer slot = nullptr;
+			Ctrl end = nullptr;
+
+			Iterator(Ctrl ctrl, pointer slot, Ctrl end) : ctrl(ctrl), slot(slot), end(end) { skipEmpty(); }
+
+			void skipEmpty() {
+				while (ctrl != end && *ctrl < 0) {
+					++ctrl;
+					++slot;
+				}
+			}
+
+		public:
+			Iterator() = default;
+			operator Iterator<true>() const { return Iterator<true>(ctrl, slot, end); }
+
+			reference operator*() const { return *slot; }
+			pointer operator->() const { return slot; }
+
+			Iterator& operator++() {
+				++ctrl;
+				++slot;
+				skipEmpty();
+				return *this;
+			}
+
+			Iterator operator++(int) {
+				Iterator copy = *this;
+				++*this;
+				return copy;
+			}
+
+			bool operator==(const Iterator& other) const { return ctrl == other.ctrl; }
+		};
+
+	public:
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+
+		FlatHashMap() = default;
+
+		FlatHashMap(std::initializer_list<value_type> values) {
+			reserve(values.size());
+			for (const auto& value : values)
+				try_emplace(value.first, value.second);
+		}
+
+		FlatHashMap(const FlatHashMap& other) : hasher(other.hasher), equal(other.equal) {
+			reserve(other.size());
+			for (const auto& value : other)
+				try_emplace(value.first, value.second);
+		}
+
+		FlatHashMap(FlatHashMap&& other) noexcept
+			: ctrl(std::exchange(other.ctrl, nullptr)), slots(std::exchange(other.slots, nullptr)),
+			capacity(std::exchange(other.capacity, 0)), count(std::exchange(other.count, 0)),
+			growthLeft(std::exchange(other.growthLeft, 0)), hasher(std::move(other.hasher)), equal(std::move(other.equal)) {}
+
+		FlatHashMap& operator=(const FlatHashMap& other) {
+			if (this != &other) {
+				FlatHashMap copy(other);
+				swap(copy);
+			}
+			return *this;
+		}
+
+		FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+			if (this != &other) {
+				release();
+				FlatHashMap moved(std::move(other));
+				swap(moved);
+			}
+			return *this;
+		}
+
+		~FlatHashMap() { release(); }
+
+		void swap(FlatHashMap& other) noexcept {
+			std::swap(ctrl, other.ctrl);
+			std::swap(slots, other.slots);
+			std::swap(capacity, other.capacity);
+			std::swap(count, other.count);
+			std::swap(growthLeft, other.growthLeft);
+			std::swap(hasher, other.hasher);
+			std::swap(equal, other.equal);
+		}
+
+		iterator begin() { return iterator(ctrl, slots, ctrl + capacity); }
+		iterator end() { return iterator(ctrl + capacity, slots + capacity, ctrl + capacity); }
+		const_iterator begin() const { return const_iterator(ctrl, slots, ctrl + capacity); }
+		const_iterator end() const { return const_iterator(ctrl + capacity, slots + capacity, ctrl + capacity); }
+
+		size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+
+		void clear() {
+			if (capacity == 0)
+				return;
+
+			destroySlots();
+			resetCtrl();
+			count = 0;
+		}
+
+		void reserve(size_t n) {
+			size_t needed = capacityFor(n);
+			if (needed > capacity)
+				rehash(needed);
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+			uint64_t hash = hashOf(key);
+
+			if (size_t index = find(key, hash); index != capacity)
+				return { iteratorAt(index), false };
+
+			size_t index = prepareInsert(hash);
+			new (slots + index) value_type(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+			return { iteratorAt(index), true };
+		}
+
+		std::pair<iterator, bool> insert(const value_type& value) {
+			return try_emplace(value.first, value.second);
+		}
+
+		Value& operator[](const Key& key) {
+			return try_emplace(key).first->second;
+		}
+
+		Value& at(const Key& key) {
+			size_t index = find(key, hashOf(key));
+			if (index == capacity)
+				throw std::out_of_range("FlatHashMap::at");
+			return slots[index].second;
+		}
+
+		const Value& at(const Key& key) const {
+			size_t index = find(key, hashOf(key));
+			if (index == capacity)
+				throw std::out_of_range("FlatHashMap::at");
+			return slots[index].second;
+		}
+
+		iterator find(const Key& key) {
+			size_t index = find(key, hashOf(key));
+			return index == capacity ? end() : iteratorAt(index);
+		}
+
+		const_iterator find(const Key& key) const {
+			size_t index = find(key, hashOf(key));
+			return index == capacity ? end() : const_iterator(ctrl + index, slots + index, ctrl + capacity);
+		}
+
+		bool contains(const Key& key) const { return find(key, hashOf(key)) != capacity; }
+
+		size_t erase(const Key& key) {
+			size_t index = find(key, hashOf(key));
+			if (index == capacity)
+				return 0;
+
+			eraseAt(index);
+			return 1;
+		}
+
+	private:
+		uint64_t hashOf(const Key& key) const { return mixHash(static_cast<uint64_t>(hasher(key))); }
+		static size_t h1(uint64_t hash) { return static_cast<size_t>(hash >> 7); }
+		static int8_t h2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+
+		static size_t capacityFor(size_t n) {
+			// keep the load factor at or below 7/8
+			size_t needed = n + (n + 6) / 7;
+			size_t capacity = GROUP_WIDTH;
+			while (capacity < needed)
+				capacity <<= 1;
+			return capacity;
+		}
+
+		iterator iteratorAt(size_t index) { return iterator(ctrl + index, slots + index, ctrl + capacity); }
+
+		// the first GROUP_WIDTH control bytes are mirrored past the end so a group load never wraps
+		void setCtrl(size_t index, int8_t value) {
+			ctrl[index] = value;
+			if (index < GROUP_WIDTH)
+				ctrl[capacity + index] = value;
+		}
+
+		void resetCtrl() {
+			std::memset(ctrl, EMPTY, capacity + GROUP_WIDTH);
+			growthLeft = capacity - capacity / 8;
+		}
+
+		size_t find(const Key& key, uint64_t hash) const {
+			if (capacity == 0)
+				return capacity;
+
+			size_t mask = capacity - 1;
+			size_t pos = h1(hash) & mask;
+			int8_t tag = h2(hash);
+
+			for (size_t probe = 0; probe <= capacity; probe += GROUP_WIDTH) {
+				Detail::Group group(ctrl + pos);
+
+				for (uint32_t match = group.match(tag); match; match &= match - 1) {
+					size_t index = (pos + Detail::countTrailingZeros(match)) & mask;
+					if (equal(slots[index].first, key))
+						return index;
+				}
+
+				if (group.matchEmpty(EMPTY))
+					return capacity;
+
+				pos = (pos + probe + GROUP_WIDTH) & mask;
+			}
+
+			return capacity;
+		}
+
+		size_t findInsertSlot(uint64_t hash) const {
+			size_t mask = capacity - 1;
+			size_t pos = h1(hash) & mask;
+
+			for (size_t probe = 0;; probe += GROUP_WIDTH) {
+				Detail::Group group(ctrl + pos);
+
+				if (uint32_t free = group.matchEmptyOrDeleted())
+					return (pos + Detail::countTrailingZeros(free)) & mask;
+
+				pos = (pos + probe + GROUP_WIDTH) & mask;
+			}
+		}
+
+		size_t prepareInsert(uint64_t hash) {
+			if (growthLeft == 0)
+				rehash(capacity == 0 ? GROUP_WIDTH : (count * 2 >= capacity ? capacity * 2 : capacity));
+
+			size_t index = findInsertSlot(hash);
+			if (ctrl[index] == EMPTY)
+				growthLeft--;
+
+			setCtrl(index, h2(hash));
+			count++;
+			return index;
+		}
+
+		void eraseAt(size_t index) {
+			slots[index].~value_type();
+			count--;
+
+			// a slot can go straight back to empty only if no probe sequence could have
+			// passed over it, i.e. the group around it was never full
+			size_t mask = capacity - 1;
+			size_t before = (index - GROUP_WIDTH) & mask;
+			uint32_t emptyAfter = Detail::Group(ctrl + index).matchEmpty(EMPTY);
+			uint32_t emptyBefore = Detail::Group(ctrl + before).matchEmpty(EMPTY);
+
+			bool wasNeverFull = emptyBefore && emptyAfter &&
+				(countLeadingFull(emptyBefore) + countTrailingFull(emptyAfter)) < GROUP_WIDTH;
+
+			if (wasNeverFull) {
+				setCtrl(index, EMPTY);
+				growthLeft++;
+			}
+			else {
+				setCtrl(index, DELETED);
+			}
+		}
+
+		// occupied slots directly after the start of the group, given its empty mask
+		static uint32_t countTrailingFull(uint32_t emptyMask) {
+			return Detail::countTrailingZeros(emptyMask);
+		}
+
+		// occupied slots at the end of the group, given its empty mask
+		static uint32_t countLeadingFull(uint32_t emptyMask) {
+			uint32_t n = 0;
+			for (uint32_t bit = 1u << (GROUP_WIDTH - 1); bit && !(emptyMask & bit); bit >>= 1)
+				n++;
+			return n;
+		}
+
+		void rehash(size_t newCapacity) {
+			int8_t* oldCtrl = ctrl;
+			value_type* oldSlots = slots;
+			size_t oldCapacity = capacity;
+
+			capacity = newCapacity;
+			ctrl = static_cast<int8_t*>(::operator new(capacity + GROUP_WIDTH));
+			slots = static_cast<value_type*>(::operator new(sizeof(value_type) * capacity, std::align_val_t(alignof(value_type))));
+			resetCtrl();
+
+			for (size_t i = 0; i < oldCapacity; i++) {
+				if (oldCtrl[i] < 0)
+					continue;
+
+				uint64_t hash = hashOf(oldSlots[i].first);
+				size_t index = findInsertSlot(hash);
+				setCtrl(index, h2(hash));
+				growthLeft--;
+
+				new (slots + index) value_type(std::move(oldSlots[i]));
+				oldSlots[i].~value_type();
+			}
+
+			if (oldCapacity) {
+				::operator delete(oldCtrl);
+				::operator delete(oldSlots, std::align_val_t(alignof(value_type)));
+			}
+		}
+
+		void destroySlots() {
+			if constexpr (!std::is_trivially_destructible_v<value_type>) {
+				for (size_t i = 0; i < capacity; i++) {
+					if (ctrl[i] >= 0)
+						slots[i].~value_type();
+				}
+			}
+		}
+
+		void release() {
+			if (capacity == 0)
+				return;
+
+			destroySlots();
+			::operator delete(ctrl);
+			::operator delete(slots, std::align_val_t(alignof(value_type)));
+
+			ctrl = nullptr;
+			slots = nullptr;
+			capacity = 0;
+			count = 0;
+			growthLeft = 0;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,207 @@
+#include "lz4Block.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+	constexpr size_t MIN_MATCH = 4;
+	// the spec keeps the last 5 bytes literal and starts no match in the last 12
+	constexpr size_t LAST_LITERALS = 5;
+	constexpr size_t MATCH_START_LIMIT = 12;
+	constexpr size_t MAX_OFFSET = 65535;
+	constexpr int HASH_BITS = 12;
+
+	uint32_t read32(const uint8_t* p)
+	{
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	uint32_t hash(uint32_t sequence)
+	{
+		return (sequence * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	// length nibble overflow: 255s followed by the remainder
+	bool writeLength(uint8_t*& op, const uint8_t* end, size_t length)
+	{
+		for (; length >= 255; length -= 255) {
+			if (op >= end)
+				return false;
+			*op++ = 255;
+		}
+
+		if (op >= end)
+			return false;
+		*op++ = static_cast<uint8_t>(length);
+		return true;
+	}
+
+	bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length)
+	{
+		uint8_t byte;
+		do {
+			if (ip >= end)
+				return false;
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	// one sequence: token, literals and, unless this is the last sequence, the match
+	bool writeSequence(uint8_t*& op, const uint8_t* end, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength)
+	{
+		if (op >= end)
+			return false;
+
+		uint8_t* token = op++;
+		*token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+		if (literalLength >= 15 && !writeLength(op, end, literalLength - 15))
+			return false;
+
+		if (literalLength > static_cast<size_t>(end - op))
+			return false;
+		if (literalLength > 0)
+			memcpy(op, literals, literalLength);
+		op += literalLength;
+
+		if (matchLength == 0)
+			return true;
+
+		if (end - op < 2)
+			return false;
+		*op++ = static_cast<uint8_t>(offset);
+		*op++ = static_cast<uint8_t>(offset >> 8);
+
+		const size_t extra = matchLength - MIN_MATCH;
+		*token |= static_cast<uint8_t>(std::min<size_t>(extra, 15));
+		return extra < 15 || writeLength(op, end, extra - 15);
+	}
+}
+
+size_t Engine::Utility::Lz4::compressBound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+size_t Engine::Utility::Lz4::compress(const char* source, size_t size, char* destination, size_t capacity)
+{
+	// table positions are 32-bit
+	if (size > std::numeric_limits<uint32_t>::max())
+		return 0;
+
+	const uint8_t* base = reinterpret_cast<const uint8_t*>(source);
+	const uint8_t* end = base + size;
+	const uint8_t* anchor = base;
+
+	uint8_t* op = reinterpret_cast<uint8_t*>(destination);
+	const uint8_t* opEnd = op + capacity;
+
+	if (size > MATCH_START_LIMIT) {
+		const uint8_t* matchStartLimit = end - MATCH_START_LIMIT;
+		const uint8_t* matchEndLimit = end - LAST_LITERALS;
+		std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+
+		const uint8_t* ip = base + 1;
+		while (ip <= matchStartLimit) {
+			const uint32_t sequence = read32(ip);
+			uint32_t& slot = table[hash(sequence)];
+			const uint8_t* match = base + slot;
+			slot = static_cast<uint32_t>(ip - base);
+
+			if (match >= ip || static_cast<size_t>(ip - match) > MAX_OFFSET || read32(match) != sequence) {
+				ip++;
+				continue;
+			}
+
+			while (ip > anchor && match > base && ip[-1] == match[-1]) {
+				ip--;
+				match--;
+			}
+
+			size_t length = MIN_MATCH;
+			while (ip + length < matchEndLimit && ip[length] == match[length])
+				length++;
+
+			if (!writeSequence(op, opEnd, anchor, static_cast<size_t>(ip - anchor), static_cast<size_t>(ip - match), length))
+				return 0;
+
+			ip += length;
+			anchor = ip;
+
+			// seed the table inside the match so the next one can start right after it
+			if (ip - 2 > base)
+				table[hash(read32(ip - 2))] = static_cast<uint32_t>(ip - 2 - base);
+		}
+	}
+
+	if (!writeSequence(op, opEnd, anchor, static_cast<size_t>(end - anchor), 0, 0))
+		return 0;
+
+	return static_cast<size_t>(op - reinterpret_cast<uint8_t*>(destination));
+}
+
+bool Engine::Utility::Lz4::decompress(const char* source, size_t sourceSize, char* destination, size_t size)
+{
+	const uint8_t* ip = reinterpret_cast<const uint8_t*>(source);
+	const uint8_t* ipEnd = ip + sourceSize;
+	uint8_t* op = reinterpret_cast<uint8_t*>(destination);
+	uint8_t* const opBegin = op;
+	uint8_t* const opEnd = op + size;
+
+	while (true) {
+		if (ip >= ipEnd)
+			return false;
+
+		const uint8_t token = *ip++;
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !readLength(ip, ipEnd, literalLength))
+			return false;
+
+		if (literalLength > static_cast<size_t>(ipEnd - ip) || literalLength > static_cast<size_t>(opEnd - op))
+			return false;
+
+		if (literalLength > 0)
+			memcpy(op, ip, literalLength);
+		op += literalLength;
+		ip += literalLength;
+
+		// the last sequence has literals only
+		if (ip == ipEnd)
+			return op == opEnd;
+
+		if (ipEnd - ip < 2)
+			return false;
+
+		const size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+		ip += 2;
+
+		if (offset == 0 || offset > static_cast<size_t>(op - opBegin))
+			return false;
+
+		size_t matchLength = token & 15;
+		if (matchLength == 15 && !readLength(ip, ipEnd, matchLength))
+			return false;
+		matchLength += MIN_MATCH;
+
+		if (matchLength > static_cast<size_t>(opEnd - op))
+			return false;
+
+		// matches may overlap their own output, which repeats the pattern
+		const uint8_t* match = op - offset;
+		if (offset >= matchLength) {
+			memcpy(op, match, matchLength);
+			op += matchLength;
+		}
+		else {
+			for (size_t i = 0; i < matchLength; i++)
+				*op++ = match[i];
+		}
+	}
+}
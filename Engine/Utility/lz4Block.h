@@ -0,0 +1,21 @@
+#ifndef LZ4BLOCK_H
+#define LZ4BLOCK_H
+
+#include <cstddef>
+
+// Raw LZ4 blocks (the block format of the LZ4 spec, no frame around it), used for asset
+// pack entries. The encoder is a single greedy pass with a 4K-entry hash table: roughly
+// the speed of LZ4's fast mode, a little less compression. The decoder checks every
+// length and offset against both buffers, so a damaged block fails instead of overrunning.
+namespace Engine::Utility::Lz4 {
+	// largest compressed size of size bytes
+	size_t compressBound(size_t size);
+
+	// returns the compressed size, or 0 if the result would not fit in capacity
+	size_t compress(const char* source, size_t size, char* destination, size_t capacity);
+
+	// true only if the block decodes to exactly size bytes
+	bool decompress(const char* source, size_t sourceSize, char* destination, size_t size);
+}
+
+#endif
@@ -0,0 +1,181 @@
+#include "mappedFile.h"
+#include "assetPack.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Engine::Utility::MappedFile::~MappedFile()
+{
+	close();
+}
+
+Engine::Utility::MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+Engine::Utility::MappedFile& Engine::Utility::MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other) {
+		close();
+
+		mapped = std::exchange(other.mapped, nullptr);
+		length = std::exchange(other.length, 0);
+		borrowed = std::exchange(other.borrowed, false);
+		decoded = std::move(other.decoded);
+#ifdef _WIN32
+		fileHandle = std::exchange(other.fileHandle, nullptr);
+		mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#else
+		fd = std::exchange(other.fd, -1);
+#endif
+	}
+
+	return *this;
+}
+
+bool Engine::Utility::MappedFile::open(const std::string& path)
+{
+	close();
+
+	const AssetPack::Entry* entry = assetPack ? assetPack->find(path) : nullptr;
+	if (!entry)
+		return openFile(path);
+
+	if (entry->size == 0)
+		return false;
+
+	if (static_cast<AssetPack::Compression>(entry->compression) == AssetPack::Compression::None) {
+		std::string_view bytes = assetPack->stored(*entry);
+		mapped = bytes.data();
+		length = bytes.size();
+		borrowed = true;
+		return true;
+	}
+
+	std::unique_ptr<char[]> buffer(new char[static_cast<size_t>(entry->size)]);
+	if (!assetPack->extract(*entry, buffer.get()))
+		return false;
+
+	decoded = std::move(buffer);
+	mapped = decoded.get();
+	length = static_cast<size_t>(entry->size);
+	borrowed = true;
+	return true;
+}
+
+void Engine::Utility::MappedFile::close()
+{
+	if (!borrowed)
+		unmap();
+
+	mapped = nullptr;
+	length = 0;
+	borrowed = false;
+	decoded.reset();
+}
+
+#ifdef _WIN32
+bool Engine::Utility::MappedFile::openFile(const std::string& path)
+{
+	close();
+
+	std::wstring widePath = std::filesystem::path(path).wstring();
+	HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mappingHandle = mapping;
+	mapped = static_cast<const char*>(view);
+	length = static_cast<size_t>(fileSize.QuadPart);
+
+	return true;
+}
+
+void Engine::Utility::MappedFile::unmap()
+{
+	if (mapped)
+		UnmapViewOfFile(mapped);
+	if (mappingHandle)
+		CloseHandle(static_cast<HANDLE>(mappingHandle));
+	if (fileHandle)
+		CloseHandle(static_cast<HANDLE>(fileHandle));
+
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+}
+#else
+bool Engine::Utility::MappedFile::openFile(const std::string& path)
+{
+	close();
+
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat info{};
+	if (fstat(file, &info) != 0 || info.st_size <= 0) {
+		::close(file);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	if (view == MAP_FAILED) {
+		::close(file);
+		return false;
+	}
+
+	madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+	fd = file;
+	mapped = static_cast<const char*>(view);
+	length = static_cast<size_t>(info.st_size);
+
+	return true;
+}
+
+void Engine::Utility::MappedFile::unmap()
+{
+	if (mapped)
+		munmap(const_cast<char*>(mapped), length);
+	if (fd >= 0)
+		::close(fd);
+
+	fd = -1;
+}
+#endif
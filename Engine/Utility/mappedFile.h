@@ -0,0 +1,56 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Engine::Utility {
+	// Read-only memory mapping of a whole file. Pages are faulted in on first touch, so large
+	// assets can be parsed in parallel straight from the page cache without a copy. Files in
+	// the open asset pack are served from it instead: stored entries as a view into the
+	// pack's mapping, compressed ones decoded into memory the file owns.
+	class MappedFile
+	{
+	private:
+		const char* mapped = nullptr;
+		size_t length = 0;
+		// set when mapped points into the asset pack or at decoded; neither is unmapped
+		bool borrowed = false;
+		std::unique_ptr<char[]> decoded;
+
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#else
+		int fd = -1;
+#endif
+
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string& path) { open(path); }
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		// returns false if the file is missing, empty or cannot be mapped
+		bool open(const std::string& path);
+		// like open, but never looks in the asset pack
+		bool openFile(const std::string& path);
+		void close();
+
+		bool isOpen() const { return mapped != nullptr; }
+		const char* data() const { return mapped; }
+		size_t size() const { return length; }
+		std::string_view view() const { return { mapped, length }; }
+
+	private:
+		void unmap();
+	};
+}
+
+#endif
@@ -0,0 +1,63 @@
+#include "decodeTarget.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#define STBI_MALLOC(size) Engine::Utility::decodeMalloc(size)
+#define STBI_REALLOC(memory, size) Engine::Utility::decodeRealloc(memory, size)
+#define STBI_FREE(memory) Engine::Utility::decodeFree(memory)
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace {
+	struct DecodeTarget {
+		void* memory = nullptr;
+		size_t size = 0;
+		bool used = false;
+	};
+
+	thread_local DecodeTarget decodeTarget;
+}
+
+void Engine::Utility::armDecodeTarget(void* memory, size_t size)
+{
+	decodeTarget = { memory, size, false };
+}
+
+void Engine::Utility::disarmDecodeTarget()
+{
+	decodeTarget = {};
+}
+
+void* Engine::Utility::decodeMalloc(size_t size)
+{
+	if (decodeTarget.memory && !decodeTarget.used && size == decodeTarget.size) {
+		decodeTarget.used = true;
+		return decodeTarget.memory;
+	}
+
+	return malloc(size);
+}
+
+void* Engine::Utility::decodeRealloc(void* memory, size_t size)
+{
+	// the target cannot grow; move its contents to the heap instead
+	if (memory && memory == decodeTarget.memory) {
+		void* moved = malloc(size);
+		if (moved)
+			memcpy(moved, memory, std::min(size, decodeTarget.size));
+		return moved;
+	}
+
+	return realloc(memory, size);
+}
+
+void Engine::Utility::decodeFree(void* memory)
+{
+	// the target belongs to the caller; stb dropping it as an intermediate is not a free
+	if (memory && memory == decodeTarget.memory)
+		return;
+
+	free(memory);
+}
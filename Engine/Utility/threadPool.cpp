@@ -0,0 +1,51 @@
+#include "threadPool.h"
+
+std::unique_ptr<Engine::Utility::ThreadPool> threadPool;
+
+Engine::Utility::ThreadPool::ThreadPool(size_t threadCount)
+{
+	workers.reserve(threadCount);
+
+	for (size_t i = 0; i < threadCount; i++)
+		workers.emplace_back(&ThreadPool::worker, this);
+}
+
+Engine::Utility::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	condition.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+size_t Engine::Utility::ThreadPool::defaultThreadCount()
+{
+	// leave one core for the render thread
+	unsigned int cores = std::thread::hardware_concurrency();
+	return cores > 1 ? cores - 1 : 1;
+}
+
+void Engine::Utility::ThreadPool::worker()
+{
+	for (;;) {
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+			if (tasks.empty())
+				return;
+
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,130 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <exception>
+
+namespace Engine::Utility {
+	// Fixed set of worker threads for CPU-side jobs (pipeline compilation, asset decoding).
+	// Jobs must not touch the render loop's command buffers or ImGui state.
+	class ThreadPool
+	{
+	private:
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> tasks;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool stopping = false;
+
+	public:
+		explicit ThreadPool(size_t threadCount = defaultThreadCount());
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		template<typename F>
+		auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+			using Result = std::invoke_result_t<std::decay_t<F>>;
+
+			auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+			std::future<Result> future = packaged->get_future();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				tasks.emplace_back([packaged]() { (*packaged)(); });
+			}
+
+			condition.notify_one();
+			return future;
+		}
+
+		// Runs body(chunk) for every chunk in [0, chunks) and returns once all have finished.
+		// The calling thread takes chunks too, so this is safe to call from inside a pool job.
+		template<typename F>
+		void parallelFor(size_t chunks, F&& body) {
+			if (chunks == 0)
+				return;
+
+			if (chunks == 1 || workers.empty()) {
+				for (size_t chunk = 0; chunk < chunks; chunk++)
+					body(chunk);
+				return;
+			}
+
+			struct State {
+				std::atomic<size_t> next{ 0 };
+				size_t finished = 0;
+				size_t count = 0;
+				std::exception_ptr error;
+				std::mutex mutex;
+				std::condition_variable done;
+				std::function<void(size_t)> body;
+			};
+
+			auto state = std::make_shared<State>();
+			state->count = chunks;
+			state->body = [&body](size_t chunk) { body(chunk); };
+
+			auto run = [](const std::shared_ptr<State>& state) {
+				for (size_t chunk = state->next++; chunk < state->count; chunk = state->next++) {
+					std::exception_ptr error;
+					try {
+						state->body(chunk);
+					}
+					catch (...) {
+						error = std::current_exception();
+					}
+
+					std::lock_guard<std::mutex> lock(state->mutex);
+					if (error && !state->error)
+						state->error = error;
+					if (++state->finished == state->count)
+						state->done.notify_all();
+				}
+			};
+
+			size_t helpers = std::min(workers.size(), chunks - 1);
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				for (size_t i = 0; i < helpers; i++)
+					tasks.emplace_back([state, run]() { run(state); });
+			}
+			condition.notify_all();
+
+			run(state);
+
+			std::unique_lock<std::mutex> lock(state->mutex);
+			state->done.wait(lock, [&state]() { return state->finished == state->count; });
+
+			if (state->error)
+				std::rethrow_exception(state->error);
+		}
+
+		// splits count items into chunks of at least minChunkSize, a few per worker
+		size_t chunkCount(size_t count, size_t minChunkSize) const {
+			size_t maxChunks = std::max<size_t>(1, (workers.size() + 1) * 4);
+			return std::clamp<size_t>(count / std::max<size_t>(1, minChunkSize), 1, maxChunks);
+		}
+
+		size_t size() const { return workers.size(); }
+
+		static size_t defaultThreadCount();
+
+	private:
+		void worker();
+	};
+}
+
+extern std::unique_ptr<Engine::Utility::ThreadPool> threadPool;
+
+#endif
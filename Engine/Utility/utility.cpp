@@ -1,4 +1,6 @@
 #include "utility.h"
+#include "textureCache.h"
+#include "assetPack.h"
 
 std::unique_ptr<ResourceManager> resources;
 Console g_console;
@@ -63,25 +65,30 @@ bool Engine::Utility::hasStencilComponent(VkFormat format)
 
 std::vector<std::string> Engine::Utility::getAllPathsFromPath(const std::string& path, std::string ext)
 {
-	std::vector<std::string> paths;
-
-	for (const auto& dir_entry : std::filesystem::recursive_directory_iterator(path)) {
-		if (dir_entry.path().extension() == ext) {
-			paths.push_back(dir_entry.path().string());
-		}
-	}
-
-	return paths;
+	return getAllPathsFromPath(path, std::vector<std::string>{ ext });
 }
 
 std::vector<std::string> Engine::Utility::getAllPathsFromPath(const std::string& path, std::vector<std::string> exts) {
 	std::vector<std::string> paths;
 
-	for(const auto& dir_entry : std::filesystem::recursive_directory_iterator(path)) {
-		for(std::string ext : exts) {
-			if(dir_entry.path().extension() == ext) {
+	// with a pack open the directory may exist only inside it
+	if (!assetPack || std::filesystem::is_directory(path)) {
+		for (const auto& dir_entry : std::filesystem::recursive_directory_iterator(path)) {
+			if (std::find(exts.begin(), exts.end(), dir_entry.path().extension().string()) != exts.end())
 				paths.push_back(dir_entry.path().string());
-			}
+		}
+	}
+
+	// packed files fill in what is not on disk, so files added after the pack was built are
+	// still listed, the same precedence the caches give loose files
+	if (assetPack) {
+		std::set<std::string> loose;
+		for (const auto& loosePath : paths)
+			loose.insert(std::filesystem::path(loosePath).lexically_normal().generic_string());
+
+		for (auto& packed : assetPack->list(path, exts)) {
+			if (!loose.contains(std::filesystem::path(packed).lexically_normal().generic_string()))
+				paths.push_back(std::move(packed));
 		}
 	}
 
@@ -126,8 +133,22 @@ void Engine::Utility::setDebugName(VkDevice device, uint64_t handle, VkObjectTyp
 
 void MeshObject::destroy(VkDevice device)
 {
-	vkDeviceWaitIdle(device);
-
 	resources->destroy(vertex);
 	resources->destroy(index);
 }
+
+void Textures::textureCleanup()
+{
+	for (auto* image : { &albedo, &normal, &roughness, &metalness, &specular, &height, &ambientOcclusion }) {
+		if (image->has_value()) Engine::Graphics::releaseTexture(image->value());
+		image->reset();
+	}
+}
+
+void MeshObject::textureCleanup()
+{
+	for (auto* image : { &albedo, &normal, &occlusionRoughnessMetalness, &specular, &height }) {
+		if (image->has_value()) Engine::Graphics::releaseTexture(image->value());
+		image->reset();
+	}
+}
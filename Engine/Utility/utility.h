@@ -36,6 +36,7 @@
 
 #include "device.h"
 #include "fortifyConsole.h"
+#include "flatHashMap.h"
 
 extern Console g_console;
 extern LogBuffer g_logBuffer;
@@ -91,10 +92,44 @@ struct Vertex {
 	}
 };
 
+namespace Engine::Utility {
+	// Hashes the eight attribute floats by bit pattern, folding -0.0 into 0.0 so vertices that
+	// compare equal always hash equal. Every input bit reaches every output bit, which the old
+	// xor-shift combination of glm's per-vector hashes did not.
+	inline uint64_t hashVertex(const Vertex& vertex) {
+		const float values[8] = {
+			vertex.pos.x, vertex.pos.y, vertex.pos.z,
+			vertex.normal.x, vertex.normal.y, vertex.normal.z,
+			vertex.texCoord.x, vertex.texCoord.y
+		};
+
+		uint64_t h = 0x9e3779b97f4a7c15ull;
+		for (int i = 0; i < 8; i += 2) {
+			uint32_t a, b;
+			std::memcpy(&a, &values[i], sizeof(a));
+			std::memcpy(&b, &values[i + 1], sizeof(b));
+
+			if (a == 0x80000000u) a = 0;
+			if (b == 0x80000000u) b = 0;
+
+			uint64_t word = (static_cast<uint64_t>(a) << 32) | b;
+			h ^= word * 0x87c37b91114253d5ull;
+			h = ((h << 31) | (h >> 33)) * 0x4cf5ad432745937full;
+		}
+
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	}
+}
+
 namespace std {
 	template<> struct hash<Vertex> {
 		size_t operator()(Vertex const& vertex) const {
-			return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.normal) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
+			return static_cast<size_t>(Engine::Utility::hashVertex(vertex));
 		}
 	};
 }
@@ -176,15 +211,8 @@ struct Textures {
 	std::optional<ImageResource*> height = std::nullopt;
 	std::optional<ImageResource*> ambientOcclusion = std::nullopt;
 
-	void textureCleanup() {
-		if (albedo.has_value()) resources->destroy(albedo.value());
-		if (normal.has_value()) resources->destroy(normal.value());
-		if (roughness.has_value()) resources->destroy(roughness.value());
-		if (metalness.has_value()) resources->destroy(metalness.value());
-		if (specular.has_value()) resources->destroy(specular.value());
-		if (height.has_value()) resources->destroy(height.value());
-		if (ambientOcclusion.has_value()) resources->destroy(ambientOcclusion.value());
-	}
+	// releases this object's references into the texture cache
+	void textureCleanup();
 
 	int getTextureCount() {
 		int count = 0;
@@ -218,11 +246,12 @@ struct MeshObject {
 	std::optional<ImageResource*> normal = std::nullopt;
 	std::string normalPath = "";
 
-	std::optional<ImageResource*> roughness = std::nullopt;
+	// ambient occlusion, roughness and metalness packed into R, G and B; the flags say
+	// which of the three had a source map
+	std::optional<ImageResource*> occlusionRoughnessMetalness = std::nullopt;
 	std::string roughnessPath = "";
-
-	std::optional<ImageResource*> metalness = std::nullopt;
 	std::string metalnessPath = "";
+	std::string ambientOcclusionPath = "";
 
 	std::optional<ImageResource*> specular = std::nullopt;
 	std::string specularPath = "";
@@ -230,29 +259,17 @@ struct MeshObject {
 	std::optional<ImageResource*> height = std::nullopt;
 	std::string heightPath = "";
 
-	std::optional<ImageResource*> ambientOcclusion = std::nullopt;
-	std::string ambientOcclusionPath = "";
-
-	void textureCleanup() {
-		if (albedo.has_value()) resources->destroy(albedo.value());
-		if (normal.has_value()) resources->destroy(normal.value());
-		if (roughness.has_value()) resources->destroy(roughness.value());
-		if (metalness.has_value()) resources->destroy(metalness.value());
-		if (specular.has_value()) resources->destroy(specular.value());
-		if (height.has_value()) resources->destroy(height.value());
-		if (ambientOcclusion.has_value()) resources->destroy(ambientOcclusion.value());
-	}
+	// releases this object's references into the texture cache
+	void textureCleanup();
 
 	int getTextureCount() {
 		int count = 0;
 
 		if (albedo.has_value()) count++;
 		if (normal.has_value()) count++;
-		if (roughness.has_value()) count++;
-		if (metalness.has_value()) count++;
+		if (occlusionRoughnessMetalness.has_value()) count++;
 		if (specular.has_value()) count++;
 		if (height.has_value()) count++;
-		if (ambientOcclusion.has_value()) count++;
 
 		return count;
 	}
@@ -269,8 +286,51 @@ enum class PBRTextureType {
 	Metalness = 4,
 	AmbientOcclusion = 5,
 	Specular = 6,
+	OcclusionRoughnessMetalness = 7,
+};
+
+// textures a PBR entity uploads, in the order Texture::textureResources holds them and the
+// shaders bind them (binding 1 onwards). The ORM texture is packed from the maps below.
+inline constexpr PBRTextureType PBR_UPLOAD_ORDER[] = {
+	PBRTextureType::Albedo,
+	PBRTextureType::Normal,
+	PBRTextureType::OcclusionRoughnessMetalness,
+	PBRTextureType::Specular,
 };
 
+inline constexpr uint32_t PBR_TEXTURE_BINDINGS = static_cast<uint32_t>(std::size(PBR_UPLOAD_ORDER));
+
+// source maps of the ORM texture in channel order, and what a missing one reads as
+inline constexpr PBRTextureType ORM_CHANNELS[] = {
+	PBRTextureType::AmbientOcclusion,
+	PBRTextureType::Roughness,
+	PBRTextureType::Metalness,
+};
+
+inline constexpr std::array<uint8_t, 3> ORM_DEFAULTS = { 255, 255, 0 };
+
+// what a slot samples when the material has no map for it: white albedo, a flat normal, the
+// ORM channel defaults and no specular
+inline std::array<uint8_t, 4> pbrDefaultTexel(PBRTextureType type) {
+	switch (type) {
+		case PBRTextureType::Albedo: return { 255, 255, 255, 255 };
+		case PBRTextureType::Normal: return { 128, 128, 255, 255 };
+		case PBRTextureType::OcclusionRoughnessMetalness: return { ORM_DEFAULTS[0], ORM_DEFAULTS[1], ORM_DEFAULTS[2], 255 };
+		default: return { 0, 0, 0, 255 };
+	}
+}
+
+// colour maps stay sRGB; data maps are linear and keep only the channels the shaders read
+// (normals store x and y, z is rebuilt)
+inline VkFormat pbrTextureFormat(PBRTextureType type) {
+	switch (type) {
+		case PBRTextureType::Albedo: return VK_FORMAT_R8G8B8A8_SRGB;
+		case PBRTextureType::Normal: return VK_FORMAT_R8G8_UNORM;
+		case PBRTextureType::OcclusionRoughnessMetalness: return VK_FORMAT_R8G8B8A8_UNORM;
+		default: return VK_FORMAT_R8_UNORM;
+	}
+}
+
 enum class EntityType {
 	Object,
 	Skybox,
@@ -301,10 +361,22 @@ namespace Engine::Settings {
 	inline uint32_t WIDTH = 1280;
 	inline uint32_t HEIGHT = 720;
 
-	constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+	// Per-frame resources are allocated for MAX_FRAMES_IN_FLIGHT; the depth actually used can be lowered at runtime.
+	constexpr int MAX_FRAMES_IN_FLIGHT = 3;
+	constexpr int DEFAULT_FRAMES_IN_FLIGHT = 2;
 
 	inline uint32_t currentFrame = 0;
 
+	// Textures are encoded to BC formats at load when the device can sample them. Colour maps
+	// use BC7; BC1 halves their size again but drops alpha.
+	enum class ColourCompression { BC7, BC1 };
+	inline bool compressTextures = true;
+	inline ColourCompression colourCompression = ColourCompression::BC7;
+
+	// Decoded textures are cooked with their full mip chain into cache/textures and loaded
+	// from there on later runs.
+	inline bool cookTextures = true;
+
 	inline const std::vector<const char*> validationLayers = {
 		"VK_LAYER_KHRONOS_validation"
 	};
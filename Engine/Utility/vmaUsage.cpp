@@ -0,0 +1,3 @@
+#define VMA_IMPLEMENTATION
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
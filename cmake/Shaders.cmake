@@ -15,6 +15,9 @@ function(fortify_compile_shaders TARGET)
         "${SHADER_SRC_DIR}/*.rint"
     )
 
+    # shared includes; glslang reports no dependencies, so every shader rebuilds when one changes
+    file(GLOB SHADER_INCLUDES "${SHADER_SRC_DIR}/*.glsl")
+
     set(SPIRV_FILES "")
 
     foreach(SHADER ${SHADERS})
@@ -28,7 +31,7 @@ function(fortify_compile_shaders TARGET)
                     -V ${SHADER}
                     -o ${SPIRV_OUT}
                     --target-env vulkan1.2
-            DEPENDS ${SHADER}
+            DEPENDS ${SHADER} ${SHADER_INCLUDES}
             COMMENT "Compiling shader ${SHADER_NAME} -> ${SPIRV_OUT}"
             VERBATIM
         )
@@ -5,36 +5,45 @@ echo Compiling shaders...
 
 if not exist "%PROJECT_DIR%spv" mkdir "%PROJECT_DIR%spv"
 
-del "%PROJECT_DIR%spv\frag.spv"
-del "%PROJECT_DIR%spv\vert.spv"
-del "%PROJECT_DIR%spv\textureMapFrag.spv"
-del "%PROJECT_DIR%spv\textureMapVert.spv"
-del "%PROJECT_DIR%spv\primitiveFrag.spv"
-del "%PROJECT_DIR%spv\primitiveVert.spv"
-del "%PROJECT_DIR%spv\lightFrag.spv"
-del "%PROJECT_DIR%spv\lightVert.spv"
-del "%PROJECT_DIR%spv\skyboxFrag.spv"
-del "%PROJECT_DIR%spv\skyboxVert.spv"
-del "%PROJECT_DIR%spv\raytraceRaygen.spv"
-del "%PROJECT_DIR%spv\raytraceMiss.spv"
-del "%PROJECT_DIR%spv\raytraceChit.spv"
-del "%PROJECT_DIR%spv\raytraceAhit.spv"
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%shader.vert" -o "%PROJECT_DIR%spv\vert.spv" || (echo failed to compile "shader.vert" && exit)
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%shader.frag" -o "%PROJECT_DIR%spv\frag.spv" || (echo failed to compile "shader.frag" && exit)
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%textureMapVert.vert" -o "%PROJECT_DIR%spv\textureMapVert.spv" || (echo failed to compile "textureMapVert.vert" && exit)
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%textureMapFrag.frag" -o "%PROJECT_DIR%spv\textureMapFrag.spv" || (echo failed to compile "textureMapFrag.frag" && exit)
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%primitive.vert" -o "%PROJECT_DIR%spv\primitiveVert.spv" || (echo failed to compile "primitive.vert" && exit)
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%primitive.frag" -o "%PROJECT_DIR%spv\primitiveFrag.spv" || (echo failed to compile "primitive.frag" && exit)
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%light.vert" -o "%PROJECT_DIR%spv\lightVert.spv" || (echo failed to compile "light.vert" && exit)
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%light.frag" -o "%PROJECT_DIR%spv\lightFrag.spv" || (echo failed to compile "light.frag" && exit)
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%skyboxVert.vert" -o "%PROJECT_DIR%spv\skyboxVert.spv" || (echo failed to compile "skyboxVert.vert" && exit)
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe "%PROJECT_DIR%skyboxFrag.frag" -o "%PROJECT_DIR%spv\skyboxFrag.spv" || (echo failed to compile "skyboxFrag.frag" && exit)
+del "%PROJECT_DIR%spv\shader.vert.spv"
+del "%PROJECT_DIR%spv\shader.frag.spv"
+del "%PROJECT_DIR%spv\textureMapVert.vert.spv"
+del "%PROJECT_DIR%spv\textureMapFrag.frag.spv"
+del "%PROJECT_DIR%spv\primitive.vert.spv"
+del "%PROJECT_DIR%spv\primitive.frag.spv"
+del "%PROJECT_DIR%spv\light.vert.spv"
+del "%PROJECT_DIR%spv\light.frag.spv"
+del "%PROJECT_DIR%spv\skyboxVert.vert.spv"
+del "%PROJECT_DIR%spv\skyboxFrag.frag.spv"
+del "%PROJECT_DIR%spv\clusterCull.comp.spv"
+del "%PROJECT_DIR%spv\mipGenRGBA.comp.spv"
+del "%PROJECT_DIR%spv\mipGenRG.comp.spv"
+del "%PROJECT_DIR%spv\mipGenR.comp.spv"
+del "%PROJECT_DIR%spv\raytrace.rgen.spv"
+del "%PROJECT_DIR%spv\raytrace.rmiss.spv"
+del "%PROJECT_DIR%spv\raytrace.rchit.spv"
+del "%PROJECT_DIR%spv\raytrace.rahit.spv"
+del "%PROJECT_DIR%spv\raytrace.rint.spv"
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%shader.vert" -o "%PROJECT_DIR%spv\shader.vert.spv" || (echo failed to compile "shader.vert" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%shader.frag" -o "%PROJECT_DIR%spv\shader.frag.spv" || (echo failed to compile "shader.frag" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%textureMapVert.vert" -o "%PROJECT_DIR%spv\textureMapVert.vert.spv" || (echo failed to compile "textureMapVert.vert" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%textureMapFrag.frag" -o "%PROJECT_DIR%spv\textureMapFrag.frag.spv" || (echo failed to compile "textureMapFrag.frag" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%primitive.vert" -o "%PROJECT_DIR%spv\primitive.vert.spv" || (echo failed to compile "primitive.vert" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%primitive.frag" -o "%PROJECT_DIR%spv\primitive.frag.spv" || (echo failed to compile "primitive.frag" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%light.vert" -o "%PROJECT_DIR%spv\light.vert.spv" || (echo failed to compile "light.vert" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%light.frag" -o "%PROJECT_DIR%spv\light.frag.spv" || (echo failed to compile "light.frag" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%skyboxVert.vert" -o "%PROJECT_DIR%spv\skyboxVert.vert.spv" || (echo failed to compile "skyboxVert.vert" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%skyboxFrag.frag" -o "%PROJECT_DIR%spv\skyboxFrag.frag.spv" || (echo failed to compile "skyboxFrag.frag" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%clusterCull.comp" -o "%PROJECT_DIR%spv\clusterCull.comp.spv" || (echo failed to compile "clusterCull.comp" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%mipGenRGBA.comp" -o "%PROJECT_DIR%spv\mipGenRGBA.comp.spv" || (echo failed to compile "mipGenRGBA.comp" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%mipGenRG.comp" -o "%PROJECT_DIR%spv\mipGenRG.comp.spv" || (echo failed to compile "mipGenRG.comp" && exit)
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%mipGenR.comp" -o "%PROJECT_DIR%spv\mipGenR.comp.spv" || (echo failed to compile "mipGenR.comp" && exit)
 
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.3 "%PROJECT_DIR%raytrace.rgen" -o "%PROJECT_DIR%spv\raytraceRaygen.spv" || (echo failed to compile "raytrace.rgen")
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.3 "%PROJECT_DIR%raytrace.rmiss" -o "%PROJECT_DIR%spv\raytraceMiss.spv" || (echo failed to compile "raytrace.rmiss")
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.3 "%PROJECT_DIR%raytrace.rchit" -o "%PROJECT_DIR%spv\raytraceChit.spv" || (echo failed to compile "raytrace.rchit")
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.3 "%PROJECT_DIR%raytrace.rahit" -o "%PROJECT_DIR%spv\raytraceAhit.spv" || (echo failed to compile "raytrace.rahit")
-C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.3 "%PROJECT_DIR%raytrace.rint" -o "%PROJECT_DIR%spv\raytraceInt.spv" || (echo failed to compile "raytrace.rint")
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%raytrace.rgen" -o "%PROJECT_DIR%spv\raytrace.rgen.spv" || (echo failed to compile "raytrace.rgen")
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%raytrace.rmiss" -o "%PROJECT_DIR%spv\raytrace.rmiss.spv" || (echo failed to compile "raytrace.rmiss")
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%raytrace.rchit" -o "%PROJECT_DIR%spv\raytrace.rchit.spv" || (echo failed to compile "raytrace.rchit")
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%raytrace.rahit" -o "%PROJECT_DIR%spv\raytrace.rahit.spv" || (echo failed to compile "raytrace.rahit")
+C:\VulkanSDK\1.4.304.1\Bin\glslc.exe --target-env=vulkan1.2 "%PROJECT_DIR%raytrace.rint" -o "%PROJECT_DIR%spv\raytrace.rint.spv" || (echo failed to compile "raytrace.rint")
 
 echo Shaders compiled
 pause
\ No newline at end of file
@@ -1,19 +1,14 @@
 #version 450
-#define MAX_LIGHTS 99
 
-struct LightBuffer { 
-	vec3 pos;
-	vec3 color;
-};
-
-layout(binding = 0) uniform UniformBufferObject {
-	mat4 model;
+layout(binding = 0) uniform SceneUBO {
 	mat4 view;
 	mat4 proj;
+} scene;
+
+layout(push_constant) uniform ObjectPushConstants {
+	mat4 model;
 	vec3 color;
-	LightBuffer lights[MAX_LIGHTS];
-	int numLights;
-} ubo;
+} object;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
@@ -22,6 +17,6 @@ layout(location = 2) in vec2 inTexCoord;
 layout(location = 0) out vec3 fragColor;
 
 void main() {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-	fragColor = ubo.color;
+	gl_Position = scene.proj * scene.view * object.model * vec4(inPosition, 1.0);
+	fragColor = object.color;
 }
\ No newline at end of file
@@ -0,0 +1,164 @@
+// Single-pass mip generation, included by mipGen*.comp which define MIP_FORMAT as the
+// storage format of the destination levels.
+//
+// Each workgroup reduces a 64x64 tile of the source level to levels 1-6: the first two
+// levels come from bilinear taps, levels 3-6 from quad subgroup ops and shared memory.
+// The last workgroup of each layer to finish its tile, found through an atomic counter,
+// carries on from level 6 to level 12. Layers are spread over gl_WorkGroupID.z, so the
+// same shader handles plain textures, arrays and cubemap faces.
+
+#extension GL_KHR_shader_subgroup_quad : require
+
+layout(local_size_x = 256) in;
+
+layout(set = 0, binding = 0) uniform sampler2DArray source;
+layout(set = 0, binding = 1, MIP_FORMAT) uniform writeonly image2DArray destination[12];
+// level 6 is written and read back across workgroups, so it bypasses incoherent caches
+layout(set = 0, binding = 2, MIP_FORMAT) uniform coherent image2DArray middle;
+
+layout(set = 0, binding = 3) coherent buffer Counters {
+	uint counters[];
+};
+
+layout(push_constant) uniform MipParams {
+	uvec2 sourceSize;
+	uint levels;
+	uint srgb;
+	uint tilesPerLayer;
+} params;
+
+shared vec4 tile[64];
+shared uint lastTile;
+
+vec3 toLinear(vec3 c)
+{
+	return mix(c / 12.92, pow((c + 0.055) / 1.055, vec3(2.4)), greaterThan(c, vec3(0.04045)));
+}
+
+vec3 toSrgb(vec3 c)
+{
+	return mix(c * 12.92, 1.055 * pow(c, vec3(1.0 / 2.4)) - 0.055, greaterThan(c, vec3(0.0031308)));
+}
+
+uvec2 levelSize(uint level)
+{
+	return max(params.sourceSize >> level, uvec2(1));
+}
+
+// position of invocation t in a side x side grid where each 2x2 quad is one subgroup quad
+uvec2 quadPosition(uint t, uint side)
+{
+	uint quads = side / 2;
+	uint q = t >> 2;
+	return uvec2((q % quads) * 2 + (t & 1), (q / quads) * 2 + ((t >> 1) & 1));
+}
+
+vec4 reduceQuad(vec4 v)
+{
+	return (v + subgroupQuadSwapHorizontal(v) + subgroupQuadSwapVertical(v) + subgroupQuadSwapDiagonal(v)) * 0.25;
+}
+
+void store(uint level, uvec2 texel, uint layer, vec4 value)
+{
+	if (level > params.levels || any(greaterThanEqual(texel, levelSize(level))))
+		return;
+
+	if (params.srgb != 0)
+		value.rgb = toSrgb(value.rgb);
+
+	if (level == 6)
+		imageStore(middle, ivec3(texel, layer), value);
+	else
+		imageStore(destination[level - 1], ivec3(texel, layer), value);
+}
+
+// average of the 2x2 source texels under a level 1 texel, in one bilinear tap
+vec4 sampleSource(uvec2 texel, uint layer)
+{
+	vec2 uv = (vec2(texel) * 2.0 + 1.0) / vec2(params.sourceSize);
+	return textureLod(source, vec3(uv, layer), 0.0);
+}
+
+vec4 loadMiddle(ivec2 texel, uint layer)
+{
+	vec4 value = imageLoad(middle, ivec3(min(texel, ivec2(levelSize(6)) - 1), layer));
+	if (params.srgb != 0)
+		value.rgb = toLinear(value.rgb);
+	return value;
+}
+
+// average of the 2x2 level 6 texels under a level 7 texel
+vec4 sampleMiddle(uvec2 texel, uint layer)
+{
+	ivec2 p = ivec2(texel) * 2;
+	return (loadMiddle(p, layer) + loadMiddle(p + ivec2(1, 0), layer) + loadMiddle(p + ivec2(0, 1), layer) + loadMiddle(p + ivec2(1, 1), layer)) * 0.25;
+}
+
+// reduces a 64x64 tile of level base into levels base + 1 to base + 6
+void reduceTile(uint base, uvec2 tileId, uint layer)
+{
+	uint t = gl_LocalInvocationIndex;
+	uvec2 p = quadPosition(t, 16);
+
+	vec4 sum = vec4(0.0);
+	for (uint i = 0; i < 4; i++) {
+		uvec2 texel = tileId * 32 + p * 2 + uvec2(i & 1, i >> 1);
+		vec4 value = base == 0 ? sampleSource(texel, layer) : sampleMiddle(texel, layer);
+		store(base + 1, texel, layer, value);
+		sum += value;
+	}
+
+	vec4 value = sum * 0.25;
+	store(base + 2, tileId * 16 + p, layer, value);
+
+	value = reduceQuad(value);
+	if ((t & 3) == 0) {
+		store(base + 3, tileId * 8 + p / 2, layer, value);
+		tile[(p.y / 2) * 8 + p.x / 2] = value;
+	}
+	barrier();
+
+	uint level = base + 4;
+	for (uint side = 8; side > 1; side /= 2, level++) {
+		if (level > params.levels)
+			return;
+
+		bool active = t < side * side;
+		uvec2 q = quadPosition(t, side);
+		if (active)
+			value = reduceQuad(tile[q.y * side + q.x]);
+		barrier();
+
+		if (active && (t & 3) == 0) {
+			store(level, tileId * (side / 2) + q / 2, layer, value);
+			tile[(q.y / 2) * (side / 2) + q.x / 2] = value;
+		}
+		barrier();
+	}
+}
+
+void main()
+{
+	uint layer = gl_WorkGroupID.z;
+
+	reduceTile(0, gl_WorkGroupID.xy, layer);
+
+	if (params.levels <= 6)
+		return;
+
+	if (gl_LocalInvocationIndex == 0) {
+		memoryBarrierImage();
+		lastTile = atomicAdd(counters[layer], 1u) == params.tilesPerLayer - 1 ? 1u : 0u;
+		memoryBarrierImage();
+	}
+	barrier();
+
+	if (lastTile == 0)
+		return;
+
+	// ready for the next dispatch that uses this layer's counter
+	if (gl_LocalInvocationIndex == 0)
+		counters[layer] = 0u;
+
+	reduceTile(6, uvec2(0), layer);
+}
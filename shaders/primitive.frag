@@ -1,20 +1,30 @@
 #version 450
-#define MAX_LIGHTS 99
 
 struct LightBuffer { 
 	vec3 pos;
-	float padding;
+	float radius;
 	vec3 color;
 };
 
-layout(binding = 0) uniform UniformBufferObject {
-	mat4 model;
+layout(set = 0, binding = 0) uniform SceneUBO {
 	mat4 view;
 	mat4 proj;
-	vec3 color;
-	LightBuffer lights[MAX_LIGHTS];
+	uvec4 clusterGrid;
+	vec4 clusterParams;
 	int numLights;
-} ubo;
+} scene;
+
+layout(set = 1, binding = 0) readonly buffer Lights {
+	LightBuffer lights[];
+};
+
+layout(set = 1, binding = 1) readonly buffer ClusterCounts {
+	uint clusterLightCount[];
+};
+
+layout(set = 1, binding = 2) readonly buffer ClusterIndices {
+	uint clusterLightIndices[];
+};
 
 layout(binding = 1) uniform sampler2D texSampler;
 
@@ -35,18 +45,34 @@ void main() {
 	vec3 ambient = vec3(0.0);
 	vec3 diffuse = vec3(0.0);
 
-	for (int i = 0; i < ubo.numLights; i++) {
-		float dist = length(ubo.lights[i].pos - fragPos);
+	uvec3 grid = scene.clusterGrid.xyz;
+	float near = scene.clusterParams.x;
+	float far = scene.clusterParams.y;
+
+	float viewDepth = -(scene.view * vec4(fragPos, 1.0)).z;
+	uint slice = uint(max(log(viewDepth / near) / log(far / near) * float(grid.z), 0.0));
+	uvec2 tile = uvec2(gl_FragCoord.xy / scene.clusterParams.zw * vec2(grid.xy));
+	tile = min(tile, grid.xy - 1u);
+	slice = min(slice, grid.z - 1u);
+
+	uint cluster = tile.x + tile.y * grid.x + slice * grid.x * grid.y;
+	uint count = clusterLightCount[cluster];
+	uint base = cluster * scene.clusterGrid.w;
+
+	for (uint j = 0; j < count; j++) {
+		LightBuffer light = lights[clusterLightIndices[base + j]];
+
+		float dist = length(light.pos - fragPos);
 		float attenuation = 1.0 / (1.0 + linear * dist + quad * (dist * dist));
-		ambient += ambientStrength * ubo.lights[i].color * attenuation;
+		ambient += ambientStrength * light.color * attenuation;
 
-		vec3 lightDir = normalize(ubo.lights[i].pos - fragPos);
+		vec3 lightDir = normalize(light.pos - fragPos);
 		float diff = max(dot(norm, lightDir), 0.0);
 
-		diffuse += diff * ubo.lights[i].color * attenuation;
+		diffuse += diff * light.color * attenuation;
 	}
 
-	if (ubo.numLights == 0) {
+	if (scene.numLights == 0) {
 		outColor = vec4(fragColor, 1.0);
 	} else {
 		vec3 result = (ambient + diffuse) * fragColor;
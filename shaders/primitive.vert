@@ -1,20 +1,14 @@
 #version 450
-#define MAX_LIGHTS 99
 
-struct LightBuffer { 
-	vec3 pos;
-	float padding;
-	vec3 color;
-};
-
-layout(binding = 0) uniform UniformBufferObject {
-	mat4 model;
+layout(binding = 0) uniform SceneUBO {
 	mat4 view;
 	mat4 proj;
+} scene;
+
+layout(push_constant) uniform ObjectPushConstants {
+	mat4 model;
 	vec3 color;
-	LightBuffer lights[MAX_LIGHTS];
-	int numLights;
-} ubo;
+} object;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
@@ -26,9 +20,9 @@ layout(location = 2) out vec3 fragNormal;
 layout(location = 3) out vec2 fragTexColor;
 
 void main() {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-	fragPos = vec3(ubo.model * vec4(inPosition, 1.0));
-	fragColor = ubo.color;
+	gl_Position = scene.proj * scene.view * object.model * vec4(inPosition, 1.0);
+	fragPos = vec3(object.model * vec4(inPosition, 1.0));
+	fragColor = object.color;
 	fragTexColor = inTexCoord;
-	fragNormal = mat3(transpose(inverse(ubo.model))) * inNormal;
+	fragNormal = mat3(transpose(inverse(object.model))) * inNormal;
 }
\ No newline at end of file
@@ -1,10 +1,14 @@
 #version 450
 
-layout(binding = 0) uniform UniformBufferObject {
-	mat4 model;
+layout(binding = 0) uniform SceneUBO {
 	mat4 view;
 	mat4 proj;
-} ubo;
+} scene;
+
+layout(push_constant) uniform ObjectPushConstants {
+	mat4 model;
+	vec3 color;
+} object;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -14,7 +18,7 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
 void main() {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+	gl_Position = scene.proj * scene.view * object.model * vec4(inPosition, 1.0);
 	fragColor = inColor;
 	fragTexCoord = inTexCoord;
 }
\ No newline at end of file
@@ -1,11 +1,11 @@
 #version 450
 
+// bound in PBR_UPLOAD_ORDER: ao, roughness and metalness share one texture (R, G, B) and the
+// normal map keeps only x and y
 layout(set = 0, binding = 1) uniform sampler2D diffuseMap;
 layout(set = 0, binding = 2) uniform sampler2D normalMap;
-layout(set = 0, binding = 3) uniform sampler2D roughnessMap;
-layout(set = 0, binding = 4) uniform sampler2D metalnessMap;
-layout(set = 0, binding = 5) uniform sampler2D aoMap;
-layout(set = 0, binding = 6) uniform sampler2D specularMap;
+layout(set = 0, binding = 3) uniform sampler2D ormMap;
+layout(set = 0, binding = 4) uniform sampler2D specularMap;
 
 layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec2 fragTexCoord;
@@ -14,14 +14,19 @@ layout(location = 3) in vec3 fragPosition;
 
 layout(location = 0) out vec4 outColor;
 
+vec3 unpackNormal(vec2 xy) {
+    xy = xy * 2.0 - 1.0;
+    return vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
+}
+
 void main() {
     vec3 diffuse = texture(diffuseMap, fragTexCoord).rgb;
-    //vec3 ao = texture(aoMap, fragTexCoord).rgb;
-    //vec3 normal = texture(normalMap, fragTexCoord).rgb;
-    //vec3 roughness = texture(roughnessMap, fragTexCoord).rgb;
-    //vec3 specular = texture(specularMap, fragTexCoord).rgb;
-
-    ///vec3 result = (diffuse + ao + specular) / 3.0;
+    //vec3 orm = texture(ormMap, fragTexCoord).rgb;
+    //float ao = orm.r;
+    //float roughness = orm.g;
+    //float metalness = orm.b;
+    //vec3 normal = unpackNormal(texture(normalMap, fragTexCoord).rg);
+    //float specular = texture(specularMap, fragTexCoord).r;
 
     outColor = vec4(diffuse, 1.0);
 }
@@ -1,10 +1,14 @@
 #version 450
 
-layout(binding = 0) uniform UniformBufferObject {
-	mat4 model;
+layout(binding = 0) uniform SceneUBO {
 	mat4 view;
 	mat4 proj;
-} ubo;
+} scene;
+
+layout(push_constant) uniform ObjectPushConstants {
+	mat4 model;
+	vec3 color;
+} object;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -16,11 +20,11 @@ layout(location = 2) out vec3 fragNormal;
 layout(location = 3) out vec3 fragPosition;
 
 void main() {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+	gl_Position = scene.proj * scene.view * object.model * vec4(inPosition, 1.0);
 
 	fragColor = inColor;
 	fragTexCoord = inTexCoord;
-	fragPosition = (ubo.model * vec4(inPosition, 1.0)).xyz;
+	fragPosition = (object.model * vec4(inPosition, 1.0)).xyz;
 
-	fragNormal = mat3(transpose(inverse(ubo.model))) * vec3(0.0, 0.0, 1.0);
+	fragNormal = mat3(transpose(inverse(object.model))) * vec3(0.0, 0.0, 1.0);
 }
\ No newline at end of file